@@ -0,0 +1,202 @@
+/*
+ * PaxosHost.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef PAXOSHOST_H_
+#define PAXOSHOST_H_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/foreach.hpp>
+#include "PaxosService.hpp"
+#include "logging/Logger.hpp"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace paxos
+{
+
+/**
+ Runs the consensus groups (shards) of this node on a fixed pool of io threads, each with its
+ own io_service, see etc/host.xml. A shard owns the keys from its first_key up to the next
+ shard's one and is served by one PaxosService, whose methods must be called in the thread
+ of its io_service (see post). The shards share no mutable state.
+ */
+template <class ListenerType> class PaxosHost
+{
+
+public:
+	typedef PaxosService<ListenerType>											service_t;
+	typedef boost::function<boost::shared_ptr<ListenerType> (const std::string&)>	listener_factory_t;
+
+	/**
+	 * Configures a service per shard, createListener is called with the name of each shard.
+	 */
+	PaxosHost(const boost::property_tree::ptree& configuration, listener_factory_t createListener)
+	{
+		size_t threadCount = configuration.get<size_t>(XML_HOST_THREADS, std::max(boost::thread::hardware_concurrency(), 1u));
+		mCpuAffinity = configuration.get<bool>(XML_HOST_CPU_AFFINITY, false);
+		BOOST_FOREACH(property_tree::ptree::value_type const& v, configuration.get_child(XML_HOST))
+		{
+			if (v.first != "shard") continue;
+			Shard shard;
+			shard.mName = v.second.get<std::string>(XML_SHARD_NAME);
+			shard.mFirstKey = v.second.get<std::string>(XML_SHARD_FIRST_KEY, "");
+			shard.mConfiguration = v.second;
+			mShards.push_back(shard);
+		}
+		std::sort(mShards.begin(), mShards.end());
+		if (mShards.empty() || !mShards[0].mFirstKey.empty())
+		{
+			throw std::runtime_error("In configuration " + XML_HOST + " the first shard must have an empty first_key");
+		}
+		for (size_t i = 1; i < mShards.size(); i++)
+		{
+			if (mShards[i].mFirstKey == mShards[i - 1].mFirstKey)
+			{
+				throw std::runtime_error("In configuration shards " + mShards[i - 1].mName + " and " + mShards[i].mName + " have the same first_key");
+			}
+		}
+		threadCount = std::max<size_t>(std::min(threadCount, mShards.size()), 1);
+		for (size_t i = 0; i < threadCount; i++)
+		{
+			mIOServices.push_back(io_service_ptr_t(new boost::asio::io_service));
+		}
+		for (size_t i = 0; i < mShards.size(); i++)
+		{
+			Shard& shard = mShards[i];
+			shard.mThread = i % threadCount;
+			shard.mService.reset(new service_t(mIOServices[shard.mThread], createListener(shard.mName), shard.mConfiguration));
+			std::cout << "Shard " << shard.mName << " [" << shard.mFirstKey << ", " << (i + 1 < mShards.size() ? mShards[i + 1].mFirstKey : "") << ") runs on io thread#" << shard.mThread << std::endl;
+		}
+	}
+
+	/**
+	 * Starts the io threads and returns.
+	 */
+	void start()
+	{
+		for (size_t i = 0; i < mIOServices.size(); i++)
+		{
+			mThreads.create_thread(boost::bind(&PaxosHost::run, this, i));
+		}
+	}
+
+	/**
+	 * Waits until the io threads are stopped.
+	 */
+	void join()
+	{
+		mThreads.join_all();
+	}
+
+	void stop()
+	{
+		for (size_t i = 0; i < mIOServices.size(); i++)
+		{
+			mIOServices[i]->stop();
+		}
+		mThreads.join_all();
+		for (size_t i = 0; i < mShards.size(); i++)
+		{
+			mShards[i].mService->stop();
+		}
+	}
+
+	size_t getShardCount() const { return mShards.size(); }
+	const std::string& getShardName(size_t shard) const { return mShards[shard].mName; }
+
+	/**
+	 * Shard owning key: the last one whose first_key is <= key.
+	 */
+	size_t findShard(const std::string& key) const
+	{
+		size_t low = 0;
+		size_t high = mShards.size();
+		while (high - low > 1)
+		{
+			size_t middle = (low + high) / 2;
+			if (mShards[middle].mFirstKey <= key) low = middle;
+			else high = middle;
+		}
+		return low;
+	}
+
+	/**
+	 * The service of a shard: call it in the thread of getIOService(shard) only, getMetrics excepted.
+	 */
+	service_t& getService(size_t shard)
+	{
+		return *mShards[shard].mService;
+	}
+
+	io_service_ptr_t getIOService(size_t shard) const
+	{
+		return mIOServices[mShards[shard].mThread];
+	}
+
+	/**
+	 * Runs handler in the thread of the shard, e.g. to propose a command.
+	 */
+	void post(size_t shard, boost::function<void ()> handler)
+	{
+		getIOService(shard)->post(handler);
+	}
+
+private:
+	struct Shard
+	{
+		std::string							mName;
+		std::string							mFirstKey;
+		boost::property_tree::ptree			mConfiguration;
+		size_t								mThread;
+		boost::shared_ptr<service_t>		mService;
+
+		bool operator<(const Shard& other) const {return mFirstKey < other.mFirstKey;}
+	};
+
+	std::vector<Shard>					mShards;//by first key
+	std::vector<io_service_ptr_t>		mIOServices;//by io thread
+	boost::thread_group					mThreads;
+	bool								mCpuAffinity;
+
+	/**
+	 * Body of io thread#thread: starts its shards then runs their io_service.
+	 */
+	void run(size_t thread)
+	{
+#ifdef __linux__
+		if (mCpuAffinity)
+		{
+			cpu_set_t cpus;
+			CPU_ZERO(&cpus);
+			CPU_SET(thread % std::max(boost::thread::hardware_concurrency(), 1u), &cpus);
+			if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+			{
+				PAXOS_WARN("io thread#{} can not be pinned to a CPU => it may migrate.") << thread;
+			}
+		}
+#endif
+		boost::asio::io_service::work work(*mIOServices[thread]);//the io_service runs until stop()
+		for (size_t i = 0; i < mShards.size(); i++)
+		{
+			if (mShards[i].mThread == thread) mShards[i].mService->async_start();
+		}
+		mIOServices[thread]->run();
+	}
+};
+
+}
+
+#endif /* PAXOSHOST_H_ */
@@ -17,6 +17,17 @@ namespace paxos
  ListenerType must implement the 2 following methods:
 	- void onStateChange(string id, ProposerState state)
 	- void onConsensus(uint32_t decisionId, const std::string acceptedValue)
+ and may implement the 2 following ones (see handlers/ListenerHooks.hpp):
+	- void onSnapshot(uint32_t decisionId, const std::string& state)
+	- void onDecisionsLost(uint32_t from, uint32_t to)
+ onConsensus is called for each proposed command of a decision, in order. The no-op
+ decisions of heartbeats and promotions are not delivered.
+ onSnapshot is called when this node is missing decisions the peers no longer hold: the
+ application restores the state of a peer snapshot (see saveSnapshot) and the delivery
+ resumes at decisionId. Without it, the missing decisions are reported to onDecisionsLost.
+ onDecisionsLost is called when the decisions [from, to) are skipped because no peer holds
+ them or a snapshot covering them: the application must restore a snapshot taken at
+ decision >= to. Without it, the delivery waits for a peer holding them.
  */
 template <class ListenerType> class PaxosService
 {
@@ -30,21 +41,99 @@ public:
 		_lineHandler.init();
 	};
 
+	/**
+	 * Runs the io_service in this thread until it is stopped.
+	 */
 	void start()
 	{
 		_lineHandler.start();
 	}
 
+	/**
+	 * Starts the line handler and returns, the io_service is run by the caller (e.g. PaxosHost
+	 * runs several services on one io_service).
+	 */
+	void async_start()
+	{
+		_lineHandler.async_start();
+	}
+
 	void stop()
 	{
 		_lineHandler.stop();
 	}
 
+	/**
+	 * Queues an application command on the leader. Commands are replicated in batches
+	 * and delivered one by one to onConsensus. Returns false if this node is not the leader.
+	 */
 	bool propose(std::string value)
 	{
 		return _lineHandler.propose(value);
 	}
 
+	/**
+	 * propose() from any thread: the command is moved (swapped with an empty string) to a
+	 * lock-free queue of submit_queue commands, proposed in batches by the io thread. Returns
+	 * false if the queue is full, or with wait blocks until it has room (backpressure).
+	 * The commands reaching the io thread while this node is not the leader are rejected
+	 * (see METRIC_REJECTED_COMMANDS).
+	 */
+	bool submit(std::string& command, bool wait = false)
+	{
+		return _lineHandler.submit(command, wait);
+	}
+
+	/**
+	 * True if this node is the leader and holds the lease of paxos_service.lease.duration_ms:
+	 * no other proposer can get a value chosen meanwhile and the listener has received the
+	 * decisions chosen before, so the application can serve linearizable reads from its state
+	 * without a consensus round. Call it in the thread of the io_service for each read.
+	 */
+	bool hasLeaderLease()
+	{
+		return _lineHandler.hasLeaderLease();
+	}
+
+	/**
+	 * Appends to values the decided values of [from, to) kept by the learner log. The values
+	 * are batches (see protocole/batch.hpp) pointing into the log: they are valid until the
+	 * next value is stored or the log is truncated (saveSnapshot), so at most until the io
+	 * thread handles the next message. Returns the number of values found.
+	 */
+	size_t readDecided(uint32_t from, uint32_t to, std::vector<DecidedValue>& values) const
+	{
+		return _lineHandler.readDecided(from, to, values);
+	}
+
+	/**
+	 * Hands over the application state reached once the decisions < decisionId are applied.
+	 * The learner log and the acceptor state below decisionId are then truncated, and the
+	 * snapshot is sent to the peers missing the decisions it covers. Returns false if the learner has no log_dir or the snapshot could not be written.
+	 */
+	bool saveSnapshot(uint32_t decisionId, const std::string& state)
+	{
+		return _lineHandler.saveSnapshot(decisionId, state);
+	}
+
+	/**
+	 * Loads the latest snapshot. On restart, the application restores it then replays
+	 * readDecided(decisionId, ...) to apply the log tail.
+	 */
+	bool loadSnapshot(uint32_t& decisionId, std::string& state) const
+	{
+		return _lineHandler.loadSnapshot(decisionId, state);
+	}
+
+	/**
+	 * Copies the counters and latency histograms of this node (see metrics/PaxosMetrics.hpp).
+	 * Safe to call from any thread, e.g. to export them with MetricsSnapshot::write.
+	 */
+	void getMetrics(MetricsSnapshot& snapshot) const
+	{
+		_lineHandler.snapshotMetrics(snapshot);
+	}
+
 private:
 	PaxosLH<ListenerType> _lineHandler;
 };
@@ -0,0 +1,130 @@
+/*
+ * MpscRing.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#ifndef MPSCRING_H_
+#define MPSCRING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <boost/scoped_array.hpp>
+
+namespace paxos
+{
+
+	/**
+	 * Bounded lock-free multi-producer single-consumer ring with a sequence per cell (Vyukov).
+	 *
+	 * A producer claims a cell, fills its item in place and publishes it. The consumer peeks
+	 * the oldest published item and pops it once done with it. The items are allocated once
+	 * and reused, e.g. strings keep their capacity.
+	 */
+	template<class T> class MpscRing
+	{
+	public:
+		MpscRing() : mMask(0), mDequeuePosition(0)
+		{
+			mEnqueuePosition.store(0, boost::memory_order_relaxed);
+		}
+
+		/**
+		 * Allocates capacity cells, rounded up to a power of 2. Not thread-safe.
+		 */
+		void configure(size_t capacity)
+		{
+			size_t size = 1;
+			while (size < capacity) size <<= 1;
+			mCells.reset(new Cell[size]);
+			for (size_t i = 0; i < size; i++)
+			{
+				mCells[i].mSequence.store(i, boost::memory_order_relaxed);
+			}
+			mMask = size - 1;
+			mDequeuePosition = 0;
+			mEnqueuePosition.store(0, boost::memory_order_release);
+		}
+
+		size_t getCapacity() const { return mMask + 1; }
+
+		/**
+		 * Any thread: the item of a free cell to fill then publish(position). If the ring is full,
+		 * returns NULL, or with wait yields until the consumer makes room.
+		 */
+		T* claim(size_t& position, bool wait)
+		{
+			position = mEnqueuePosition.load(boost::memory_order_relaxed);
+			for (;;)
+			{
+				Cell& cell = mCells[position & mMask];
+				intptr_t distance = (intptr_t) cell.mSequence.load(boost::memory_order_acquire) - (intptr_t) position;
+				if (distance == 0)
+				{
+					if (mEnqueuePosition.compare_exchange_weak(position, position + 1, boost::memory_order_relaxed)) return &cell.mItem;
+				}
+				else if (distance < 0)
+				{
+					if (!wait) return NULL;
+					boost::this_thread::yield();
+					position = mEnqueuePosition.load(boost::memory_order_relaxed);
+				}
+				else
+				{
+					position = mEnqueuePosition.load(boost::memory_order_relaxed);
+				}
+			}
+		}
+
+		void publish(size_t position)
+		{
+			mCells[position & mMask].mSequence.store(position + 1, boost::memory_order_release);
+		}
+
+		/**
+		 * Consumer only: the oldest published item, NULL if there is none.
+		 */
+		T* peek()
+		{
+			Cell& cell = mCells[mDequeuePosition & mMask];
+			return cell.mSequence.load(boost::memory_order_acquire) == mDequeuePosition + 1 ? &cell.mItem : NULL;
+		}
+
+		/**
+		 * Consumer only: frees the cell of the peeked item.
+		 */
+		void pop()
+		{
+			mCells[mDequeuePosition & mMask].mSequence.store(mDequeuePosition + mMask + 1, boost::memory_order_release);
+			mDequeuePosition++;
+		}
+
+		/**
+		 * Number of cells claimed so far, published or not.
+		 */
+		size_t getEnqueuePosition() const { return mEnqueuePosition.load(boost::memory_order_relaxed); }
+
+		/**
+		 * Consumer only: number of items popped so far.
+		 */
+		size_t getDequeuePosition() const { return mDequeuePosition; }
+
+	private:
+		struct Cell
+		{
+			boost::atomic<size_t>	mSequence;
+			T						mItem;
+		};
+
+		boost::scoped_array<Cell>	mCells;
+		size_t						mMask;
+		boost::atomic<size_t>		mEnqueuePosition;
+		size_t						mDequeuePosition;//consumer only
+	};
+
+}
+
+#endif /* MPSCRING_H_ */
@@ -23,14 +23,86 @@ namespace paxos
 	const string XML_PROPOSER_START_STATE = "paxos_service.line_handler.proposer.start_state";
 	const string XML_PROPOSER_HEARTBEAT_MS = "paxos_service.line_handler.proposer.heartbeat_ms";
 	const string XML_PROPOSER_PHASE_TIMEOUT_MS = "paxos_service.line_handler.proposer.phase_timeout_ms";
+	const string XML_PROPOSER_PHASE_TIMEOUT_MIN_MS = "paxos_service.line_handler.proposer.phase_timeout_min_ms";
+	const string XML_PROPOSER_PHASE_TIMEOUT_MAX_MS = "paxos_service.line_handler.proposer.phase_timeout_max_ms";
+	const string XML_PROPOSER_PHI_THRESHOLD = "paxos_service.line_handler.proposer.failure_detector.phi_threshold";
+	const string XML_PROPOSER_PHI_WINDOW = "paxos_service.line_handler.proposer.failure_detector.window";
+	const string XML_PROPOSER_PHI_MIN_STD_DEVIATION_MS = "paxos_service.line_handler.proposer.failure_detector.min_std_deviation_ms";
+	const string XML_PROPOSER_PHI_ACCEPTABLE_PAUSE_MS = "paxos_service.line_handler.proposer.failure_detector.acceptable_pause_ms";
+	const string XML_PROPOSER_PHI_MAX_SILENCE_MS = "paxos_service.line_handler.proposer.failure_detector.max_silence_ms";
+	const string XML_PROPOSER_BATCH_MAX_BYTES = "paxos_service.line_handler.proposer.batch_max_bytes";
+	const string XML_PROPOSER_BATCH_MAX_COUNT = "paxos_service.line_handler.proposer.batch_max_count";
+	const string XML_PROPOSER_BATCH_LINGER_MS = "paxos_service.line_handler.proposer.batch_linger_ms";
 	const string XML_ACCEPTOR_ID = "paxos_service.line_handler.acceptor.id";
+	const string XML_ACCEPTOR_LOG_DIR = "paxos_service.line_handler.acceptor.log_dir";
+	const string XML_ACCEPTOR_LOG_MAX_BYTES = "paxos_service.line_handler.acceptor.log_max_bytes";
 	const string XML_LEARNER_ID = "paxos_service.line_handler.learner.id";
+	const string XML_LEARNER_LOG_DIR = "paxos_service.line_handler.learner.log_dir";
+	const string XML_LEARNER_DECISIONS_PER_SEGMENT = "paxos_service.line_handler.learner.decisions_per_segment";
+	const string XML_LEARNER_SEGMENT_BYTES = "paxos_service.line_handler.learner.segment_bytes";
+	const string XML_LEARNER_SYNC_MS = "paxos_service.line_handler.learner.sync_ms";
 //	const string XML_ACCEPTOR_DISCARD_PREPARE_COUNT = "paxos_service.line_handler.acceptor.discard_prepare_count";
 	const string XML_INTERFACE = "paxos_service.line_handler.interface";
 	const string XML_GROUP = "paxos_service.line_handler.group";
 	const string XML_PORT = "paxos_service.line_handler.port";
 	const string XML_TTL = "paxos_service.line_handler.ttl";
+	const string XML_WIRE_FORMAT = "paxos_service.line_handler.wire_format";
+	const string XML_RECEIVE_BATCH = "paxos_service.line_handler.receive_batch";
+	const string XML_RCVBUF_BYTES = "paxos_service.line_handler.rcvbuf_bytes";
+	const string XML_SEND_QUEUE = "paxos_service.line_handler.send_queue";
+	const string XML_REASSEMBLY_MAX_BYTES = "paxos_service.line_handler.reassembly.max_bytes";
+	const string XML_REASSEMBLY_MAX_MESSAGE_BYTES = "paxos_service.line_handler.reassembly.max_message_bytes";
+	const string XML_REASSEMBLY_TIMEOUT_MS = "paxos_service.line_handler.reassembly.timeout_ms";
+	const string XML_TRANSPORT = "paxos_service.line_handler.transport";
+	const string XML_PEERS = "paxos_service.line_handler.peers";
 	const string XML_QUORUM = "paxos_service.quorum";
+	const string XML_MULTI_PAXOS = "paxos_service.multi_paxos";
+	const string XML_PIPELINE_WINDOW = "paxos_service.pipeline_window";
+	const string XML_SUBMIT_QUEUE = "paxos_service.submit_queue";
+	const string XML_VALUE_REFERENCES = "paxos_service.value_references";
+	const string XML_VALUE_CACHE_ENTRIES = "paxos_service.value_cache.entries";
+	const string XML_VALUE_CACHE_MAX_BYTES = "paxos_service.value_cache.max_bytes";
+	const string XML_LEASE_MS = "paxos_service.lease.duration_ms";
+	const string XML_LEASE_MAX_DRIFT_PPM = "paxos_service.lease.max_drift_ppm";
+	const string XML_CATCHUP_HISTORY = "paxos_service.catchup.history";
+	const string XML_CATCHUP_MAX_HELD = "paxos_service.catchup.max_held";
+	const string XML_CATCHUP_RANGE = "paxos_service.catchup.range";
+	const string XML_CATCHUP_TIMEOUT_MS = "paxos_service.catchup.timeout_ms";
+	const string XML_SIMULATION_SEED = "simulation.seed";
+	const string XML_SIMULATION_NODES = "simulation.nodes";
+	const string XML_SIMULATION_PROPOSERS = "simulation.proposers";
+	const string XML_SIMULATION_DURATION_MS = "simulation.duration_ms";
+	const string XML_SIMULATION_LATENCY_MIN_US = "simulation.latency_min_us";
+	const string XML_SIMULATION_LATENCY_MAX_US = "simulation.latency_max_us";
+	const string XML_SIMULATION_LOSS = "simulation.loss";
+	const string XML_SIMULATION_DUPLICATION = "simulation.duplication";
+	const string XML_SIMULATION_REORDERING = "simulation.reordering";
+	const string XML_SIMULATION_REORDER_DELAY_US = "simulation.reorder_delay_us";
+	const string XML_SIMULATION_COMMANDS_PER_MS = "simulation.commands_per_ms";
+	const string XML_SIMULATION_COMMAND_BYTES = "simulation.command_bytes";
+	const string XML_SIMULATION_MAX_PENDING = "simulation.max_pending";
+	const string XML_SIMULATION_CRASH_LEADER_MS = "simulation.crash_leader_ms";
+	const string XML_SIMULATION_MIN_DECISIONS = "simulation.min_decisions";
+	const string XML_SIMULATION_MIN_LEASED_MS = "simulation.min_leased_ms";
+	const string XML_BENCHMARK = "benchmark";
+	const string XML_BENCHMARK_BASE_PORT = "benchmark.base_port";
+	const string XML_BENCHMARK_WARMUP_MS = "benchmark.warmup_ms";
+	const string XML_BENCHMARK_DURATION_MS = "benchmark.duration_ms";
+	const string XML_BENCHMARK_COMMANDS_PER_MS = "benchmark.commands_per_ms";
+	const string XML_BENCHMARK_MAX_PENDING = "benchmark.max_pending";
+	const string XML_RUN_NAME = "<xmlattr>.name";//relative to a benchmark.run element
+	const string XML_RUN_ACCEPTORS = "acceptors";
+	const string XML_RUN_PROPOSERS = "proposers";
+	const string XML_RUN_VALUE_BYTES = "value_bytes";
+	const string XML_RUN_BATCH_MAX_COUNT = "batch_max_count";
+	const string XML_RUN_BATCH_MAX_BYTES = "batch_max_bytes";
+	const string XML_RUN_PIPELINE_WINDOW = "pipeline_window";
+	const string XML_RUN_COMMANDS_PER_MS = "commands_per_ms";
+	const string XML_HOST = "paxos_host";
+	const string XML_HOST_THREADS = "paxos_host.threads";
+	const string XML_HOST_CPU_AFFINITY = "paxos_host.cpu_affinity";
+	const string XML_SHARD_NAME = "<xmlattr>.name";//relative to a paxos_host.shard element
+	const string XML_SHARD_FIRST_KEY = "<xmlattr>.first_key";
 
 	class Configurator : private noncopyable
 	{
@@ -49,7 +121,7 @@ namespace paxos
 			{
 				namespace pt = property_tree;
 
-				optional< string> value = ptree.get_optional<string>( name );
+				boost::optional< string> value = ptree.get_optional<string>( name );
 				if(( !value ))
 					return false;
 				return true;
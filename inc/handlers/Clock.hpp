@@ -0,0 +1,135 @@
+/*
+ * Clock.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <boost/asio.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/system/error_code.hpp>
+
+namespace paxos
+{
+
+	/**
+	 * One-shot timer with the deadline_timer semantics: setting the expiry cancels the pending
+	 * wait, whose handler is then called with operation_aborted.
+	 */
+	class Timer
+	{
+	public:
+		typedef boost::function<void (const boost::system::error_code&)> handler_t;
+
+		virtual ~Timer() {}
+		virtual void expiresFromNow(long ms) = 0;
+		virtual void asyncWait(handler_t handler) = 0;
+	};
+
+	typedef boost::shared_ptr<Timer> 	timer_ptr_t;
+
+	/**
+	 * Time source of the line handler: the monotonic clock with asio timers, or a virtual clock.
+	 */
+	class Clock
+	{
+	public:
+		virtual ~Clock() {}
+		/**
+		 * Milliseconds, only differences between timestamps are meaningful.
+		 */
+		virtual long getTimestamp() = 0;
+		/**
+		 * Monotonic microseconds, for the latency metrics and the timer wheel.
+		 */
+		virtual uint64_t getMicroseconds() = 0;
+		virtual timer_ptr_t createTimer() = 0;
+		/**
+		 * Runs handler later in the thread of the line handler. Thread-safe with the asio clock.
+		 */
+		virtual void post(boost::function<void ()> handler) = 0;
+	};
+
+	typedef boost::shared_ptr<Clock> 	clock_ptr_t;
+
+	/**
+	 * Time traits of the asio timers on CLOCK_MONOTONIC: the deadlines of the default traits are
+	 * wall clock ones, that move with the NTP and manual adjustments.
+	 */
+	struct MonotonicTimeTraits
+	{
+		typedef boost::posix_time::ptime			time_type;
+		typedef boost::posix_time::time_duration	duration_type;
+
+		static time_type now()
+		{
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			return time_type(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(now.tv_sec) + boost::posix_time::microseconds(now.tv_nsec / 1000));
+		}
+
+		static time_type add(const time_type& t, const duration_type& d) { return t + d; }
+		static duration_type subtract(const time_type& t1, const time_type& t2) { return t1 - t2; }
+		static bool less_than(const time_type& t1, const time_type& t2) { return t1 < t2; }
+		static boost::posix_time::time_duration to_posix_duration(const duration_type& d) { return d; }
+	};
+
+	class AsioTimer : public Timer
+	{
+	public:
+		AsioTimer(boost::asio::io_service& ioService) : mTimer(ioService) {}
+
+		virtual void expiresFromNow(long ms)
+		{
+			mTimer.expires_from_now(boost::posix_time::millisec(ms));
+		}
+
+		virtual void asyncWait(handler_t handler)
+		{
+			mTimer.async_wait(handler);
+		}
+
+	private:
+		boost::asio::basic_deadline_timer<boost::posix_time::ptime, MonotonicTimeTraits>		mTimer;
+	};
+
+	class AsioClock : public Clock
+	{
+	public:
+		AsioClock(boost::shared_ptr<boost::asio::io_service> ioService) : mpIOService(ioService) {}
+
+		virtual long getTimestamp()
+		{
+			return getMicroseconds() / 1000;
+		}
+
+		virtual uint64_t getMicroseconds()
+		{
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			return (uint64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+		}
+
+		virtual timer_ptr_t createTimer()
+		{
+			return timer_ptr_t(new AsioTimer(*mpIOService));
+		}
+
+		virtual void post(boost::function<void ()> handler)
+		{
+			mpIOService->post(handler);
+		}
+
+	private:
+		boost::shared_ptr<boost::asio::io_service>	mpIOService;
+	};
+
+}
+
+#endif /* CLOCK_H_ */
@@ -0,0 +1,136 @@
+/*
+ * DecisionSequencer.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef DECISIONSEQUENCER_H_
+#define DECISIONSEQUENCER_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "protocole/message.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Orders the decided values before they are delivered to the listener.
+	 *
+	 * Decisions received ahead of the next one to deliver are held (up to max_held) while the
+	 * missing ones are caught up, and the last history_size delivered values are kept to answer
+	 * the catch-up requests of the peers.
+	 */
+	class DecisionSequencer
+	{
+	public:
+		DecisionSequencer() : mNextDecisionId(0), mExpectedEnd(0), mMaxHeld(4096) { configure(1024, 4096); }
+
+		void configure(size_t historySize, size_t maxHeld)
+		{
+			mMaxHeld = maxHeld;
+			mHistoryIds.assign(historySize == 0 ? 1 : historySize, NO_DECISION);
+			mHistoryValues.assign(mHistoryIds.size(), std::string());
+		}
+
+		uint32_t getNextDecisionId() const { return mNextDecisionId; }
+		bool hasGap() const { return !mHeld.empty() || mExpectedEnd > mNextDecisionId; }
+		uint32_t getGapEnd() const { return mHeld.empty() ? mExpectedEnd : mHeld.begin()->first; }
+
+		/**
+		 * One past the highest decision known to be decided, held or expected.
+		 */
+		uint32_t getKnownEnd() const
+		{
+			uint32_t heldEnd = mHeld.empty() ? 0 : mHeld.rbegin()->first + 1;
+			return std::max(std::max(heldEnd, mExpectedEnd), mNextDecisionId);
+		}
+
+		/**
+		 * Records that decisionId is decided while its value is unknown (e.g. a value reference
+		 * missing from the cache): it is caught up as part of the gap.
+		 */
+		void expect(uint32_t decisionId)
+		{
+			if (decisionId + 1 > mExpectedEnd) mExpectedEnd = decisionId + 1;
+		}
+
+		/**
+		 * Moves to decisionId, the held decisions below it are dropped.
+		 */
+		void skipTo(uint32_t decisionId)
+		{
+			mNextDecisionId = decisionId;
+			while (!mHeld.empty() && mHeld.begin()->first < decisionId)
+			{
+				mHeld.erase(mHeld.begin());
+			}
+		}
+
+		/**
+		 * Keeps a decision received ahead of the next one. Returns false if it is dropped
+		 * (too many held decisions): it will be caught up once the gap before it is filled.
+		 */
+		bool hold(uint32_t decisionId, const std::string& value)
+		{
+			if (mHeld.size() >= mMaxHeld && mHeld.find(decisionId) == mHeld.end()) return false;
+			mHeld[decisionId] = value;
+			return true;
+		}
+
+		/**
+		 * Takes the held value of the next decision if there is one.
+		 */
+		bool popHeld(uint32_t& decisionId, std::string& value)
+		{
+			if (mHeld.empty() || mHeld.begin()->first != mNextDecisionId) return false;
+			decisionId = mHeld.begin()->first;
+			value.swap(mHeld.begin()->second);
+			mHeld.erase(mHeld.begin());
+			return true;
+		}
+
+		/**
+		 * Records the delivery of the next decision.
+		 */
+		void delivered(uint32_t decisionId, const std::string& value)
+		{
+			size_t index = decisionId % mHistoryIds.size();
+			mHistoryIds[index] = decisionId;
+			mHistoryValues[index] = value;
+			mNextDecisionId = decisionId + 1;
+		}
+
+		/**
+		 * Value of a delivered decision still in the history.
+		 */
+		const std::string* getDelivered(uint32_t decisionId) const
+		{
+			size_t index = decisionId % mHistoryIds.size();
+			return mHistoryIds[index] == decisionId ? &mHistoryValues[index] : NULL;
+		}
+
+		/**
+		 * Lowest decision which may still be in the history.
+		 */
+		uint32_t getLowestDelivered() const
+		{
+			return mNextDecisionId > mHistoryIds.size() ? mNextDecisionId - mHistoryIds.size() : 0;
+		}
+
+	private:
+		uint32_t						mNextDecisionId;
+		uint32_t						mExpectedEnd;// decisions below it are known to be decided
+		size_t							mMaxHeld;
+		std::map<uint32_t, std::string>	mHeld;
+		std::vector<uint32_t>			mHistoryIds;// ring indexed by decision id
+		std::vector<std::string>		mHistoryValues;
+	};
+
+}
+
+#endif /* DECISIONSEQUENCER_H_ */
@@ -0,0 +1,188 @@
+/*
+ * FragmentReassembler.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef FRAGMENTREASSEMBLER_H_
+#define FRAGMENTREASSEMBLER_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <list>
+#include <string>
+#include <vector>
+#include "protocole/fragment.hpp"
+#include "metrics/PaxosMetrics.hpp"
+#include "logging/Logger.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Rebuilds the messages sent in fragments (see protocole/fragment.hpp).
+	 *
+	 * The messages being reassembled take at most max_bytes: the oldest ones are dropped to make
+	 * room, as are the ones still incomplete after timeout_ms (checked as fragments arrive). The
+	 * buffers of the completed messages are kept for the next ones, up to max_bytes of them.
+	 */
+	class FragmentReassembler
+	{
+	public:
+		FragmentReassembler() : mMaxBytes(64 << 20), mMaxMessageBytes(16 << 20), mTimeoutMs(1000), mBytes(0), mPooledBytes(0), mMetrics(NULL) {}
+
+		void configure(size_t maxBytes, size_t maxMessageBytes, long timeoutMs)
+		{
+			mMaxBytes = maxBytes;
+			mMaxMessageBytes = std::min(maxMessageBytes, maxBytes);
+			mTimeoutMs = timeoutMs;
+		}
+
+		void setMetrics(PaxosMetrics* metrics) {mMetrics = metrics;}
+		size_t getMaxMessageBytes() const { return mMaxMessageBytes; }
+
+		/**
+		 * Adds a fragment received at nowMs (milliseconds). Returns true once its message is complete:
+		 * message then points to it until the next call. Returns false while fragments are missing,
+		 * or if the fragment is dropped.
+		 */
+		bool add(const MessageFragment& fragment, long nowMs, const char*& message, size_t& size)
+		{
+			trimPool();
+			while (!mMessages.empty() && nowMs - mMessages.front().mStartMs > mTimeoutMs)
+			{
+				drop(mMessages.begin(), "is incomplete after timeout");
+			}
+			std::list<Message>::iterator it = find(fragment);
+			if (it != mMessages.end() && (it->mCount != fragment.mCount || it->mBuffer.size() != fragment.mMessageSize))
+			{//the sender restarted its sequence
+				drop(it, "is superseded");
+				it = mMessages.end();
+			}
+			if (it == mMessages.end())
+			{
+				if (fragment.mMessageSize > mMaxMessageBytes)
+				{
+					PAXOS_WARN("Message of {} bytes exceeds reassembly max_message_bytes={} => message is dropped.") << fragment.mMessageSize << mMaxMessageBytes;
+					count();
+					return false;
+				}
+				while (!mMessages.empty() && mBytes + fragment.mMessageSize > mMaxBytes)
+				{
+					drop(mMessages.begin(), "is evicted by a newer one");
+				}
+				it = start(fragment, nowMs);
+			}
+			if (!it->mFragments[fragment.mIndex])
+			{//duplicates are ignored
+				memcpy(&it->mBuffer[fragment.getOffset()], fragment.mData, fragment.mSize);
+				it->mFragments[fragment.mIndex] = true;
+				it->mReceived++;
+			}
+			if (it->mReceived < it->mCount)
+			{
+				return false;
+			}
+			message = &it->mBuffer[0];
+			size = it->mBuffer.size();
+			release(it);//its buffer is reused by the next calls only
+			return true;
+		}
+
+	private:
+		struct Message
+		{
+			std::string			mSender;
+			uint32_t			mSequence;
+			uint32_t			mCount;
+			uint32_t			mReceived;
+			long				mStartMs;
+			std::vector<char>	mBuffer;
+			std::vector<bool>	mFragments;//received, by index
+		};
+
+		size_t					mMaxBytes;
+		size_t					mMaxMessageBytes;
+		long					mTimeoutMs;
+		size_t					mBytes;//of the messages being reassembled
+		size_t					mPooledBytes;//buffer capacity of mFree
+		std::list<Message>		mMessages;//being reassembled, oldest first
+		std::list<Message>		mFree;//recycled with their buffers
+		PaxosMetrics*			mMetrics;
+
+		std::list<Message>::iterator find(const MessageFragment& fragment)
+		{
+			for (std::list<Message>::iterator it = mMessages.end(); it != mMessages.begin();)
+			{//the fragments of a message mostly arrive together: the newest messages first
+				--it;
+				if (it->mSequence == fragment.mSequence && it->mSender.size() == fragment.mSenderSize
+						&& memcmp(it->mSender.data(), fragment.mSender, fragment.mSenderSize) == 0)
+				{
+					return it;
+				}
+			}
+			return mMessages.end();
+		}
+
+		/**
+		 * Moves a recycled message, the first one with a large enough buffer if any, to the end of mMessages.
+		 */
+		std::list<Message>::iterator start(const MessageFragment& fragment, long nowMs)
+		{
+			std::list<Message>::iterator it = mFree.begin();
+			while (it != mFree.end() && it->mBuffer.capacity() < fragment.mMessageSize) ++it;
+			if (it == mFree.end() && !mFree.empty()) it = mFree.begin();
+			if (it == mFree.end())
+			{
+				mFree.push_back(Message());
+				it = --mFree.end();
+			}
+			mPooledBytes -= it->mBuffer.capacity();
+			mMessages.splice(mMessages.end(), mFree, it);
+			it->mSender.assign(fragment.mSender, fragment.mSenderSize);
+			it->mSequence = fragment.mSequence;
+			it->mCount = fragment.mCount;
+			it->mReceived = 0;
+			it->mStartMs = nowMs;
+			it->mBuffer.resize(fragment.mMessageSize);
+			it->mFragments.assign(fragment.mCount, false);
+			mBytes += fragment.mMessageSize;
+			return it;
+		}
+
+		void release(std::list<Message>::iterator it)
+		{
+			mBytes -= it->mBuffer.size();
+			mPooledBytes += it->mBuffer.capacity();
+			mFree.splice(mFree.begin(), mMessages, it);
+		}
+
+		void drop(std::list<Message>::iterator it, const char* reason)
+		{
+			PAXOS_WARN("Message#{} of {} {} ({}/{} fragments) => message is dropped.") << it->mSequence << it->mSender << reason << it->mReceived << it->mCount;
+			count();
+			release(it);
+		}
+
+		/**
+		 * Frees the recycled buffers beyond max_bytes, the least recently used first.
+		 */
+		void trimPool()
+		{
+			while (mPooledBytes > mMaxBytes)
+			{
+				mPooledBytes -= mFree.back().mBuffer.capacity();
+				mFree.pop_back();
+			}
+		}
+
+		void count()
+		{
+			if (mMetrics != NULL) mMetrics->increment(METRIC_DROPPED_MESSAGES);
+		}
+	};
+
+}
+
+#endif /* FRAGMENTREASSEMBLER_H_ */
@@ -0,0 +1,62 @@
+/*
+ * ListenerHooks.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#ifndef LISTENERHOOKS_H_
+#define LISTENERHOOKS_H_
+
+#include <stdint.h>
+#include <string>
+
+namespace paxos
+{
+
+	/**
+	 * Calls the optional methods of a listener: each returns false, without calling anything,
+	 * if the listener does not implement the method (see PaxosService).
+	 */
+	class ListenerHooks
+	{
+	public:
+		template<class ListenerType> static bool onSnapshot(ListenerType& listener, uint32_t decisionId, const std::string& state)
+		{
+			return restore(listener, decisionId, state, 0);
+		}
+
+		template<class ListenerType> static bool onDecisionsLost(ListenerType& listener, uint32_t from, uint32_t to)
+		{
+			return lose(listener, from, to, 0);
+		}
+
+	private:
+		template<class ListenerType> static auto restore(ListenerType& listener, uint32_t decisionId, const std::string& state, int)
+			-> decltype(listener.onSnapshot(decisionId, state), bool())
+		{
+			listener.onSnapshot(decisionId, state);
+			return true;
+		}
+
+		template<class ListenerType> static bool restore(ListenerType&, uint32_t, const std::string&, long)
+		{
+			return false;
+		}
+
+		template<class ListenerType> static auto lose(ListenerType& listener, uint32_t from, uint32_t to, int)
+			-> decltype(listener.onDecisionsLost(from, to), bool())
+		{
+			listener.onDecisionsLost(from, to);
+			return true;
+		}
+
+		template<class ListenerType> static bool lose(ListenerType&, uint32_t, uint32_t, long)
+		{
+			return false;
+		}
+	};
+
+}
+
+#endif /* LISTENERHOOKS_H_ */
@@ -14,6 +14,7 @@
 #include <string>
 #include <memory>
 #include <boost/asio.hpp>
+#include <boost/atomic.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/bind.hpp>
@@ -21,14 +22,26 @@
 #include <boost/system/error_code.hpp>
 #include <boost/thread.hpp>
 #include "protocole/message.hpp"
+#include "protocole/codec.hpp"
+#include "protocole/catchup.hpp"
+#include "protocole/fragment.hpp"
 #include "configuration/Configurator.h"
 #include "handlers/roles/AcceptorMH.hpp"
 #include "handlers/roles/ProposerMH.hpp"
 #include "handlers/roles/LearnerMH.hpp"
-
-#include <sys/time.h>
-
-#define BUFFER_SIZE 1024
+#include "handlers/DecisionSequencer.hpp"
+#include "handlers/FragmentReassembler.hpp"
+#include "handlers/ValueCache.hpp"
+#include "handlers/TimerWheel.hpp"
+#include "handlers/RttEstimator.hpp"
+#include "handlers/PhiAccrualDetector.hpp"
+#include "handlers/SubmissionQueue.hpp"
+#include "handlers/Clock.hpp"
+#include "handlers/ListenerHooks.hpp"
+#include "logging/Logger.hpp"
+#include "metrics/PaxosMetrics.hpp"
+#include "transport/MulticastTransport.hpp"
+#include "transport/UnicastTransport.hpp"
 
 using namespace std;
 using namespace boost;
@@ -36,11 +49,11 @@ using namespace boost;
 namespace paxos
 {
 
-	typedef boost::shared_ptr<asio::io_service> 		io_service_ptr_t;
-	typedef boost::shared_ptr<asio::ip::udp::socket> 	socket_ptr_t;//scoped_ptr
-	typedef boost::shared_ptr<asio::deadline_timer> 	deadline_timer_ptr_t;
+	typedef boost::shared_ptr<Transport> 				transport_ptr_t;
 
 	const uint8_t STANBY_HEARTBEAT_COUNT = 3;
+	const uint8_t CATCHUP_LOST_ROUNDS = 2;//catch-up rounds to all peers only answered by "no longer held"
+	const uint8_t CATCHUP_SNAPSHOT_ROUNDS = 4;//catch-up rounds before the same snapshot is sent again to a peer
 
 	/**
 	 * Paxos Linehandler handles the routing of messages based on its associated handlers roles.
@@ -56,14 +69,31 @@ namespace paxos
 	public:
 		PaxosLH(io_service_ptr_t io_service_ptr, boost::shared_ptr<PaxosListenerType> listener)
 			: mpIOService(io_service_ptr),
-			  mPort(0), mTTL(22),
-			  mSocketSend(new asio::ip::udp::socket(*mpIOService)),
-			  mSocketRcvd(new asio::ip::udp::socket(*mpIOService)),
+			  mClock(new AsioClock(io_service_ptr)),
+			  mListener(listener),
+			  hasProposer(false), hasAcceptor(false), hasLearner(false),
+			  mPhaseTimeoutMs(250), mAdaptiveTimeout(false), mHeartbeatMs(10000), mAcceptResendUs(0), mLastMessageMs(0),
+			  mCatchUpRange(64), mCatchUpTimeoutMs(50), mCatchUpPending(false), mCatchUpAnyPeer(false), mCatchUpEnd(0), mLostFrom(0), mLostEnd(0), mLostRounds(0), mBehindEnd(0), mBehindCounted(0), mSnapshotSentId(NO_DECISION), mSnapshotSentMs(0), mPipelineWindow(1), mPrepareTimed(false), mPrepareSentUs(0), mPrepareProposal(0),
+			  mLeaseUs(0), mLeaseGrantUs(0), mLeaseExpiryUs(0), mLeaseDecisionId(0), mFragmentSequence(0), mValueReferences(false)
+			{
+				mDrainPosted.store(false);
+			}
+
+		/**
+		 * Line handler over a given transport and clock (e.g. a simulated network), the
+		 * transport configured in the XML is then ignored.
+		 */
+		PaxosLH(io_service_ptr_t io_service_ptr, boost::shared_ptr<PaxosListenerType> listener, transport_ptr_t transport, clock_ptr_t clock)
+			: mpIOService(io_service_ptr),
+			  mTransport(transport),
+			  mClock(clock),
 			  mListener(listener),
 			  hasProposer(false), hasAcceptor(false), hasLearner(false),
-			  mPhaseTimeoutMs(250), mHeartbeatMs(10000), mLastMessageMs(0), mStandbyIdleTimeMs(0)
+			  mPhaseTimeoutMs(250), mAdaptiveTimeout(false), mHeartbeatMs(10000), mAcceptResendUs(0), mLastMessageMs(0),
+			  mCatchUpRange(64), mCatchUpTimeoutMs(50), mCatchUpPending(false), mCatchUpAnyPeer(false), mCatchUpEnd(0), mLostFrom(0), mLostEnd(0), mLostRounds(0), mBehindEnd(0), mBehindCounted(0), mSnapshotSentId(NO_DECISION), mSnapshotSentMs(0), mPipelineWindow(1), mPrepareTimed(false), mPrepareSentUs(0), mPrepareProposal(0),
+			  mLeaseUs(0), mLeaseGrantUs(0), mLeaseExpiryUs(0), mLeaseDecisionId(0), mFragmentSequence(0), mValueReferences(false)
 			{
-				memset(mReadBuffer,0,sizeof(mReadBuffer));
+				mDrainPosted.store(false);
 			}
 
 		~PaxosLH(){};
@@ -74,18 +104,23 @@ namespace paxos
 		void async_start();
 		void stop();
 		bool propose(const string& value);
+		bool submit(string& command, bool wait);
+		size_t readDecided(uint32_t from, uint32_t to, std::vector<DecidedValue>& values) const;
+		bool saveSnapshot(uint32_t decisionId, const std::string& state);
+		bool loadSnapshot(uint32_t& decisionId, std::string& state) const;
+		void snapshotMetrics(MetricsSnapshot& snapshot) const {mMetrics.snapshot(snapshot);}
+		bool hasLeaderLease();
+		bool isLeader() {return hasProposer && mProposer.isLeader();}
 
 	private:
 		io_service_ptr_t 				mpIOService;
-		short  							mPort;
-		uint8_t 						mTTL;
-		socket_ptr_t					mSocketSend;
-		socket_ptr_t					mSocketRcvd;
-		string  						mGroup;
+		transport_ptr_t					mTransport;
+		clock_ptr_t						mClock;
 		string 							mLocalAddr;
-		char    						mReadBuffer[BUFFER_SIZE];
-		asio::ip::udp::endpoint  		mMCAddr;
-		asio::ip::udp::endpoint 		sender_endpoint_;
+		vector<char>					mDurableReplies;//acceptor replies waiting for the log commit
+		vector<size_t>					mDurableReplySizes;
+		vector<MsgId>					mDurableReplyIds;
+		MessageCodec					mCodec;
 		AcceptorMH<PaxosListenerType> 	mAcceptor;
 		ProposerMH<PaxosListenerType> 	mProposer;
 		LearnerMH<PaxosListenerType> 	mLearner;
@@ -96,29 +131,114 @@ namespace paxos
 		bool 							hasLearner;
 
 		int 							mPhaseTimeoutMs	;
+		bool							mAdaptiveTimeout;//phase timeouts from the acceptor round-trip times
+		RttEstimator					mRtt;
 		int 							mHeartbeatMs;
-		deadline_timer_ptr_t 			mProposerTimer;
+		TimerWheel						mTimers;//declared before its entries
+		TimerWheel::Entry				mPhaseTimeout;//the proposer waits on one of the three at a time
+		TimerWheel::Entry				mHeartbeatTimeout;
+		TimerWheel::Entry				mStandbyTimeout;
+		TimerWheel::Entry				mBatchLingerTimeout;
+		TimerWheel::Entry				mAcceptResendTimeout;//sends the overdue accept requests again, see resendOverdueAccepts()
+		uint64_t						mAcceptResendUs;
 		string 							mProposerId;
 		long							mLastMessageMs;//millisecond is enough for heartbeat timeouts
-		long							mStandbyIdleTimeMs;//used by standby timer to avoid resetting the timer with each received message
+		PhiAccrualDetector				mFailureDetector;//of the leader, fed by its requests
+		string							mNodeId;//first role id, names this node in catch-up messages
+		string							mLeaderId;//leader of the last delivered decision
+		DecisionSequencer				mSequencer;
+		string							mHeldValue;
+		string							mChunk;
+		uint32_t						mCatchUpRange;
+		int								mCatchUpTimeoutMs;
+		TimerWheel::Entry				mCatchUpTimeout;
+		TimerWheel::Entry				mLearnerSyncTimeout;//the learner log is made durable every sync_ms
+		bool							mCatchUpPending;
+		bool							mCatchUpAnyPeer;//the request is sent to all the peers, not to the leader
+		uint32_t						mCatchUpEnd;//end of the range requested
+		set<string>						mLostPeers;//answered that they no longer hold the decisions from mLostFrom
+		uint32_t						mLostFrom;
+		uint32_t						mLostEnd;//lowest decision still held by one of them
+		uint8_t							mLostRounds;
+		uint32_t						mBehindEnd;//highest position of the peers behind mLostFrom, they may still get the decisions
+		uint32_t						mBehindCounted;//mBehindEnd at the last catch-up round
+		string							mSnapshotSentTo;//last peer sent a snapshot, not sent again before CATCHUP_SNAPSHOT_ROUNDS
+		uint32_t						mSnapshotSentId;
+		long							mSnapshotSentMs;
+		uint32_t						mPipelineWindow;//gaps within it are usually reordered decisions
+		PaxosMetrics					mMetrics;
+		bool							mPrepareTimed;//a prepare request waits for its promise quorum
+		uint64_t						mPrepareSentUs;
+		uint32_t						mPrepareProposal;
+		vector<uint64_t>				mAcceptSentUs;//first accept request sent for mAcceptSentIds[decisionId % window]
+		vector<uint32_t>				mAcceptSentIds;
+		vector<bool>					mAcceptResent;//its replies are not RTT samples
+		vector<uint64_t>				mAcceptLastSentUs;//of the last accept request sent for it
+		SubmissionQueue					mSubmissions;//from the application threads
+		boost::atomic<bool>				mDrainPosted;//a drainSubmissions() is posted and not started yet
+		string							mSubmitted;
+		uint64_t						mLeaseUs;//lease.duration_ms less the drift, 0 if leases are disabled
+		uint64_t						mLeaseGrantUs;//lease.duration_ms plus the drift, granted by the acceptor
+		uint64_t						mLeaseExpiryUs;
+		uint32_t						mLeaseDecisionId;//the reads wait until the decisions before it are delivered
+		vector<char>					mLargeMessage;//encoded message larger than a datagram
+		uint32_t						mFragmentSequence;//of the messages sent in fragments
+		MessageFragment					mFragment;
+		FragmentReassembler				mReassembler;
+		bool							mValueReferences;//see XML_VALUE_REFERENCES
+		ValueCache						mValueCache;//payloads of the accept requests received
 
 		void setProposerPhaseTimeOut();
 		void setProposerHeartbeatTimeOut();
 		void setProposerStandbyTimeOut();
-		void postReceive();
-		void handleReceive(const boost::system::error_code& error, std::size_t size);
-		void onProposerPhaseTimeout(const boost::system::error_code& before_timeout);
-		void onProposerHeartbeatTimeout(const boost::system::error_code& before_timeout);
-		void onProposerStandbyTimeout(const boost::system::error_code& before_timeout);
+		void setProposerTimeOut(TimerWheel::Entry& timeout, long ms);
+		void handleMessage(const char* data, std::size_t size);
+		void sendDurable(const PaxosMessage& message);
+		void flushDurableReplies();
+		void onProposerPhaseTimeout();
+		void onProposerHeartbeatTimeout();
+		void resendOverdueAccepts(uint64_t overdueUs);
+		void onAcceptResendTimeout();
+		void onProposerStandbyTimeout();
+		void onBatchLingerTimeout();
+		void proposeBatch(bool lingerExpired);
+		void drainSubmissions();
+		void deliver(uint32_t decisionId, const std::string& value);
+		void deliverReference(uint32_t decisionId, uint64_t digest);
+		void apply(uint32_t decisionId, const std::string& value);
+		void drainHeld();
+		void awaitGap();
+		void requestCatchUp(bool anyPeer);
+		void replyCatchUp(const PaxosMessage& request);
+		void onCatchUpChunk(const PaxosMessage& chunk);
+		void onCatchUpSnapshot(const PaxosMessage& snapshot);
+		void onCatchUpTimeout();
+		void onLearnerSyncTimeout();
+		void skipLost();
 		void send(const PaxosMessage& message);
-		void send(const uint32_t decision, const MsgId msgId, const std::string& sender, const uint32_t proposal, const std::string& value );
+		void send(const uint32_t decision, const MsgId msgId, const std::string& sender, const uint32_t proposal, const std::string& value, const uint16_t senderIndex = NO_NODE_INDEX, const uint64_t digest = 0);
+		bool sendEncoded(MsgId msgId, const char* data, size_t size);
+		bool isLeaseRunning();
+		long getPhaseTimeoutMs();
 		long getTimestamp();
 	};
 
 template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::start()
 {
-	mStandbyIdleTimeMs = mHeartbeatMs;
-	postReceive();
+	async_start();
+	mpIOService->run();
+}
+
+/**
+ * Starts receiving and the proposer timers, the caller runs the io_service (or the simulated network).
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::async_start()
+{
+	mTransport->start(boost::bind(&PaxosLH::handleMessage, this, _1, _2), boost::bind(&PaxosLH::flushDurableReplies, this));
+	if (hasLearner && mLearner.getSyncMs() > 0)
+	{
+		mTimers.arm(mLearnerSyncTimeout, mLearner.getSyncMs());
+	}
 	if (hasProposer)
 	{
 		if (mProposer.isStartModeLeader())
@@ -132,46 +252,550 @@ template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::start()
 			setProposerStandbyTimeOut();
 		}
 	}
-	mpIOService->run();
-}
-
-template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::async_start()
-{
 }
 
 template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::stop()
 {
-	mSocketSend->close();
-	mSocketRcvd->close();
+	mTransport->close();
 }
 
+/**
+ * Queues the command for the next batch, only the leader accepts proposals.
+ * The batch is sent once full, or after batch_linger_ms.
+ */
 template<class PaxosListenerType> inline bool PaxosLH<PaxosListenerType>::propose(const string& value)
 {
-	if (hasProposer && mProposer.isLeader())
+	string command(value);
+	if (hasProposer && mProposer.isLeader() && mProposer.enqueue(command, mClock->getMicroseconds()))
 	{
-		send(mProposer.getPing());//dummy command not implemented in this release
+		mMetrics.increment(METRIC_PROPOSED_COMMANDS);
+		proposeBatch(false);
 		return true;
 	}
 	return false;
 
 }
 
+/**
+ * Any thread: queues the command (its content is taken) for the io thread, which proposes the
+ * queued commands in batches. Returns false if the queue is full, unless wait is set: then it
+ * waits for room, i.e. applies backpressure to the caller.
+ */
+template<class PaxosListenerType> bool PaxosLH<PaxosListenerType>::submit(string& command, bool wait)
+{
+	if (!mSubmissions.push(command, mClock->getMicroseconds(), wait))
+	{
+		return false;
+	}
+	if (!mDrainPosted.exchange(true))
+	{
+		mClock->post(boost::bind(&PaxosLH::drainSubmissions, this));
+	}
+	return true;
+}
+
+/**
+ * Proposes the submitted commands, at most a queue capacity of them per run so that the messages
+ * received meanwhile are handled. The commands drained while this node is not the leader are rejected.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::drainSubmissions()
+{
+	mDrainPosted.store(false);//a command submitted from now on posts the next run
+	uint64_t submittedUs;
+	size_t count = 0;
+	while (count < mSubmissions.getCapacity() && mSubmissions.pop(mSubmitted, submittedUs))
+	{
+		count++;
+		if (hasProposer && mProposer.isLeader() && mProposer.enqueue(mSubmitted, submittedUs))
+		{
+			mMetrics.increment(METRIC_PROPOSED_COMMANDS);
+		}
+		else
+		{
+			mMetrics.increment(METRIC_REJECTED_COMMANDS);
+		}
+	}
+	if (count == mSubmissions.getCapacity() && !mDrainPosted.exchange(true))
+	{
+		mClock->post(boost::bind(&PaxosLH::drainSubmissions, this));
+	}
+	if (hasProposer)
+	{
+		proposeBatch(false);
+	}
+}
+
+/**
+ * True if this node is the leader and its lease runs: the acceptors refuse to promise another proposer,
+ * so no decision is chosen without it, and the listener got the decisions up to the one which renewed
+ * the lease. The state of the listener can then serve linearizable reads without a consensus round.
+ */
+template<class PaxosListenerType> inline bool PaxosLH<PaxosListenerType>::hasLeaderLease()
+{
+	return hasProposer && isLeaseRunning() && mSequencer.getNextDecisionId() >= mLeaseDecisionId;
+}
+
+/**
+ * Reads the decided values of [from, to) stored by the learner (none without learner log),
+ * valid until the next value is stored or the log is truncated.
+ */
+template<class PaxosListenerType> inline size_t PaxosLH<PaxosListenerType>::readDecided(uint32_t from, uint32_t to, std::vector<DecidedValue>& values) const
+{
+	return hasLearner ? mLearner.read(from, to, values) : 0;
+}
+
+/**
+ * Stores the snapshot with the learner, then truncates the learner log and acceptor state below decisionId.
+ */
+template<class PaxosListenerType> bool PaxosLH<PaxosListenerType>::saveSnapshot(uint32_t decisionId, const std::string& state)
+{
+	if (!hasLearner || !mLearner.saveSnapshot(decisionId, state))
+	{
+		return false;
+	}
+	if (hasAcceptor)
+	{
+		mAcceptor.truncate(decisionId);
+	}
+	return true;
+}
+
+template<class PaxosListenerType> inline bool PaxosLH<PaxosListenerType>::loadSnapshot(uint32_t& decisionId, std::string& state) const
+{
+	return hasLearner && mLearner.loadSnapshot(decisionId, state);
+}
+
+/**
+ * Starts decisions for the queued commands, and the values adopted in phase 1, while the pipeline window allows it.
+ * Otherwise the batches are sent at the end of the decisions in flight.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::proposeBatch(bool lingerExpired)
+{
+	while (mProposer.isLeader() && mProposer.canPropose() && (mProposer.hasPendingCommands() || mProposer.hasAdoptedValue()))
+	{
+		if (!lingerExpired && !mProposer.isBatchFull() && !mProposer.hasAdoptedValue() && mProposer.getBatchLingerMs() > 0)
+		{
+			if (!mBatchLingerTimeout.isArmed())
+			{
+				mTimers.arm(mBatchLingerTimeout, mProposer.getBatchLingerMs());
+			}
+			return;
+		}
+		bool idle = !mProposer.hasInFlightDecisions();
+		send(mProposer.getNextRequest());
+		if (idle)
+		{
+			setProposerPhaseTimeOut();//the timer tracks the oldest decision in flight
+		}
+	}
+}
+
+/**
+ * Delivers the decisions in order: a decision received ahead of the next one is held
+ * and the missing ones are awaited, then requested to the peers (see protocole/catchup.hpp).
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::deliver(uint32_t decisionId, const std::string& value)
+{
+	if (decisionId < mSequencer.getNextDecisionId())
+	{
+		return;//already delivered (e.g. the consensus notification of a decision learned by this proposer)
+	}
+	if (decisionId > mSequencer.getNextDecisionId())
+	{
+		mSequencer.hold(decisionId, value);
+		awaitGap();
+		return;
+	}
+	apply(decisionId, value);
+	drainHeld();
+}
+
+/**
+ * Delivers a decision notified by value reference: the payload is the one of the accept request
+ * received for it, else the decision is caught up from the peers.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::deliverReference(uint32_t decisionId, uint64_t digest)
+{
+	if (decisionId < mSequencer.getNextDecisionId())
+	{
+		return;
+	}
+	const std::string* value = mValueCache.get(digest);
+	if (value != NULL)
+	{
+		deliver(decisionId, *value);
+		return;
+	}
+	mSequencer.expect(decisionId);
+	requestCatchUp(false);
+}
+
+/**
+ * Delivers the held decisions following the last delivered one.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::drainHeld()
+{
+	uint32_t heldId;
+	while (mSequencer.popHeld(heldId, mHeldValue))
+	{
+		apply(heldId, mHeldValue);
+	}
+	awaitGap();
+}
+
+/**
+ * With pipeline_window decisions in flight, the decisions before a held one are usually
+ * reordered and arrive before the catch-up timer: they are requested if the gap is still
+ * open then, or at once if it spans more than the window.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::awaitGap()
+{
+	if (mCatchUpPending)
+	{
+		return;
+	}
+	if (!mSequencer.hasGap())
+	{
+		mTimers.cancel(mCatchUpTimeout);//the awaited decisions arrived
+		return;
+	}
+	if (mSequencer.getKnownEnd() - mSequencer.getNextDecisionId() > mPipelineWindow)
+	{
+		requestCatchUp(false);
+	}
+	else if (!mCatchUpTimeout.isArmed())
+	{
+		mTimers.arm(mCatchUpTimeout, mCatchUpTimeoutMs);
+	}
+}
+
+/**
+ * Notifies the listener once per decided command: no-op decisions only track the leader.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::apply(uint32_t decisionId, const std::string& value)
+{
+	size_t offset = 0;
+	const char* data;
+	uint32_t size;
+	mSequencer.delivered(decisionId, value);
+	if (hasLearner) mLearner.onConsensus(decisionId, value);
+	string leaderId = ValueBatch::leaderOf(value);
+	if (leaderId != mLeaderId)
+	{
+		if (!mLeaderId.empty()) mMetrics.increment(METRIC_LEADER_CHANGES);//the first leader seen is not a change
+		mLeaderId.swap(leaderId);
+	}
+	while (ValueBatch::next(value, offset, data, size))
+	{
+		mListener->onConsensus(decisionId, std::string(data, size));
+	}
+}
+
+/**
+ * Asks for the decisions between the next one to deliver and the first held one, at most
+ * catchup.range of them. The leader is asked first, any peer holding them on retries.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::requestCatchUp(bool anyPeer)
+{
+	if (!mSequencer.hasGap() || (mCatchUpPending && !anyPeer))
+	{
+		return;
+	}
+	uint32_t from = mSequencer.getNextDecisionId();
+	mCatchUpEnd = std::min(mSequencer.getGapEnd(), from + mCatchUpRange);
+	mCatchUpPending = true;
+	mCatchUpAnyPeer = anyPeer;
+	send(from, CATCHUP_REQUEST, mNodeId, mCatchUpEnd, anyPeer ? "" : mLeaderId);
+	mTimers.arm(mCatchUpTimeout, mCatchUpTimeoutMs);
+}
+
+/**
+ * Streams the requested decisions found in the history or the learner log, packed in chunks.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::replyCatchUp(const PaxosMessage& request)
+{
+	const std::string& target = request.mValue;
+	if (request.mSenderId == mNodeId || !(target.empty() || target == mProposerId))
+	{
+		return;
+	}
+	uint32_t lowest = mSequencer.getLowestDelivered();
+	if (hasLearner && mLearner.getFirstDecisionId() < lowest) lowest = mLearner.getFirstDecisionId();
+	uint32_t start = request.mDecisionId;
+	uint32_t snapshotId;
+	const std::string* snapshot;
+	if (start < lowest && hasLearner && (snapshot = mLearner.getSnapshot(snapshotId)) != NULL && snapshotId > start)
+	{//the decisions it covers are no longer held
+		long nowMs = getTimestamp();
+		if (request.mSenderId != mSnapshotSentTo || snapshotId != mSnapshotSentId || nowMs - mSnapshotSentMs >= (long) mCatchUpTimeoutMs * CATCHUP_SNAPSHOT_ROUNDS)
+		{//a large snapshot may outlast a catch-up round: it is not sent again at each retry
+			send(snapshotId, CATCHUP_SNAPSHOT, mNodeId, lowest, *snapshot);
+			mSnapshotSentTo = request.mSenderId;
+			mSnapshotSentId = snapshotId;
+			mSnapshotSentMs = nowMs;
+		}
+		start = snapshotId;
+	}
+	size_t capacity = BUFFER_SIZE - MessageCodec::HEADER_SIZE - mNodeId.size() - 32;//room for the text header too
+	uint32_t chunkStart = start;
+	mChunk.clear();
+	for (uint32_t decisionId = start; decisionId < request.mProposal && decisionId < mSequencer.getNextDecisionId(); decisionId++)
+	{
+		const char* data;
+		uint32_t size;
+		const std::string* value = mSequencer.getDelivered(decisionId);
+		if (value != NULL)
+		{
+			data = value->data();
+			size = value->size();
+		}
+		else if (!hasLearner || !mLearner.get(decisionId, data, size))
+		{
+			continue;
+		}
+		if (!mChunk.empty() && mChunk.size() + CatchUpChunk::ENTRY_HEADER_SIZE + size > capacity)
+		{
+			send(chunkStart, CATCHUP_CHUNK, mNodeId, lowest, mChunk);
+			mChunk.clear();
+			chunkStart = decisionId;
+		}
+		CatchUpChunk::append(mChunk, decisionId, data, size);
+	}
+	if (!mChunk.empty() || start < lowest)
+	{
+		send(chunkStart, CATCHUP_CHUNK, mNodeId, lowest, mChunk);
+	}
+	else if (target.empty() && request.mDecisionId >= mSequencer.getNextDecisionId())
+	{//behind: tells where this node is, the requester waits while it catches up
+		send(mSequencer.getNextDecisionId(), CATCHUP_CHUNK, mNodeId, lowest, mChunk);
+	}
+}
+
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onCatchUpChunk(const PaxosMessage& chunk)
+{
+	if (chunk.mSenderId == mNodeId || !mSequencer.hasGap())
+	{
+		return;
+	}
+	size_t offset = 0;
+	uint32_t decisionId;
+	const char* data;
+	uint32_t size;
+	while (CatchUpChunk::next(chunk.mValue, offset, decisionId, data, size))
+	{
+		if (decisionId >= mSequencer.getNextDecisionId())
+		{
+			deliver(decisionId, std::string(data, size));
+		}
+	}
+	if (mSequencer.getNextDecisionId() != mLostFrom)
+	{
+		mLostFrom = mSequencer.getNextDecisionId();
+		mLostPeers.clear();
+		mLostRounds = 0;
+		mBehindEnd = 0;
+		mBehindCounted = 0;
+	}
+	if (chunk.mValue.empty() && chunk.mProposal <= chunk.mDecisionId && chunk.mDecisionId < mSequencer.getNextDecisionId())
+	{
+		mBehindEnd = std::max(mBehindEnd, chunk.mDecisionId + 1);
+	}
+	if (mSequencer.hasGap() && chunk.mProposal > mSequencer.getNextDecisionId())
+	{//the sender truncated them, another peer or learner log may still hold them
+		mLostEnd = mLostPeers.empty() ? chunk.mProposal : std::min(mLostEnd, chunk.mProposal);
+		mLostPeers.insert(chunk.mSenderId);
+		if (!mCatchUpAnyPeer)
+		{
+			requestCatchUp(true);
+		}
+	}
+	if (mSequencer.getNextDecisionId() >= mCatchUpEnd)
+	{
+		mCatchUpPending = false;
+		requestCatchUp(false);
+	}
+}
+
+/**
+ * Restores the snapshot of a peer which no longer holds the decisions it covers: the listener
+ * restores the state, the learner stores it, and the delivery resumes at the snapshot decision.
+ * Ignored if the listener does not implement onSnapshot: the decisions are then reported lost.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onCatchUpSnapshot(const PaxosMessage& snapshot)
+{
+	if (snapshot.mSenderId == mNodeId || !mSequencer.hasGap() || snapshot.mDecisionId <= mSequencer.getNextDecisionId())
+	{
+		return;
+	}
+	uint32_t from = mSequencer.getNextDecisionId();
+	if (!ListenerHooks::onSnapshot(*mListener, snapshot.mDecisionId, snapshot.mValue))
+	{
+		return;
+	}
+	PAXOS_WARN("Decisions [{}, {}) are no longer held by {} => its snapshot is restored.") << from << snapshot.mDecisionId << snapshot.mSenderId;
+	if (hasLearner && !mLearner.installSnapshot(snapshot.mDecisionId, snapshot.mValue))
+	{
+		PAXOS_ERROR("Snapshot at decision#{} can not be stored => the learner log resumes without it.") << snapshot.mDecisionId;
+	}
+	if (hasAcceptor)
+	{
+		mAcceptor.truncate(snapshot.mDecisionId);
+	}
+	mSequencer.skipTo(snapshot.mDecisionId);
+	mLostPeers.clear();
+	mLostRounds = 0;
+	mCatchUpPending = false;
+	drainHeld();
+	if (mSequencer.getNextDecisionId() >= mCatchUpEnd)
+	{
+		requestCatchUp(false);
+	}
+}
+
+/**
+ * Waits for the write back of the learner log scheduled at the end of the receive batches.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onLearnerSyncTimeout()
+{
+	mLearner.sync(true);
+	mTimers.arm(mLearnerSyncTimeout, mLearner.getSyncMs());
+}
+
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onCatchUpTimeout()
+{
+	if (!mCatchUpPending)
+	{
+		requestCatchUp(false);//the gap awaited is still open
+		return;
+	}
+	mCatchUpPending = false;
+	if (mCatchUpAnyPeer && !mLostPeers.empty() && mSequencer.hasGap() && mLostFrom == mSequencer.getNextDecisionId())
+	{
+		if (mBehindEnd > mBehindCounted)
+		{
+			mBehindCounted = mBehindEnd;//a peer behind moved on, it may hold them by the next round
+		}
+		else if (++mLostRounds >= CATCHUP_LOST_ROUNDS)
+		{
+			skipLost();
+			return;
+		}
+	}
+	requestCatchUp(true);//the leader did not answer or lacks some decisions
+}
+
+/**
+ * Skips the missing decisions once the peers which answered the last catch-up rounds no longer hold
+ * them nor a snapshot covering them, or are behind and do not move on: the listener must restore a
+ * snapshot taken at or after the end of the range skipped. A listener without onDecisionsLost keeps
+ * waiting for a peer which holds them.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::skipLost()
+{
+	uint32_t from = mSequencer.getNextDecisionId();
+	uint32_t to = std::min(mLostEnd, mSequencer.getGapEnd());
+	size_t peers = mLostPeers.size();
+	mLostPeers.clear();
+	mLostRounds = 0;
+	if (!ListenerHooks::onDecisionsLost(*mListener, from, to))
+	{
+		PAXOS_ERROR("Decisions [{}, {}) are no longer held by the peers which answered => delivery waits for them.") << from << to;
+		requestCatchUp(true);
+		return;
+	}
+	PAXOS_WARN("Decisions [{}, {}) are no longer held by any of the {} peers which answered => they are skipped.") << from << to << peers;
+	mSequencer.skipTo(to);
+	drainHeld();
+}
+
 template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::configure(const boost::property_tree::ptree& configuration)
 {
 	try
 	{
-		mLocalAddr = configuration.get<std::string>(XML_INTERFACE);
-		mGroup = configuration.get<std::string>(XML_GROUP);
-		mPort = configuration.get<short>(XML_PORT);
-		mTTL = configuration.get<uint8_t>(XML_TTL);
-		std::cout << "PaxosLH(" <<mLocalAddr << "," << mGroup << ":" << mPort <<  ") is configured:" << std::endl;
+		mLocalAddr = configuration.get<std::string>(XML_INTERFACE, "");
+		mCodec.setFormat(MessageCodec::parseFormat(configuration.get<std::string>(XML_WIRE_FORMAT, "text")));
+		string transport = configuration.get<std::string>(XML_TRANSPORT, "multicast");
+		if (!mTransport && transport == "multicast")
+		{
+			mTransport = transport_ptr_t(new MulticastTransport());
+		}
+		else if (!mTransport && transport == "unicast")
+		{
+			mTransport = transport_ptr_t(new UnicastTransport());
+		}
+		else if (!mTransport)
+		{
+			throw std::runtime_error(XML_TRANSPORT + " must be multicast or unicast");
+		}
+		mTransport->configure(configuration);
+		mReassembler.configure(configuration.get<size_t>(XML_REASSEMBLY_MAX_BYTES, 64 << 20), configuration.get<size_t>(XML_REASSEMBLY_MAX_MESSAGE_BYTES, 16 << 20),
+				configuration.get<long>(XML_REASSEMBLY_TIMEOUT_MS, 1000));
+		mReassembler.setMetrics(&mMetrics);
+		mSequencer.configure(configuration.get<size_t>(XML_CATCHUP_HISTORY, 1024), configuration.get<size_t>(XML_CATCHUP_MAX_HELD, 4096));
+		mCatchUpRange = configuration.get<uint32_t>(XML_CATCHUP_RANGE, 64);
+		mCatchUpTimeoutMs = configuration.get<int>(XML_CATCHUP_TIMEOUT_MS, 50);
+		mSubmissions.configure(configuration.get<size_t>(XML_SUBMIT_QUEUE, 4096));
+		mValueReferences = configuration.get<bool>(XML_VALUE_REFERENCES, false);
+		if (mValueReferences && mCodec.getFormat() != WIRE_BINARY)
+		{//the text format does not carry the digest
+			throw std::runtime_error(XML_VALUE_REFERENCES + " requires " + XML_WIRE_FORMAT + " binary");
+		}
+		mValueCache.configure(configuration.get<size_t>(XML_VALUE_CACHE_ENTRIES, 1024), configuration.get<size_t>(XML_VALUE_CACHE_MAX_BYTES, 64 << 20));
+		uint64_t leaseMs = configuration.get<uint64_t>(XML_LEASE_MS, 0);
+		uint64_t driftPpm = configuration.get<uint64_t>(XML_LEASE_MAX_DRIFT_PPM, 1000);
+		if (driftPpm >= 1000000)
+		{
+			throw std::runtime_error(XML_LEASE_MAX_DRIFT_PPM + " must be < 1000000");
+		}
+		mLeaseUs = leaseMs * (1000000 - driftPpm) / 1000;
+		mLeaseGrantUs = leaseMs * (1000000 + driftPpm) / 1000;
+		if (mCatchUpRange == 0)
+		{
+			throw std::runtime_error(XML_CATCHUP_RANGE + " must be > 0");
+		}
+		std::cout << "PaxosLH(" << mTransport->getDescription() <<  ") is configured:" << std::endl;
 		if (Configurator::isParameterSet(configuration, XML_PROPOSER_ID) )
 		{
 			mProposer.configure(configuration);
 			hasProposer = true;
 			mHeartbeatMs = configuration.get<int>(XML_PROPOSER_HEARTBEAT_MS);
 			mPhaseTimeoutMs = configuration.get<int>(XML_PROPOSER_PHASE_TIMEOUT_MS);
+			int phaseTimeoutMaxMs = configuration.get<int>(XML_PROPOSER_PHASE_TIMEOUT_MAX_MS, 0);
+			int phaseTimeoutMinMs = configuration.get<int>(XML_PROPOSER_PHASE_TIMEOUT_MIN_MS, 1);
+			mAdaptiveTimeout = phaseTimeoutMaxMs > 0;
+			if (mAdaptiveTimeout && (phaseTimeoutMinMs < 1 || phaseTimeoutMinMs > phaseTimeoutMaxMs))
+			{
+				throw std::runtime_error(XML_PROPOSER_PHASE_TIMEOUT_MIN_MS + " must be >= 1 and <= " + XML_PROPOSER_PHASE_TIMEOUT_MAX_MS);
+			}
+			mRtt.configure(mProposer.getQuorum().size(), mProposer.getQuorum().getMajority(), (uint64_t) mPhaseTimeoutMs * 1000,
+					(uint64_t) phaseTimeoutMinMs * 1000, (uint64_t) phaseTimeoutMaxMs * 1000);
+			if (mAdaptiveTimeout)
+			{
+				std::cout << "\tPhase timeout from the acceptor round-trip times, in [" << phaseTimeoutMinMs << ", " << phaseTimeoutMaxMs << "] ms" << std::endl;
+			}
 			mProposerId = mProposer.getId();
+			if (leaseMs > 0 && (uint64_t) mHeartbeatMs > leaseMs / 2)
+			{//an idle leader renews its lease with heartbeat decisions
+				mHeartbeatMs = std::max<int>(leaseMs / 2, 1);
+				std::cout << "\t" << XML_PROPOSER_HEARTBEAT_MS << " is lowered to " << mHeartbeatMs << " ms, half the lease" << std::endl;
+			}
+			double phiThreshold = configuration.get<double>(XML_PROPOSER_PHI_THRESHOLD, 0);
+			if (phiThreshold < 0)
+			{
+				throw std::runtime_error(XML_PROPOSER_PHI_THRESHOLD + " must be >= 0");
+			}
+			uint64_t maxSilenceMs = configuration.get<uint64_t>(XML_PROPOSER_PHI_MAX_SILENCE_MS, (uint64_t) mHeartbeatMs * STANBY_HEARTBEAT_COUNT);
+			if (maxSilenceMs == 0)
+			{
+				throw std::runtime_error(XML_PROPOSER_PHI_MAX_SILENCE_MS + " must be > 0");
+			}
+			mFailureDetector.configure(phiThreshold, configuration.get<size_t>(XML_PROPOSER_PHI_WINDOW, 100),
+					configuration.get<uint64_t>(XML_PROPOSER_PHI_MIN_STD_DEVIATION_MS, std::max(mHeartbeatMs / 100, 1)) * 1000,
+					configuration.get<uint64_t>(XML_PROPOSER_PHI_ACCEPTABLE_PAUSE_MS, mHeartbeatMs / 4) * 1000, (uint64_t) mHeartbeatMs * 1000, maxSilenceMs * 1000);
+			if (mFailureDetector.isEnabled())
+			{
+				std::cout << "\tStandby takes over once the leader is suspected at phi=" << phiThreshold << std::endl;
+			}
 		}
 		if (Configurator::isParameterSet(configuration, XML_ACCEPTOR_ID) )
 		{
@@ -183,6 +807,12 @@ template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::configure(con
 			mLearner.configure(configuration);
 			hasLearner = true;
 		}
+		mNodeId = hasProposer ? mProposerId : hasAcceptor ? mAcceptor.getId() : hasLearner ? mLearner.getId() : mLocalAddr;
+		mPipelineWindow = hasProposer ? mProposer.getPipelineWindow() : hasAcceptor ? mAcceptor.getPipelineWindow() : hasLearner ? mLearner.getPipelineWindow() : 1;
+		mAcceptSentUs.assign(mPipelineWindow, 0);
+		mAcceptSentIds.assign(mPipelineWindow, NO_DECISION);
+		mAcceptResent.assign(mPipelineWindow, false);
+		mAcceptLastSentUs.assign(mPipelineWindow, 0);
 	}
 	catch (std::exception& e)
 	{
@@ -193,117 +823,205 @@ template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::configure(con
 
 template<class PaxosListenerType>  void PaxosLH<PaxosListenerType>::init()
 {
-	boost::asio::ip::udp::endpoint listen_address(boost::asio::ip::address::from_string(mLocalAddr),mPort);
-	mMCAddr = boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string(mGroup),mPort);
-
-	mSocketSend = socket_ptr_t(new boost::asio::ip::udp::socket(*mpIOService, mMCAddr.protocol()));
-	mSocketSend->set_option(boost::asio::ip::multicast::hops(mTTL));
-
-	boost::asio::ip::udp::endpoint listen_endpoint(boost::asio::ip::address::from_string(mLocalAddr), mPort);
-	mSocketRcvd->open(listen_endpoint.protocol());
-	mSocketRcvd->set_option(boost::asio::ip::udp::socket::reuse_address(true));
-	mSocketRcvd->bind(listen_endpoint);
-	mSocketRcvd->set_option(boost::asio::ip::multicast::join_group(boost::asio::ip::address::from_string(mGroup)));
-
+	mTransport->open(mpIOService);
+	mTimers.init(mClock);
+	mCatchUpTimeout.setCallback(boost::bind(&PaxosLH::onCatchUpTimeout, this));
 	std::cout << "Paxos line handler is initialized with component(s):" << std::endl;
 	if (hasProposer)
 	{
-		mProposerTimer = deadline_timer_ptr_t(new boost::asio::deadline_timer(*mpIOService, boost::posix_time::millisec(mHeartbeatMs)));//no async wait => dummy value
+		mPhaseTimeout.setCallback(boost::bind(&PaxosLH::onProposerPhaseTimeout, this));
+		mHeartbeatTimeout.setCallback(boost::bind(&PaxosLH::onProposerHeartbeatTimeout, this));
+		mStandbyTimeout.setCallback(boost::bind(&PaxosLH::onProposerStandbyTimeout, this));
+		mBatchLingerTimeout.setCallback(boost::bind(&PaxosLH::onBatchLingerTimeout, this));
+		mAcceptResendTimeout.setCallback(boost::bind(&PaxosLH::onAcceptResendTimeout, this));
+		mProposer.setMetrics(&mMetrics);
+		mProposer.setValueCache(&mValueCache);
 		mProposer.init(mListener);
 	}
 	if (hasAcceptor)
 	{
+		mAcceptor.setMetrics(&mMetrics);
+		mAcceptor.setLease(mClock, mLeaseGrantUs);
 		mAcceptor.init(mListener);
 	}
 	if (hasLearner)
 	{
+		mLearnerSyncTimeout.setCallback(boost::bind(&PaxosLH::onLearnerSyncTimeout, this));
 		mLearner.init(mListener);
+		mSequencer.skipTo(mLearner.getDecisionId());//the listener replays the learner log itself
 	}
 }
 
-template<class PaxosListenerType> inline void PaxosLH<PaxosListenerType>::send( const uint32_t decision, const MsgId msgId, const std::string& sender, const uint32_t proposal, const std::string& value )
+template<class PaxosListenerType> inline void PaxosLH<PaxosListenerType>::send( const uint32_t decision, const MsgId msgId, const std::string& sender, const uint32_t proposal, const std::string& value, const uint16_t senderIndex, const uint64_t digest )
 {
-	char buffer[BUFFER_SIZE];//move to write buffer
-	int len = sprintf ( buffer, "%d,%d,%s,%d,%s\n",decision,(uint32_t) msgId,sender.c_str(),proposal,value.c_str() );
-	mSocketSend->send_to(boost::asio::buffer(buffer,len),mMCAddr);
+	char* buffer = mTransport->reserve(msgId);
+	if (buffer == NULL)
+	{
+		mMetrics.increment(METRIC_DROPPED_MESSAGES);
+		return;
+	}
+	size_t len = mCodec.encode(buffer, BUFFER_SIZE, decision, msgId, sender, proposal, value, senderIndex, digest);
+	if (len == 0)
+	{//too large for one datagram: the reserved buffer is left unused
+		mLargeMessage.resize(MessageCodec::getCapacity(sender, value));
+		len = mCodec.encode(&mLargeMessage[0], mLargeMessage.size(), decision, msgId, sender, proposal, value, senderIndex, digest);
+		if (len == 0 || !sendEncoded(msgId, &mLargeMessage[0], len))
+		{
+			mMetrics.increment(METRIC_DROPPED_MESSAGES);
+			return;
+		}
+		mMetrics.countSent(msgId);
+		return;
+	}
+	mTransport->commit(len);
+	mMetrics.countSent(msgId);
 }
 
-template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::setProposerPhaseTimeOut()
+/**
+ * Sends an encoded message in one datagram, or in fragments if it is larger (see protocole/fragment.hpp).
+ * Returns false if it is too large for the reassembly of the peers or the transport can not queue it.
+ */
+template<class PaxosListenerType> bool PaxosLH<PaxosListenerType>::sendEncoded(MsgId msgId, const char* data, size_t size)
 {
-	if (mProposerTimer)
+	if (size <= BUFFER_SIZE)
+	{
+		return mTransport->send(msgId, data, size);
+	}
+	uint32_t count = MessageFragment::getCount(size, BUFFER_SIZE, mNodeId);
+	if (count == 0 || size > mReassembler.getMaxMessageBytes())
 	{
-		mProposerTimer->expires_from_now(boost::posix_time::millisec(mPhaseTimeoutMs));//TODO check if >0 to see if a phase is cancelled?
-		mProposerTimer->async_wait(boost::bind(&PaxosLH::onProposerPhaseTimeout, this, boost::asio::placeholders::error));
+		PAXOS_WARN("Message of {} bytes exceeds reassembly max_message_bytes={} => message is dropped.") << size << mReassembler.getMaxMessageBytes();
+		return false;
 	}
+	uint32_t sequence = mFragmentSequence++;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		char* buffer = mTransport->reserve(msgId);
+		if (buffer == NULL)
+		{
+			return false;//the fragments already queued are dropped by the peers after reassembly timeout_ms
+		}
+		mTransport->commit(MessageFragment::encode(buffer, msgId, mNodeId, sequence, data, size, i, count));
+	}
+	return true;
+}
+
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::setProposerPhaseTimeOut()
+{
+	setProposerTimeOut(mPhaseTimeout, getPhaseTimeoutMs());
 }
 
 template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::setProposerHeartbeatTimeOut()
 {
-	if (mProposerTimer)
-	{
-		mProposerTimer->expires_from_now(boost::posix_time::millisec(mHeartbeatMs));//TODO check if >0 to see if a phase is cancelled?
-		mProposerTimer->async_wait(boost::bind(&PaxosLH::onProposerHeartbeatTimeout, this, boost::asio::placeholders::error));
-	}
+	setProposerTimeOut(mHeartbeatTimeout, mHeartbeatMs);
 }
 
+/**
+ * Pushed back by each message of the leader, which is O(1) on the timer wheel.
+ */
 template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::setProposerStandbyTimeOut()
-{//restart an async wayt
-	if (mProposerTimer)
+{
+	if (mFailureDetector.isEnabled())
 	{
-		if (mStandbyIdleTimeMs > 100 )//mHeartbeatMs/10  )//check hb > 10 in this case
-		{//Optimization: We don't want to reset the timer with every message received
-			mStandbyIdleTimeMs = 0;
-			mProposerTimer->expires_from_now(boost::posix_time::millisec(mHeartbeatMs*STANBY_HEARTBEAT_COUNT));//TODO check if >0 to see if a phase is cancelled?
-			mProposerTimer->async_wait(boost::bind(&PaxosLH::onProposerStandbyTimeout, this, boost::asio::placeholders::error));
-		}
+		setProposerTimeOut(mStandbyTimeout, (mFailureDetector.getRemainingUs(mClock->getMicroseconds()) + 999) / 1000);
+	}
+	else
+	{
+		setProposerTimeOut(mStandbyTimeout, mHeartbeatMs*STANBY_HEARTBEAT_COUNT);
 	}
 }
 
-template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::postReceive()
+/**
+ * Arms timeout in place of the other proposer timeout pending, if any.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::setProposerTimeOut(TimerWheel::Entry& timeout, long ms)
 {
-	mSocketRcvd->async_receive_from(
-			boost::asio::buffer(mReadBuffer),sender_endpoint_,
-			boost::bind(&PaxosLH::handleReceive, this,
-					boost::asio::placeholders::error,
-					boost::asio::placeholders::bytes_transferred)
-	);
+	if (hasProposer)
+	{
+		mTimers.cancel(mPhaseTimeout);
+		mTimers.cancel(mHeartbeatTimeout);
+		mTimers.cancel(mStandbyTimeout);
+		mTimers.arm(timeout, ms);
+	}
 }
 
-template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::handleReceive(const boost::system::error_code& error, std::size_t size)
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::handleMessage(const char* data, std::size_t size)
 {
-	if (error)
+	if (MessageFragment::isFragment(data, size))
 	{
-		std::cerr << "ERROR on receive " << error.message() << std::endl;
-		stop();
-		return;
+		if (!mFragment.decode(data, size))
+		{
+			PAXOS_WARN("Malformed fragment of {} bytes => message is dropped.") << size;
+			mMetrics.increment(METRIC_DROPPED_MESSAGES);
+			return;
+		}
+		if (!mReassembler.add(mFragment, getTimestamp(), data, size))
+		{
+			return;//the next fragments are awaited
+		}
 	}
-	mReadBuffer[size]=0;//end of string check max size
-	mReceivedMessage.parse(mReadBuffer);
-	if (mReceivedMessage.mSenderId != mProposerId)
+	if (!MessageCodec::decode(data, size, mReceivedMessage))
 	{
-		long time = getTimestamp();
-		mStandbyIdleTimeMs = time - mLastMessageMs;
-		mLastMessageMs = time;
+		PAXOS_WARN("Malformed message of {} bytes => message is dropped.") << size;
+		mMetrics.increment(METRIC_DROPPED_MESSAGES);
+		return;
+	}
+	mMetrics.countReceived(mReceivedMessage.mMsgId);
+	if (mReceivedMessage.mSenderId != mProposerId && mReceivedMessage.mMsgId != CATCHUP_REQUEST && mReceivedMessage.mMsgId != CATCHUP_CHUNK
+			&& mReceivedMessage.mMsgId != CATCHUP_SNAPSHOT)
+	{//catch-up traffic goes on without a leader
+		mLastMessageMs = getTimestamp();
+		if (hasProposer && mFailureDetector.isEnabled() && (mReceivedMessage.mMsgId == PREPARE_REQUEST || mReceivedMessage.mMsgId == ACCEPT_REQUEST))
+		{//one arrival per leader round: its notification would add a ~0 interval, an idle leader sends heartbeat accept requests
+			mFailureDetector.heartbeat(mClock->getMicroseconds());
+		}
 	}
 	switch (mReceivedMessage.mMsgId)
 	{
 		case PREPARE_REQUEST:
-			if (hasAcceptor) send(mAcceptor.replyPrepare(mReceivedMessage));
-			if (hasProposer && mProposer.isStandby())
+			if (hasAcceptor)
 			{
+				sendDurable(mAcceptor.replyPrepare(mReceivedMessage));
+				for (size_t i = 0; i < mAcceptor.getPromisedValueCount(); i++)
+				{
+					sendDurable(mAcceptor.getPromisedValue(i));
+				}
+			}
+			if (hasProposer && (mProposer.isStandby() || (!isLeaseRunning() && mProposer.yield(mReceivedMessage))))
+			{//during the lease of this leader the acceptors refuse to promise the other proposers
 				setProposerStandbyTimeOut();//there is still a proposer pinging the quorum
 				mProposer.synchronize(mReceivedMessage.mDecisionId, mReceivedMessage.mProposal);
 			}
 			break;
 		case ACCEPT_REQUEST:
-			if (hasAcceptor) send(mAcceptor.replyAccept(mReceivedMessage));
+			if (mValueReferences && mReceivedMessage.mSenderId != mProposerId)
+			{//the replies and the consensus notification only carry the digest
+				mValueCache.put(ValueDigest::get(mReceivedMessage), mReceivedMessage.mValue);
+			}
+			if (hasAcceptor) sendDurable(mAcceptor.replyAccept(mReceivedMessage));
+			if (hasProposer && (mProposer.isStandby() || mProposer.yield(mReceivedMessage)))
+			{
+				setProposerStandbyTimeOut();//multi-paxos leader skips prepares: accept requests are its heartbeat
+				mProposer.follow(mReceivedMessage);
+			}
 			break;
 		case PROMISE_REPLY:
+		case PROMISED_VALUE:
 			if (hasProposer)
 			{
-				send(mProposer.replyPromise(mReceivedMessage));
+				if (mAdaptiveTimeout && mReceivedMessage.mMsgId == PROMISE_REPLY && mPrepareSentUs != 0 && mReceivedMessage.mProposal == mPrepareProposal)
+				{
+					mRtt.samplePromise(mProposer.getQuorum().indexOf(mReceivedMessage), mPrepareProposal, mClock->getMicroseconds() - mPrepareSentUs);
+				}
+				if (mReceivedMessage.mMsgId == PROMISE_REPLY) send(mProposer.replyPromise(mReceivedMessage));
+				else send(mProposer.replyPromisedValue(mReceivedMessage));
 				if(mProposer.hasReachedQuorumMajority())
 				{
+					if (mPrepareTimed)
+					{
+						mMetrics.record(METRIC_PREPARE_TO_PROMISE, mClock->getMicroseconds() - mPrepareSentUs);
+						mPrepareTimed = false;
+					}
 					setProposerPhaseTimeOut();
 				}
 			}
@@ -311,14 +1029,59 @@ template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::handleReceive
 		case ACCEPTED_VALUE:
 			if (hasProposer)
 			{
+				size_t sentSlot = mReceivedMessage.mDecisionId % mAcceptSentIds.size();
+				if (mAdaptiveTimeout && mAcceptSentIds[sentSlot] == mReceivedMessage.mDecisionId && !mAcceptResent[sentSlot])
+				{
+					mRtt.sampleAccepted(mProposer.getQuorum().indexOf(mReceivedMessage), mReceivedMessage.mDecisionId, mClock->getMicroseconds() - mAcceptSentUs[sentSlot]);
+				}
 				send(mProposer.replyAccepted(mReceivedMessage));
+				if (mReceivedMessage.mDecisionId > mProposer.getDecisionId() && mReceivedMessage.mDecisionId < mProposer.getNextDecisionId()
+						&& mAcceptSentIds[sentSlot] == mReceivedMessage.mDecisionId && mProposer.isLearned(mReceivedMessage.mDecisionId))
+				{//a later decision of the window is learned before the older ones in flight
+					mAcceptResendUs = 2 * (mClock->getMicroseconds() - mAcceptSentUs[sentSlot]);
+					resendOverdueAccepts(mAcceptResendUs);
+				}
 				if(mProposer.hasLearnQuorum())
 				{
-					mListener->onConsensus(mReceivedMessage.mDecisionId, mReceivedMessage.mValue);
-					mProposer.doEndOfCycle();
+					uint64_t nowUs = mClock->getMicroseconds();
+					do
+					{//with a pipeline the next decisions may already be learned
+						uint32_t decisionId = mProposer.getDecisionId();
+						size_t slot = decisionId % mAcceptSentIds.size();
+						bool timed = mAcceptSentIds[slot] == decisionId;
+						if (timed)
+						{
+							mMetrics.record(METRIC_ACCEPT_TO_LEARN, nowUs - mAcceptSentUs[slot]);
+							mAcceptSentIds[slot] = NO_DECISION;
+						}
+						const PaxosMessage& notification = mProposer.getConsensusNotification();
+						send(notification);
+						if (timed && mLeaseUs != 0 && notification.mMsgId == CONSENSUS_NOTIFICATION)
+						{//the acceptors of the learn quorum granted the lease once they received the request
+							mLeaseExpiryUs = std::max(mLeaseExpiryUs, mAcceptSentUs[slot] + mLeaseUs);
+							mLeaseDecisionId = decisionId + 1;
+						}
+						deliver(decisionId, mProposer.getDecidedValue());
+						mProposer.doEndOfCycle();
+						const vector<uint64_t>& proposedUs = mProposer.getDecidedCommandTimes();
+						for (size_t i = 0; i < proposedUs.size(); i++)
+						{
+							mMetrics.record(METRIC_PROPOSE_TO_CONSENSUS, nowUs - proposedUs[i]);
+						}
+						mMetrics.increment(METRIC_DECIDED_COMMANDS, proposedUs.size());
+					}
+					while (mProposer.hasLearnQuorum());
 					if (mProposer.isLeader())
 					{
-						setProposerHeartbeatTimeOut();
+						if (mProposer.hasInFlightDecisions())
+						{
+							setProposerPhaseTimeOut();
+						}
+						else
+						{
+							setProposerHeartbeatTimeOut();
+						}
+						proposeBatch(false);
 					} else {
 						setProposerStandbyTimeOut();
 					}
@@ -326,29 +1089,38 @@ template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::handleReceive
 			}
 			break;
 		case CONSENSUS_NOTIFICATION:
-			if (!hasProposer)
+			if (hasProposer && mProposer.isCandidate())
 			{
-				mListener->onConsensus(mReceivedMessage.mDecisionId, mReceivedMessage.mValue);
+				mProposer.standby();//lost election
+				setProposerStandbyTimeOut();
+			}
+			if (mValueReferences && mReceivedMessage.mValue.empty())
+			{
+				deliverReference(mReceivedMessage.mDecisionId, mReceivedMessage.mDigest);
 			}
 			else
 			{
-				if (mProposer.isCandidate())
-				{
-					mProposer.standby();//lost election
-					setProposerStandbyTimeOut();
-				}
+				deliver(mReceivedMessage.mDecisionId, mReceivedMessage.mValue);//a proposer may have missed some accepted values
 			}
-			if (hasLearner)  mLearner.onConsensus(mReceivedMessage);
+			break;
+		case CATCHUP_REQUEST:
+			replyCatchUp(mReceivedMessage);
+			break;
+		case CATCHUP_CHUNK:
+			onCatchUpChunk(mReceivedMessage);
+			break;
+		case CATCHUP_SNAPSHOT:
+			onCatchUpSnapshot(mReceivedMessage);
 			break;
 		case REJECT_REPLY:
 			if (hasProposer)
 			{
-				if (mReceivedMessage.mValue != mProposer.getId() )//to allow e.g. a primary configured re-start after with leader already running
+				mMetrics.increment(METRIC_REJECTS);
+				if (ValueBatch::leaderOf(mReceivedMessage.mValue) != mProposer.getId() )//to allow e.g. a primary configured re-start after with leader already running
 				{
 					mProposer.standby();
 					setProposerStandbyTimeOut();
-					uint32_t decisionId = mReceivedMessage.mDecisionId + 1;
-					mProposer.synchronize(decisionId,mReceivedMessage.mProposal);
+					mProposer.synchronize(mReceivedMessage.mDecisionId, mReceivedMessage.mProposal);//the slots of the acceptor window may still be undecided
 				}
 				else
 				{
@@ -357,84 +1129,235 @@ template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::handleReceive
 			}
 			break;
 		default:
-			//paxos requests are ignored. Log an error for other types //	LOG_ERROR ( mId << " received UNKNOWN message Id " );
+			//paxos requests are ignored
 			break;
 	}
-	postReceive();
 }
 
-template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onProposerPhaseTimeout(const boost::system::error_code& before_timeout)
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onProposerPhaseTimeout()
  {
-	 if (!before_timeout)//<=> realtimeout
+	 if (mProposer.getPendingAcceptorMessageType() != NULL_MESSAGE)
 	 {
-		 switch (mProposer.getPendingAcceptorMessageType())
-		 {
-			 case PROMISE_REPLY:
-				send(mProposer.candidate());//resend increasing proposalID
-				setProposerPhaseTimeOut();//for next accept
-				 break;
-			 case ACCEPTED_VALUE:
-				setProposerPhaseTimeOut();//election is lost restart cycle
-				mProposer.doEndOfCycle();
-				 break;
-			 case NULL_MESSAGE:
-			//	 cout << "PHASE TIMEOUT WITH NO MESSAGE REPLY EXPECTED" << endl;
-				 break;
-			 default:
-				 break;
-		 }
+		 mMetrics.increment(METRIC_PHASE_TIMEOUTS);
+		 mRtt.backOff();
 	 }
-	 else if (before_timeout != boost::asio::error::operation_aborted)
+	 switch (mProposer.getPendingAcceptorMessageType())
 	 {
-		 std::cerr << " Unexpected error "  << before_timeout.message() << std::endl;
+		 case PROMISE_REPLY:
+			send(mProposer.candidate());//resend increasing proposalID
+			setProposerPhaseTimeOut();//for next accept
+			 break;
+		 case ACCEPTED_VALUE:
+			if (mProposer.startResend())
+			{//the requests or their replies may be lost
+				for (uint32_t decisionId = mProposer.getDecisionId(); decisionId != mProposer.getNextDecisionId(); decisionId++)
+				{
+					send(mProposer.getResentAcceptRequest(decisionId));
+				}
+				setProposerPhaseTimeOut();
+				break;
+			}
+			if (mProposer.hasPromise())
+			{//multi-paxos: the quorum may have promised another ballot, re-run phase 1
+				send(mProposer.candidate());
+				setProposerPhaseTimeOut();
+				break;
+			}
+			setProposerPhaseTimeOut();//election is lost restart cycle
+			mProposer.doEndOfCycle();
+			 break;
+		 default:
+			 break;
 	 }
  }
 
-template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onProposerHeartbeatTimeout(const boost::system::error_code& before_timeout)
+/**
+ * The accept requests or replies of the decisions in flight below a learned one are likely lost. Those
+ * still not learned overdueUs after they were last sent are sent again, instead of stalling the window
+ * until the phase timeout. The others are checked again after mAcceptResendUs, doubled at each expiry.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::resendOverdueAccepts(uint64_t overdueUs)
 {
-	 if (!before_timeout)//<=> realtimeout
-	 {
+	uint32_t learnedId = mProposer.getNextDecisionId();
+	while (learnedId != mProposer.getDecisionId() && !mProposer.isLearned(learnedId - 1)) learnedId--;
+	uint64_t nowUs = mClock->getMicroseconds();
+	bool overdue = false;
+	for (uint32_t decisionId = mProposer.getDecisionId(); decisionId + 1 < learnedId; decisionId++)
+	{
+		size_t slot = decisionId % mAcceptSentIds.size();
+		if (mAcceptSentIds[slot] == decisionId && !mProposer.isLearned(decisionId))
 		{
-			send(mProposer.getPrepareRequest());
-			setProposerPhaseTimeOut();//next request
+			if (nowUs - mAcceptLastSentUs[slot] > overdueUs)
+			{
+				mMetrics.increment(METRIC_RESENT_ACCEPTS);
+				send(mProposer.getResentAcceptRequest(decisionId));
+			}
+			overdue = true;
 		}
-	 }
-	 else if (before_timeout != boost::asio::error::operation_aborted)
-	 {
-		 std::cerr << " Heartbeat sleep interrupted with unexpected error "  << before_timeout.message() << std::endl;
-	 }
+	}
+	if (overdue && !mAcceptResendTimeout.isArmed())
+	{
+		mTimers.arm(mAcceptResendTimeout, (mAcceptResendUs + 999) / 1000);
+	}
 }
 
-template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onProposerStandbyTimeout(const boost::system::error_code& before_timeout)
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onAcceptResendTimeout()
 {
-	 if (!before_timeout)//<=> realtimeout
-	 {
-		{
-			send(mProposer.candidate());
-			setProposerPhaseTimeOut();//next request
+	if (mProposer.isLeader() && mProposer.hasPromise())
+	{
+		uint64_t overdueUs = mAcceptResendUs;
+		mAcceptResendUs *= 2;
+		resendOverdueAccepts(overdueUs);
+	}
+}
+
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onProposerHeartbeatTimeout()
+{
+	send(mProposer.getNextRequest());
+	setProposerPhaseTimeOut();//next request
+}
+
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onProposerStandbyTimeout()
+{
+	if (mFailureDetector.isEnabled())
+	{
+		uint64_t nowUs = mClock->getMicroseconds();
+		uint64_t remainingUs = mFailureDetector.getRemainingUs(nowUs);
+		if (remainingUs > 0)
+		{//the timeout is rounded to the millisecond
+			mTimers.arm(mStandbyTimeout, (remainingUs + 999) / 1000);
+			return;
 		}
-	 }
-	 else if (before_timeout != boost::asio::error::operation_aborted)
-	 {//check state aborted or chancel and then general case
-		 std::cerr << " Heartbeat sleep interrupted with unexpected error "  << before_timeout.message() << std::endl;
-	 }
+		PAXOS_INFO("Leader is suspected at phi={} => standby takes over.") << mFailureDetector.getPhi(nowUs);
+		mFailureDetector.reset();//the intervals of the next leader start over
+	}
+	else
+	{
+		long silenceMs = getTimestamp() - mLastMessageMs;
+		if (silenceMs < mHeartbeatMs*STANBY_HEARTBEAT_COUNT)
+		{//the other proposers and the acceptors were heard since the leader last was
+			mTimers.arm(mStandbyTimeout, mHeartbeatMs*STANBY_HEARTBEAT_COUNT - silenceMs);
+			return;
+		}
+	}
+	send(mProposer.candidate());
+	setProposerPhaseTimeOut();//next request
 }
 
 
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::onBatchLingerTimeout()
+{
+	proposeBatch(true);
+}
+
 template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::send(const PaxosMessage& message)
 {
 	if (message.mMsgId != NULL_MESSAGE)
 	{
-		//cout << "OUTBOUND[" << message.mSenderId << "] = " << message << std::endl;
-		send(message.mDecisionId,message.mMsgId,message.mSenderId, message.mProposal, message.mValue);
+		if (message.mMsgId == PREPARE_REQUEST && message.mSenderId == mProposerId)
+		{
+			mPrepareTimed = true;
+			mPrepareSentUs = mClock->getMicroseconds();
+			mPrepareProposal = message.mProposal;
+			if (!mProposer.isLeader()) mLeaseExpiryUs = 0;//a candidate starts without lease
+		}
+		else if (message.mMsgId == ACCEPT_REQUEST && message.mSenderId == mProposerId)
+		{//resent requests keep the time of the first one
+			size_t slot = message.mDecisionId % mAcceptSentIds.size();
+			if (mAcceptSentIds[slot] != message.mDecisionId)
+			{
+				mAcceptSentIds[slot] = message.mDecisionId;
+				mAcceptSentUs[slot] = mClock->getMicroseconds();
+				mAcceptResent[slot] = false;
+			}
+			else
+			{
+				mAcceptResent[slot] = true;
+			}
+			mAcceptLastSentUs[slot] = mClock->getMicroseconds();
+		}
+		send(message.mDecisionId,message.mMsgId,message.mSenderId, message.mProposal, message.mValue, message.mSenderIndex, message.mDigest);
+	}
+}
+
+/**
+ * Acceptor replies are held back until the write-ahead log holding their promise/accept is synced.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::sendDurable(const PaxosMessage& message)
+{
+	if (!mAcceptor.isLogEnabled())
+	{
+		send(message);
+		return;
+	}
+	if (message.mMsgId != NULL_MESSAGE)
+	{
+		size_t offset = mDurableReplies.size();
+		size_t capacity = MessageCodec::getCapacity(message.mSenderId, message.mValue);
+		mDurableReplies.resize(offset + capacity);
+		size_t len = mCodec.encode(&mDurableReplies[offset], capacity, message.mDecisionId, message.mMsgId, message.mSenderId, message.mProposal, message.mValue, message.mSenderIndex, message.mDigest);
+		mDurableReplies.resize(offset + len);
+		if (len == 0)
+		{
+			PAXOS_WARN("Message#{} can not be encoded => message is dropped.") << message.mDecisionId;
+			mMetrics.increment(METRIC_DROPPED_MESSAGES);
+			return;
+		}
+		mDurableReplySizes.push_back(len);
+		mDurableReplyIds.push_back(message.mMsgId);
+	}
+}
+
+/**
+ * Group commit: one log sync for all the acceptor replies of a receive batch. The write back of
+ * the values the learner stored is scheduled without waiting for it.
+ */
+template<class PaxosListenerType> void PaxosLH<PaxosListenerType>::flushDurableReplies()
+{
+	if (hasLearner)
+	{
+		mLearner.sync(mLearner.getSyncMs() == 0);//else only scheduled, see onLearnerSyncTimeout
+	}
+	if (!hasAcceptor || !mAcceptor.isLogEnabled())
+	{
+		return;
 	}
+	if (mAcceptor.commitLog())
+	{
+		size_t offset = 0;
+		for (size_t i = 0; i < mDurableReplySizes.size(); i++)
+		{
+			if (sendEncoded(mDurableReplyIds[i], &mDurableReplies[offset], mDurableReplySizes[i])) mMetrics.countSent(mDurableReplyIds[i]);
+			else mMetrics.increment(METRIC_DROPPED_MESSAGES);
+			offset += mDurableReplySizes[i];
+		}
+	}
+	else
+	{
+		PAXOS_ERROR("Acceptor log commit failed => {} replies are dropped.") << mDurableReplySizes.size();
+		mMetrics.increment(METRIC_DROPPED_MESSAGES, mDurableReplySizes.size());
+	}
+	mDurableReplies.clear();
+	mDurableReplySizes.clear();
+	mDurableReplyIds.clear();
+}
+
+template<class PaxosListenerType> inline bool PaxosLH<PaxosListenerType>::isLeaseRunning()
+{
+	return mProposer.isLeader() && mClock->getMicroseconds() < mLeaseExpiryUs;
+}
+
+/**
+ * phase_timeout_ms, or derived from the acceptor round-trip times (see RttEstimator).
+ */
+template<class PaxosListenerType> inline long PaxosLH<PaxosListenerType>::getPhaseTimeoutMs()
+{
+	return mAdaptiveTimeout ? (long) ((mRtt.getTimeoutUs() + 999) / 1000) : mPhaseTimeoutMs;
 }
 
 template<class PaxosListenerType> inline long PaxosLH<PaxosListenerType>::getTimestamp()
 {
-	struct timeval tp;
-	gettimeofday(&tp, NULL);
-	return tp.tv_sec * 1000 + tp.tv_usec / 1000;
+	return mClock->getTimestamp();
 }
 
 }/* namespace paxos */
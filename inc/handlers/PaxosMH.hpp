@@ -9,7 +9,11 @@
 #define PAXOSMH_H_
 
 #include <boost/shared_ptr.hpp>
+#include <boost/foreach.hpp>
 #include "configuration/Configurator.h"
+#include "protocole/quorum.hpp"
+#include "metrics/PaxosMetrics.hpp"
+#include "logging/Logger.hpp"
 
 using namespace std;
 using namespace boost;
@@ -25,7 +29,7 @@ template<class PaxosListenerType> class PaxosMH
 	typedef boost::shared_ptr<PaxosListenerType> paxos_listener_ptr_t;
 
 public:
-	PaxosMH() : mDecisionId(0), mTrace(false) {};
+	PaxosMH() : mDecisionId(0), mIndex(NO_NODE_INDEX), mTrace(false), mMultiPaxos(false), mPipelineWindow(1), mValueReferences(false), mMetrics(NULL) {};
 	virtual ~PaxosMH(){};
 
 	virtual string getXmlConfigurationTag() = 0;
@@ -33,31 +37,52 @@ public:
 	virtual void init(paxos_listener_ptr_t listener);
 	virtual void configure(const property_tree::ptree& configuration);
 	string getId() const;
+	uint32_t getDecisionId() const {return mDecisionId;}
+	const Quorum& getQuorum() const {return mQuorum;}
+	uint32_t getPipelineWindow() const {return mPipelineWindow;}
 	void logInbound(const PaxosMessage& message);
+	void setMetrics(PaxosMetrics* metrics) {mMetrics = metrics;}
 
 
 protected:
 	string					mId;
 	uint32_t				mDecisionId;
+	Quorum					mQuorum;
+	uint16_t				mIndex;//quorum index of mId, carried by the replies
 	paxos_listener_ptr_t 	mListener;
 	bool					mTrace;
+	bool					mMultiPaxos;//promised ballot spans all future decision ids
+	uint32_t				mPipelineWindow;//decisions [mDecisionId, mDecisionId + mPipelineWindow) may be in flight
+	bool					mValueReferences;//accepted values and consensus notifications carry the value digest only
+	PaxosMetrics*			mMetrics;//of the line handler, NULL if not set
 
 
 	virtual void reset(uint32_t peerId ) = 0;
 
-	bool isSenderBehind(const PaxosMessage& message, uint32_t proposalId)
+	void count(MetricCounter counter, uint64_t count = 1)
+	{
+		if (mMetrics != NULL) mMetrics->increment(counter, count);
+	}
+
+	/**
+	 * Moves the pipeline window up to the sender's decision if it is ahead, then drops the message
+	 * if it is behind: an older decision or a ballot lower than proposalId. proposalId is read after
+	 * the reset, so a promise kept across the window move (multi-paxos) still applies.
+	 */
+	bool isSenderBehind(const PaxosMessage& message, const uint32_t& proposalId)
 	{
 		if (message.mDecisionId < mDecisionId)
 		{
 			return true;
 		}
-		if ( message.mDecisionId > mDecisionId )
+		if ( message.mDecisionId >= mDecisionId + mPipelineWindow )
 		{
-			reset (message.mDecisionId);
+			reset (message.mDecisionId + 1 - mPipelineWindow);//the sender's decision is the last one of the window, the skipped decided values are caught up before delivery (see PaxosLH::deliver)
 		}
-		else if (message.mProposal < proposalId)
+		if (message.mProposal < proposalId)
 		{
-			cerr << "\tProposalId is behind: Expected >= " << proposalId << " => message is dropped." << endl;
+			PAXOS_WARN("ProposalId is behind: Expected >= {} => message is dropped.") << proposalId;
+			count(METRIC_DROPPED_MESSAGES);
 			return true;
 		}
 		return false;
@@ -77,7 +102,32 @@ template<class PaxosListenerType> void PaxosMH<PaxosListenerType>::configure(con
    		try
    		{
    			mId = configuration.get<std::string>(getXmlConfigurationTag());
-   			cout << "\t" << mId << " is configured" << endl;
+   			set<string> acceptorIds;
+   			boost::optional<const property_tree::ptree&> quorum = configuration.get_child_optional(XML_QUORUM);
+   			if (quorum)
+   			{
+   				BOOST_FOREACH(property_tree::ptree::value_type const& v, *quorum)
+   				{
+   					string value = v.second.get("<xmlattr>.id", "");
+   					if (value.size() > 0) acceptorIds.insert(value);
+   				}
+   			}
+   			mQuorum.assign(acceptorIds);
+   			mIndex = mQuorum.indexOf(mId);
+   			mMultiPaxos = configuration.get<bool>(XML_MULTI_PAXOS, false);
+   			mPipelineWindow = configuration.get<uint32_t>(XML_PIPELINE_WINDOW, 1);
+   			mValueReferences = configuration.get<bool>(XML_VALUE_REFERENCES, false);
+   			if (mPipelineWindow == 0)
+   			{
+   				PAXOS_WARN("{} is 0 => window is set to 1.") << XML_PIPELINE_WINDOW;
+   				mPipelineWindow = 1;
+   			}
+   			else if (!mMultiPaxos && mPipelineWindow > 1)
+   			{
+   				PAXOS_WARN("{} > 1 requires {} => window is set to 1.") << XML_PIPELINE_WINDOW << XML_MULTI_PAXOS;
+   				mPipelineWindow = 1;
+   			}
+   			cout << "\t" << mId << " is configured" << (mMultiPaxos ? " (multi-paxos)" : "") << endl;
    		}
    		catch (std::exception& e)
    		{
@@ -93,7 +143,7 @@ template<class PaxosListenerType> inline string  PaxosMH<PaxosListenerType>::get
 
 template<class PaxosListenerType> inline void PaxosMH<PaxosListenerType>::logInbound(const PaxosMessage& message)
 	{
-	 if (mTrace)	std::cout << "INBOUND [" << mId << "] = " <<  message << std::endl;
+	 if (mTrace) PAXOS_DEBUG("INBOUND [{}] = {},{},{},{},{}") << mId << message.mDecisionId << (uint32_t) message.mMsgId << message.mSenderId << message.mProposal << message.mValue;
 	}
 }
 
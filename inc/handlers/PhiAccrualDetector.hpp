@@ -0,0 +1,166 @@
+/*
+ * PhiAccrualDetector.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef PHIACCRUALDETECTOR_H_
+#define PHIACCRUALDETECTOR_H_
+
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+namespace paxos
+{
+
+	/**
+	 * Phi-accrual failure detector of the leader, fed by the arrival times of its requests, one per round.
+	 *
+	 * A live leader sends a request at least every heartbeat period (heartbeat accept requests when it
+	 * is idle), so each arrival is late by its interval beyond the heartbeat period, 0 for the requests
+	 * of a busy leader. The lateness of the arrivals, idle heartbeats included, is kept over a sliding
+	 * window. phi is the suspicion level -log10(P(lateness > silence - heartbeat)), the lateness taken
+	 * as normally distributed (logistic approximation of the CDF) with its sampled mean, increased by
+	 * acceptable_pause, and standard deviation, at least min_std_deviation. phi only grows with the
+	 * silence: the leader is suspected once it exceeds the threshold, i.e. after a silence of
+	 * getSuspicionUs(). max_silence is a backstop: the silence is at most that, which also applies until
+	 * two arrivals are seen.
+	 */
+	class PhiAccrualDetector
+	{
+	public:
+		PhiAccrualDetector() : mThreshold(0), mThresholdDeviations(0), mMinDeviationUs(0), mPauseUs(0), mHeartbeatUs(0), mMaxSilenceUs(0),
+				mNext(0), mCount(0), mSum(0), mSumSquares(0), mLastUs(0), mHeard(false) {}
+
+		void configure(double threshold, size_t window, uint64_t minDeviationUs, uint64_t pauseUs, uint64_t heartbeatUs, uint64_t maxSilenceUs)
+		{
+			mThreshold = threshold;
+			mLateness.assign(std::max<size_t>(window, 1), 0);
+			mMinDeviationUs = std::max<uint64_t>(minDeviationUs, 1);
+			mPauseUs = pauseUs;
+			mHeartbeatUs = heartbeatUs;
+			mMaxSilenceUs = maxSilenceUs;
+			double low = -40, high = 40;
+			for (int i = 0; i < 100; i++)
+			{//phi grows with the deviations: the number of them reaching the threshold
+				double middle = (low + high) / 2;
+				if (phiOf(middle) < threshold) low = middle;
+				else high = middle;
+			}
+			mThresholdDeviations = high;
+			reset();
+		}
+
+		bool isEnabled() const { return mThreshold > 0; }
+
+		/**
+		 * Forgets the samples, e.g. once another leader is expected.
+		 */
+		void reset()
+		{
+			mNext = 0;
+			mCount = 0;
+			mSum = 0;
+			mSumSquares = 0;
+			mHeard = false;
+		}
+
+		void heartbeat(uint64_t nowUs)
+		{
+			if (mHeard && nowUs >= mLastUs)
+			{
+				double lateness = std::max((double) (nowUs - mLastUs) - mHeartbeatUs, 0.0);
+				if (mCount == mLateness.size())
+				{
+					mSum -= mLateness[mNext];
+					mSumSquares -= mLateness[mNext] * mLateness[mNext];
+				}
+				else
+				{
+					mCount++;
+				}
+				mLateness[mNext] = lateness;
+				mSum += lateness;
+				mSumSquares += lateness * lateness;
+				mNext = (mNext + 1) % mLateness.size();
+			}
+			mHeard = true;
+			mLastUs = nowUs;
+		}
+
+		/**
+		 * Silence after the last arrival from which the leader is suspected.
+		 */
+		uint64_t getSuspicionUs() const
+		{
+			if (mCount == 0)
+			{
+				return mMaxSilenceUs;
+			}
+			double suspicionUs = mHeartbeatUs + getMeanUs() + mThresholdDeviations * getDeviationUs();
+			if (suspicionUs >= (double) mMaxSilenceUs) return mMaxSilenceUs;//backstop: the rule without detector
+			return suspicionUs > 0 ? (uint64_t) suspicionUs : 0;
+		}
+
+		/**
+		 * Microseconds from nowUs until the leader is suspected, 0 if it already is.
+		 */
+		uint64_t getRemainingUs(uint64_t nowUs) const
+		{
+			uint64_t silenceUs = mHeard && nowUs > mLastUs ? nowUs - mLastUs : 0;
+			uint64_t suspicionUs = getSuspicionUs();
+			return suspicionUs > silenceUs ? suspicionUs - silenceUs : 0;
+		}
+
+		double getPhi(uint64_t nowUs) const
+		{
+			if (mCount == 0 || !mHeard || nowUs <= mLastUs)
+			{
+				return 0;
+			}
+			return phiOf(((double) (nowUs - mLastUs) - mHeartbeatUs - getMeanUs()) / getDeviationUs());
+		}
+
+	private:
+		double					mThreshold;// 0 if disabled
+		double					mThresholdDeviations;// of the lateness above the mean at the threshold
+		double					mMinDeviationUs;
+		double					mPauseUs;
+		double					mHeartbeatUs;
+		uint64_t				mMaxSilenceUs;
+		std::vector<double>		mLateness;// ring of the lateness of the last window arrivals
+		size_t					mNext;
+		size_t					mCount;
+		double					mSum;
+		double					mSumSquares;
+		uint64_t				mLastUs;
+		bool					mHeard;
+
+		double getMeanUs() const
+		{
+			return mSum / mCount + mPauseUs;
+		}
+
+		double getDeviationUs() const
+		{
+			double mean = mSum / mCount;
+			double variance = mSumSquares / mCount - mean * mean;
+			return std::max(variance > 0 ? sqrt(variance) : 0, mMinDeviationUs);
+		}
+
+		/**
+		 * phi of a silence of y standard deviations above the mean.
+		 */
+		static double phiOf(double y)
+		{
+			double e = exp(-y * (1.5976 + 0.070566 * y * y));
+			return y > 0 ? -log10(e / (1 + e)) : -log10(1 - 1 / (1 + e));
+		}
+	};
+
+}
+
+#endif /* PHIACCRUALDETECTOR_H_ */
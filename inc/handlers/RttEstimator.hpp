@@ -0,0 +1,141 @@
+/*
+ * RttEstimator.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef RTTESTIMATOR_H_
+#define RTTESTIMATOR_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+namespace paxos
+{
+
+	/**
+	 * Phase timeout of the proposer from the round-trip times of its acceptors.
+	 *
+	 * Each acceptor keeps a smoothed RTT and mean deviation (RFC 6298), sampled by the first reply
+	 * to each prepare (prepare -> promise) and accept request (accept -> accepted). Resent requests
+	 * are not sampled, their replies are ambiguous. A phase needs a majority of replies: the timeout
+	 * is the majority-th smallest srtt + 4 * rttvar, doubled by each phase timeout in a row and
+	 * bounded by [min, max]. The configured timeout stands until a majority of acceptors is sampled.
+	 */
+	class RttEstimator
+	{
+	public:
+		RttEstimator() : mMajority(1), mInitialUs(0), mMinUs(0), mMaxUs(0), mBackoff(0) {}
+
+		void configure(size_t acceptors, uint32_t majority, uint64_t initialUs, uint64_t minUs, uint64_t maxUs)
+		{
+			mAcceptors.assign(acceptors, Acceptor());
+			mTimeouts.reserve(acceptors);
+			mMajority = std::max<uint32_t>(majority, 1);
+			mInitialUs = initialUs;
+			mMinUs = minUs;
+			mMaxUs = maxUs;
+			mBackoff = 0;
+		}
+
+		/**
+		 * Promise of acceptor index to the prepare request of proposal, rttUs after it was sent.
+		 */
+		void samplePromise(uint16_t index, uint32_t proposal, uint64_t rttUs)
+		{
+			if (index < mAcceptors.size() && (!mAcceptors[index].mPromised || mAcceptors[index].mLastProposal != proposal))
+			{
+				mAcceptors[index].mPromised = true;
+				mAcceptors[index].mLastProposal = proposal;
+				sample(mAcceptors[index], rttUs);
+			}
+		}
+
+		/**
+		 * Accepted value of acceptor index for decisionId, rttUs after its accept request was sent.
+		 */
+		void sampleAccepted(uint16_t index, uint32_t decisionId, uint64_t rttUs)
+		{
+			if (index < mAcceptors.size() && (!mAcceptors[index].mAccepted || (int32_t) (decisionId - mAcceptors[index].mLastDecisionId) > 0))
+			{
+				mAcceptors[index].mAccepted = true;
+				mAcceptors[index].mLastDecisionId = decisionId;
+				sample(mAcceptors[index], rttUs);
+			}
+		}
+
+		/**
+		 * A phase timed out: the next timeouts are doubled until the next sample.
+		 */
+		void backOff()
+		{
+			if (mBackoff < MAX_BACKOFF) mBackoff++;
+		}
+
+		uint64_t getTimeoutUs()
+		{
+			mTimeouts.clear();
+			for (size_t i = 0; i < mAcceptors.size(); i++)
+			{
+				if (mAcceptors[i].mSamples != 0)
+				{
+					mTimeouts.push_back(mAcceptors[i].mSmoothedUs + std::max<uint64_t>(GRANULARITY_US, 4 * mAcceptors[i].mDeviationUs));
+				}
+			}
+			uint64_t timeoutUs = mInitialUs;
+			if (mTimeouts.size() >= mMajority)
+			{
+				std::nth_element(mTimeouts.begin(), mTimeouts.begin() + (mMajority - 1), mTimeouts.end());
+				timeoutUs = mTimeouts[mMajority - 1];
+			}
+			timeoutUs <<= mBackoff;
+			return std::min(std::max(timeoutUs, mMinUs), mMaxUs);
+		}
+
+	private:
+		static constexpr uint64_t	GRANULARITY_US = 1000;// of the timer wheel
+		static const int			MAX_BACKOFF = 16;
+
+		struct Acceptor
+		{
+			uint64_t	mSmoothedUs;
+			uint64_t	mDeviationUs;
+			uint32_t	mSamples;
+			bool		mPromised;
+			uint32_t	mLastProposal;// of the last sampled promise
+			bool		mAccepted;
+			uint32_t	mLastDecisionId;// of the last sampled accepted value
+
+			Acceptor() : mSmoothedUs(0), mDeviationUs(0), mSamples(0), mPromised(false), mLastProposal(0), mAccepted(false), mLastDecisionId(0) {}
+		};
+
+		std::vector<Acceptor>	mAcceptors;// by quorum index
+		std::vector<uint64_t>	mTimeouts;
+		uint32_t				mMajority;
+		uint64_t				mInitialUs;
+		uint64_t				mMinUs;
+		uint64_t				mMaxUs;
+		int						mBackoff;
+
+		void sample(Acceptor& acceptor, uint64_t rttUs)
+		{
+			if (acceptor.mSamples++ == 0)
+			{
+				acceptor.mSmoothedUs = rttUs;
+				acceptor.mDeviationUs = rttUs / 2;
+			}
+			else
+			{//rttvar = 3/4 rttvar + 1/4 |srtt - r|, srtt = 7/8 srtt + 1/8 r
+				uint64_t error = rttUs > acceptor.mSmoothedUs ? rttUs - acceptor.mSmoothedUs : acceptor.mSmoothedUs - rttUs;
+				acceptor.mDeviationUs = (3 * acceptor.mDeviationUs + error) / 4;
+				acceptor.mSmoothedUs = (7 * acceptor.mSmoothedUs + rttUs) / 8;
+			}
+			mBackoff = 0;
+		}
+	};
+
+}
+
+#endif /* RTTESTIMATOR_H_ */
@@ -0,0 +1,82 @@
+/*
+ * SubmissionQueue.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef SUBMISSIONQUEUE_H_
+#define SUBMISSIONQUEUE_H_
+
+#include <stdint.h>
+#include <string>
+#include "concurrent/MpscRing.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Commands submitted by the application threads to the io thread of a line handler, in a
+	 * lock-free ring (see MpscRing). The strings are swapped in and out of the cells, never copied.
+	 */
+	class SubmissionQueue
+	{
+	public:
+		/**
+		 * Allocates capacity cells, rounded up to a power of 2. Not thread-safe.
+		 */
+		void configure(size_t capacity)
+		{
+			mRing.configure(capacity);
+		}
+
+		size_t getCapacity() const { return mRing.getCapacity(); }
+
+		/**
+		 * Any thread: takes the content of command, which is left empty. If the queue is full,
+		 * returns false, or with wait yields until the io thread makes room.
+		 */
+		bool push(std::string& command, uint64_t submittedUs, bool wait)
+		{
+			size_t position;
+			Submission* submission = mRing.claim(position, wait);
+			if (submission == NULL)
+			{
+				return false;
+			}
+			submission->mCommand.swap(command);
+			command.clear();
+			submission->mSubmittedUs = submittedUs;
+			mRing.publish(position);
+			return true;
+		}
+
+		/**
+		 * io thread only: swaps the oldest command into command. Returns false if there is none.
+		 */
+		bool pop(std::string& command, uint64_t& submittedUs)
+		{
+			Submission* submission = mRing.peek();
+			if (submission == NULL)
+			{
+				return false;
+			}
+			command.swap(submission->mCommand);
+			submittedUs = submission->mSubmittedUs;
+			mRing.pop();
+			return true;
+		}
+
+	private:
+		struct Submission
+		{
+			std::string				mCommand;
+			uint64_t				mSubmittedUs;
+		};
+
+		MpscRing<Submission>		mRing;
+	};
+
+}
+
+#endif /* SUBMISSIONQUEUE_H_ */
@@ -0,0 +1,264 @@
+/*
+ * TimerWheel.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include <stdint.h>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include "handlers/Clock.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Timeouts of a line handler on a hierarchical timer wheel: 4 levels of 256 slots of 1 ms,
+	 * 2^8 ms, 2^16 ms and 2^24 ms, on the monotonic time of the clock (Clock::getMicroseconds).
+	 * Arming, re-arming and cancelling a timeout is O(1), so a timeout can be pushed back on every
+	 * message; the entries of a higher level are moved down once their slot comes up.
+	 *
+	 * One clock timer drives the wheel: it waits for the earliest slot holding entries and is only
+	 * set again when a timeout is armed before it. Callbacks run in the thread of the line handler.
+	 */
+	class TimerWheel : private boost::noncopyable
+	{
+	public:
+		/**
+		 * Timeout owned by the caller, it must be cancelled or expired before it is destroyed.
+		 */
+		class Entry : private boost::noncopyable
+		{
+		public:
+			typedef boost::function<void ()> callback_t;
+
+			Entry() : mPrev(NULL), mNext(NULL), mExpiryMs(0) {}
+
+			void setCallback(callback_t callback) { mCallback = callback; }
+			bool isArmed() const { return mPrev != NULL; }
+
+		private:
+			friend class TimerWheel;
+
+			Entry*			mPrev;// circular list of the slot, NULL if not armed
+			Entry*			mNext;
+			uint64_t		mExpiryMs;
+			callback_t		mCallback;
+
+			void unlink()
+			{
+				mPrev->mNext = mNext;
+				mNext->mPrev = mPrev;
+				mPrev = NULL;
+				mNext = NULL;
+			}
+
+			void linkBefore(Entry& head)
+			{
+				mPrev = head.mPrev;
+				mNext = &head;
+				head.mPrev->mNext = this;
+				head.mPrev = this;
+			}
+		};
+
+		TimerWheel() : mNowMs(0), mWakeUpMs(NEVER), mArmed(0)
+		{
+			for (int level = 0; level < LEVELS; level++)
+			{
+				for (int slot = 0; slot < SLOTS; slot++) clear(mSlots[level][slot]);
+			}
+		}
+
+		void init(clock_ptr_t clock)
+		{
+			mClock = clock;
+			mTimer = clock->createTimer();
+			mNowMs = getClockMs();
+		}
+
+		/**
+		 * Expires entry in ms milliseconds, instead of its previous expiry if it is armed.
+		 */
+		void arm(Entry& entry, long ms)
+		{
+			uint64_t nowMs = getClockMs();
+			if (mArmed == 0 && nowMs > mNowMs)
+			{//idle wheel: nothing to run up to now
+				mNowMs = nowMs;
+			}
+			if (entry.isArmed()) entry.unlink();
+			else mArmed++;
+			uint64_t expiryMs = nowMs + (ms > 0 ? ms : 0);
+			entry.mExpiryMs = expiryMs > mNowMs ? expiryMs : mNowMs + 1;
+			insert(entry);
+			if (entry.mExpiryMs < mWakeUpMs) wakeUpAt(entry.mExpiryMs);
+		}
+
+		void cancel(Entry& entry)
+		{
+			if (entry.isArmed())
+			{
+				entry.unlink();
+				mArmed--;
+			}
+		}
+
+		size_t getArmedCount() const { return mArmed; }
+
+	private:
+		static const int		LEVELS = 4;
+		static const int		BITS = 8;
+		static const int		SLOTS = 1 << BITS;
+		static const uint64_t	NEVER = ~(uint64_t) 0;
+
+		Entry				mSlots[LEVELS][SLOTS];// list heads
+		uint64_t			mNowMs;// the entries expiring up to it have run
+		uint64_t			mWakeUpMs;// of the clock timer, NEVER if it is not waiting
+		size_t				mArmed;
+		clock_ptr_t			mClock;
+		timer_ptr_t			mTimer;
+
+		static void clear(Entry& head)
+		{
+			head.mPrev = &head;
+			head.mNext = &head;
+		}
+
+		static bool isEmpty(const Entry& head)
+		{
+			return head.mNext == &head;
+		}
+
+		uint64_t getClockMs()
+		{
+			return mClock->getMicroseconds() / 1000;
+		}
+
+		/**
+		 * Links entry in the slot of the lowest level covering its expiry, mNowMs < expiry.
+		 */
+		void insert(Entry& entry)
+		{
+			uint64_t delta = entry.mExpiryMs - mNowMs;
+			int level = 0;
+			while (level < LEVELS - 1 && delta >= ((uint64_t) 1 << (BITS * (level + 1)))) level++;
+			uint64_t expiryMs = entry.mExpiryMs;
+			if (level == LEVELS - 1 && delta >= ((uint64_t) 1 << (BITS * LEVELS)))
+			{//beyond the wheel: parked in the last slot before the end, moved down from there
+				expiryMs = mNowMs + ((uint64_t) 1 << (BITS * LEVELS)) - 1;
+			}
+			entry.linkBefore(mSlots[level][(expiryMs >> (BITS * level)) & (SLOTS - 1)]);
+		}
+
+		void wakeUpAt(uint64_t ms)
+		{
+			mWakeUpMs = ms;
+			uint64_t nowMs = getClockMs();
+			mTimer->expiresFromNow(ms > nowMs ? ms - nowMs : 0);
+			mTimer->asyncWait(boost::bind(&TimerWheel::onTimer, this, _1));
+		}
+
+		void onTimer(const boost::system::error_code& error)
+		{
+			if (error)
+			{//operation_aborted: set again for an earlier entry
+				return;
+			}
+			mWakeUpMs = NEVER;
+			advance(getClockMs());
+			scheduleWakeUp();
+		}
+
+		/**
+		 * Runs the entries expiring up to nowMs, one millisecond after the other.
+		 */
+		void advance(uint64_t nowMs)
+		{
+			while (mNowMs < nowMs && mArmed > 0)
+			{
+				mNowMs++;
+				for (int level = 1; level < LEVELS && ((mNowMs >> (BITS * (level - 1))) & (SLOTS - 1)) == 0; level++)
+				{
+					cascade(mSlots[level][(mNowMs >> (BITS * level)) & (SLOTS - 1)]);
+				}
+				Entry expired;
+				clear(expired);
+				take(mSlots[0][mNowMs & (SLOTS - 1)], expired);
+				while (!isEmpty(expired))
+				{//a callback may arm or cancel any entry, this one included
+					Entry* entry = expired.mNext;
+					entry->unlink();
+					mArmed--;
+					entry->mCallback();
+				}
+			}
+			if (mNowMs < nowMs) mNowMs = nowMs;
+		}
+
+		/**
+		 * Moves the entries of a higher level slot down, to the slots of their expiry.
+		 */
+		void cascade(Entry& head)
+		{
+			Entry entries;
+			clear(entries);
+			take(head, entries);
+			while (!isEmpty(entries))
+			{
+				Entry* entry = entries.mNext;
+				entry->unlink();
+				if (entry->mExpiryMs <= mNowMs) entry->mExpiryMs = mNowMs;//runs with the current slot
+				insertDue(*entry);
+			}
+		}
+
+		void insertDue(Entry& entry)
+		{
+			if (entry.mExpiryMs == mNowMs) entry.linkBefore(mSlots[0][mNowMs & (SLOTS - 1)]);
+			else insert(entry);
+		}
+
+		/**
+		 * Moves all the entries of from to the (empty) list to.
+		 */
+		static void take(Entry& from, Entry& to)
+		{
+			if (isEmpty(from)) return;
+			to.mNext = from.mNext;
+			to.mPrev = from.mPrev;
+			to.mNext->mPrev = &to;
+			to.mPrev->mNext = &to;
+			clear(from);
+		}
+
+		/**
+		 * Sets the clock timer for the first level 0 slot holding entries, else for the next
+		 * cascade of the higher levels.
+		 */
+		void scheduleWakeUp()
+		{
+			if (mArmed == 0)
+			{
+				return;
+			}
+			for (uint64_t ms = mNowMs + 1; ms < mNowMs + SLOTS; ms++)
+			{
+				if (!isEmpty(mSlots[0][ms & (SLOTS - 1)]))
+				{
+					wakeUpAt(ms);
+					return;
+				}
+			}
+			wakeUpAt((mNowMs | (SLOTS - 1)) + 1);
+		}
+	};
+
+}
+
+#endif /* TIMERWHEEL_H_ */
@@ -0,0 +1,118 @@
+/*
+ * ValueCache.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef VALUECACHE_H_
+#define VALUECACHE_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "logging/Logger.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Payloads of the last accept requests received, by digest (see protocole/digest.hpp). With
+	 * value references the acceptor replies and the consensus notifications only carry the digest,
+	 * the proposers and learners resolve it here.
+	 *
+	 * At most max_entries values and max_bytes are kept, the oldest ones are evicted first. The
+	 * strings keep their capacity, so a full cache no longer allocates for values of a steady size.
+	 *
+	 * The digest is not collision resistant: a different value put with the digest of a cached one
+	 * makes the digest unresolved until its entry is evicted, its decisions are then caught up.
+	 */
+	class ValueCache
+	{
+	public:
+		ValueCache() : mNext(0), mBytes(0), mMaxBytes(64 << 20) { configure(1024, 64 << 20); }
+
+		void configure(size_t maxEntries, size_t maxBytes)
+		{
+			mEntries.assign(maxEntries == 0 ? 1 : maxEntries, Entry());
+			mIndex.clear();
+			mNext = 0;
+			mBytes = 0;
+			mMaxBytes = maxBytes;
+		}
+
+		/**
+		 * Keeps value unless it is already cached or larger than max_bytes.
+		 */
+		void put(uint64_t digest, const std::string& value)
+		{
+			std::map<uint64_t, size_t>::iterator it = mIndex.find(digest);
+			if (it != mIndex.end())
+			{
+				Entry& entry = mEntries[it->second];
+				if (!entry.mCollided && entry.mValue != value)
+				{
+					PAXOS_WARN("Values of digest {} collide => digest is not resolved.") << digest;
+					entry.mCollided = true;
+				}
+				return;
+			}
+			if (value.size() > mMaxBytes)
+			{
+				return;
+			}
+			evict(mNext);
+			for (size_t i = 1; i < mEntries.size() && mBytes + value.size() > mMaxBytes; i++)
+			{
+				evict((mNext + i) % mEntries.size());
+			}
+			Entry& entry = mEntries[mNext];
+			entry.mDigest = digest;
+			entry.mValue = value;
+			entry.mCollided = false;
+			mIndex[digest] = mNext;
+			mBytes += value.size();
+			mNext = (mNext + 1) % mEntries.size();
+		}
+
+		/**
+		 * Cached value of digest, NULL if none or if several values have it. It is valid until the next put().
+		 */
+		const std::string* get(uint64_t digest) const
+		{
+			std::map<uint64_t, size_t>::const_iterator it = mIndex.find(digest);
+			return it != mIndex.end() && !mEntries[it->second].mCollided ? &mEntries[it->second].mValue : NULL;
+		}
+
+	private:
+		struct Entry
+		{
+			uint64_t		mDigest;// 0 if the entry is free
+			std::string		mValue;
+			bool			mCollided;// another value with this digest was put
+
+			Entry() : mDigest(0), mCollided(false) {}
+		};
+
+		std::vector<Entry>				mEntries;// ring, the oldest entry at mNext
+		std::map<uint64_t, size_t>		mIndex;// entry by digest
+		size_t							mNext;
+		size_t							mBytes;
+		size_t							mMaxBytes;
+
+		void evict(size_t i)
+		{
+			Entry& entry = mEntries[i];
+			if (entry.mDigest != 0)
+			{
+				mIndex.erase(entry.mDigest);
+				mBytes -= entry.mValue.size();
+				entry.mDigest = 0;
+			}
+		}
+	};
+
+}
+
+#endif /* VALUECACHE_H_ */
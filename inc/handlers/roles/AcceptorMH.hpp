@@ -8,8 +8,13 @@
 #ifndef ACCEPTORMH_H_
 #define ACCEPTORMH_H_
 
+#include <vector>
 #include <boost/system/error_code.hpp>
 #include "handlers/PaxosMH.hpp"
+#include "handlers/Clock.hpp"
+#include "protocole/promise.hpp"
+#include "protocole/digest.hpp"
+#include "storage/AcceptorLog.hpp"
 
 using namespace std;
 
@@ -23,66 +28,153 @@ namespace paxos
 		typedef boost::shared_ptr<PaxosListenerType> paxos_listener_ptr_t;
 
 		public:
+			AcceptorMH() : mLeaseGrantUs(0), mLeaseExpiryUs(0) {};
 			~AcceptorMH(){};
 			PaxosMessage replyPrepare(const PaxosMessage& message);
 			PaxosMessage replyAccept(const PaxosMessage& message);
+			size_t getPromisedValueCount() {return mPromisedValueCount;}
+			const PaxosMessage& getPromisedValue(size_t i) {return mPromisedValues[i];}
 			void init(paxos_listener_ptr_t listener);
+			void configure(const property_tree::ptree& configuration);
 			string getXmlConfigurationTag();
+			bool isLogEnabled() {return mLog.isOpen();}
+			bool commitLog();
+			void truncate(uint32_t decisionId);
+			void setLease(clock_ptr_t clock, uint64_t grantUs) {mClock = clock; mLeaseGrantUs = grantUs;}
 
 		protected:
 			void reset(uint32_t peerId );
 
 		private:
+			/**
+			 * Value accepted for a decision, kept for the mPipelineWindow decisions from mDecisionId.
+			 */
+			struct AcceptedSlot
+			{
+				uint32_t		mDecisionId;
+				uint32_t		mProposal;
+				string			mValue;
+				uint64_t		mDigest; // of mValue, 0 while no value is accepted
+			};
+
 			PaxosMessage       mReply;
-			uint32_t           mLastAcceptedProposalId;
 			uint32_t           mLastPromisedProposalId;
 			string			   mLastSenderId;
-			string             mAcceptedValue;
+			vector<AcceptedSlot> mSlots; // ring indexed by decision id
+			vector<PaxosMessage> mPromisedValues; // PROMISED_VALUE replies following the last promise
+			size_t			   mPromisedValueCount;
 			uint8_t 		   mWrongValueCount;
+			string			   mLogDir;
+			size_t			   mLogMaxBytes;
+			AcceptorLog		   mLog;
+			clock_ptr_t		   mClock;
+			uint64_t		   mLeaseGrantUs; // lease granted with each accepted value, 0 if leases are disabled
+			string			   mLeaseHolder;
+			uint64_t		   mLeaseExpiryUs;
+
+			AcceptedSlot& getSlot(uint32_t decisionId);
+			const string& getAcceptedValue(uint32_t decisionId);
+			bool hasAcceptedValue(uint32_t decisionId);
+			void clearSlot(AcceptedSlot& slot);
+			void moveTo(uint32_t decisionId);
+			void promise(const PaxosMessage& message);
+			void reportAcceptedValues(const PaxosMessage& prepare);
+			void recover();
+			void grantLease(const string& proposerId);
+			bool isLeasedToOther(const string& proposerId);
 
 	};
 
 template<class PaxosListenerType> inline PaxosMessage AcceptorMH<PaxosListenerType>::replyPrepare(const PaxosMessage& message)
 {
 	mReply.init();
+	mPromisedValueCount = 0;
 	MH::logInbound(message);
 	if (!MH::isSenderBehind(message, mLastPromisedProposalId))
 	{
-		if (mAcceptedValue == ACCEPTED_VALUE_INIT  )
+		if (MH::mMultiPaxos && message.mProposal == mLastPromisedProposalId && message.mSenderId != mLastSenderId)
+		{//ballot numbers are not unique among proposers: a ballot is promised to one of them
+			PAXOS_WARN("Proposal#{} is already promised to {} => message is dropped.") << message.mProposal << mLastSenderId;
+			MH::count(METRIC_DROPPED_MESSAGES);
+		}
+		else if (isLeasedToOther(message.mSenderId))
+		{//the lease holder may serve reads locally until the lease expires
+			PAXOS_WARN("Proposal#{} of {} during the lease of {} => message is dropped.") << message.mProposal << message.mSenderId << mLeaseHolder;
+			MH::count(METRIC_DROPPED_MESSAGES);
+		}
+		else if (MH::mMultiPaxos)
+		{//the values accepted in the pipeline window are reported instead of refusing the promise
+			promise(message);
+			reportAcceptedValues(message);
+		}
+		else if (!hasAcceptedValue(message.mDecisionId))
 		{
-			string value = ACCEPTED_VALUE_INIT;
-			mReply.mDecisionId = MH::mDecisionId;
-			mReply.mMsgId = PROMISE_REPLY;
-			mReply.mSenderId = MH::mId;
-			mReply.mProposal = message.mProposal;
+			promise(message);
 			mReply.mValue = message.mValue;//possible optimization use init like vev for other than heartbeat
-			mLastPromisedProposalId = message.mProposal;
-			mLastSenderId = message.mSenderId;
 		}
 		else
 		{
-			cerr << "\tValue is wrong: Received=" << mReply.mValue << " - Expected=" << mAcceptedValue << " => message is dropped." << endl;
+			PAXOS_WARN("Value is wrong: Received={} - Expected={} => message is dropped.") << message.mValue << getAcceptedValue(message.mDecisionId);
+			MH::count(METRIC_DROPPED_MESSAGES);
 			mWrongValueCount++;
 			if (mWrongValueCount > MAX_WRONG_VALUE_COUNT)
 			{
-				mAcceptedValue = ACCEPTED_VALUE_INIT;
+				getSlot(message.mDecisionId).mValue = ACCEPTED_VALUE_INIT;
+				getSlot(message.mDecisionId).mDigest = 0;
+				mLog.appendAccept(message.mDecisionId, 0, ACCEPTED_VALUE_INIT);
 				mWrongValueCount = 0;
-				cout << "\tReached max wrong value timeout: Switched back accept valute to init value in order to allow new promise reply" << endl;
+				PAXOS_INFO("Reached max wrong value timeout: Switched back accept valute to init value in order to allow new promise reply");
 			}
 		}
 	}
 	else
 	{//reject to notify the proposer about current status
-		cerr << "DecisionID is behind: Expected=" << MH::mDecisionId << " => Sending a reject reply." << endl;
+		PAXOS_WARN("DecisionID is behind: Expected={} => Sending a reject reply.") << MH::mDecisionId;
 		mReply.mDecisionId = MH::mDecisionId;
 		mReply.mMsgId = REJECT_REPLY;
 		mReply.mSenderId = MH::mId;
+		mReply.mSenderIndex = MH::mIndex;
 		mReply.mProposal = mLastPromisedProposalId;//or last accepted?
-		mReply.mValue = mAcceptedValue;
+		mReply.mValue = getAcceptedValue(MH::mDecisionId);
 	}
 	return mReply;
 }
 
+template<class PaxosListenerType> inline void AcceptorMH<PaxosListenerType>::promise(const PaxosMessage& message)
+{
+	mReply.mDecisionId = message.mDecisionId;
+	mReply.mMsgId = PROMISE_REPLY;
+	mReply.mSenderId = MH::mId;
+	mReply.mSenderIndex = MH::mIndex;
+	mReply.mProposal = message.mProposal;
+	mLastPromisedProposalId = message.mProposal;
+	mLastSenderId = message.mSenderId;
+	mLog.appendPromise(message.mDecisionId, mLastPromisedProposalId, mLastSenderId);
+}
+
+/**
+ * Multi-paxos phase 1b: lists in the promise the decisions of the pipeline window from the prepared one
+ * holding an accepted value and prepares a PROMISED_VALUE reply for each (see protocole/promise.hpp).
+ */
+template<class PaxosListenerType> inline void AcceptorMH<PaxosListenerType>::reportAcceptedValues(const PaxosMessage& prepare)
+{
+	PromisedValues::startList(mReply.mValue, prepare.mSenderId);
+	for (uint32_t id = prepare.mDecisionId; id != prepare.mDecisionId + MH::mPipelineWindow; id++)
+	{
+		if (!hasAcceptedValue(id)) continue;
+		PromisedValues::appendDecision(mReply.mValue, id);
+		if (mPromisedValueCount == mPromisedValues.size()) mPromisedValues.push_back(PaxosMessage());
+		PaxosMessage& reply = mPromisedValues[mPromisedValueCount++];
+		reply.init();
+		reply.mDecisionId = id;
+		reply.mMsgId = PROMISED_VALUE;
+		reply.mSenderId = MH::mId;
+		reply.mSenderIndex = MH::mIndex;
+		reply.mProposal = prepare.mProposal;
+		PromisedValues::encodeValue(reply.mValue, prepare.mSenderId, getSlot(id).mProposal, getAcceptedValue(id));
+	}
+}
+
 template<class PaxosListenerType> inline PaxosMessage AcceptorMH<PaxosListenerType>::replyAccept(const PaxosMessage& message)
 {
 	mReply.init();
@@ -91,21 +183,43 @@ template<class PaxosListenerType> inline PaxosMessage AcceptorMH<PaxosListenerTy
 	if (!PaxosMH<PaxosListenerType>::isSenderBehind(message, mLastPromisedProposalId))
 	{
 		uint32_t proposal = message.mProposal;
-		if (proposal == mLastPromisedProposalId && mLastSenderId == message.mSenderId)
+		bool joinsBallot = MH::mMultiPaxos && proposal > mLastPromisedProposalId;//acceptor missed the prepare or restarted
+		if (joinsBallot && isLeasedToOther(message.mSenderId))
+		{//an implicit promise, refused during the lease of another proposer as the prepare would be
+			PAXOS_WARN("Proposal#{} of {} during the lease of {} => message is dropped.") << proposal << message.mSenderId << mLeaseHolder;
+			MH::count(METRIC_DROPPED_MESSAGES);
+		}
+		else if ((proposal == mLastPromisedProposalId && mLastSenderId == message.mSenderId) || joinsBallot)
 		{
-			mLastAcceptedProposalId = proposal;
-			mAcceptedValue = message.mValue;//compare with cached value drop message if wrong
+			if (joinsBallot)
+			{
+				mLastPromisedProposalId = proposal;
+				mLastSenderId = message.mSenderId;
+				mLog.appendPromise(message.mDecisionId, mLastPromisedProposalId, mLastSenderId);
+			}
+			AcceptedSlot& slot = getSlot(message.mDecisionId);
+			uint64_t digest = ValueDigest::get(message);
+			if (slot.mDigest != digest || slot.mValue != message.mValue)
+			{//a resent request is not copied again, the digest alone may collide
+				slot.mValue = message.mValue;
+				slot.mDigest = digest;
+			}
+			slot.mProposal = proposal;
+			mLog.appendAccept(message.mDecisionId, slot.mProposal, slot.mValue);
+			grantLease(message.mSenderId);
 			mReply.mDecisionId = message.mDecisionId;
 			mReply.mMsgId = ACCEPTED_VALUE;
 			mReply.mSenderId = MH::mId;
-			mReply.mProposal = mLastAcceptedProposalId;
-			mReply.mValue    = mAcceptedValue;
+			mReply.mSenderIndex = MH::mIndex;
+			mReply.mProposal = slot.mProposal;
+			if (!MH::mValueReferences) mReply.mValue = slot.mValue;//else the proposers know it from the request
+			mReply.mDigest   = slot.mDigest;
 			mWrongValueCount = 0;
 		}
 	}
 	else
 	{
-		cerr << "Sender is behind or senderId is wrong, message is dropped" << std::cout;
+		PAXOS_WARN("Sender is behind or senderId is wrong, message is dropped");
 	}
 	return mReply;
 }
@@ -118,19 +232,174 @@ template<class PaxosListenerType> std::string AcceptorMH<PaxosListenerType>::get
 template<class PaxosListenerType> void AcceptorMH<PaxosListenerType>::init(paxos_listener_ptr_t listener)
 {
 	MH::init(listener);
-	mAcceptedValue = ACCEPTED_VALUE_INIT;
-	mLastAcceptedProposalId = 0;
+	mSlots.assign(MH::mPipelineWindow, AcceptedSlot());
+	for (size_t i = 0; i < mSlots.size(); i++)
+	{
+		mSlots[i].mDecisionId = i;
+		clearSlot(mSlots[i]);
+	}
 	mLastPromisedProposalId = 0;
+	mPromisedValueCount = 0;
+	mWrongValueCount = 0;
+	mLeaseHolder.clear();
+	mLeaseExpiryUs = 0;
+	if (!mLogDir.empty())
+	{
+		recover();
+	}
 
 	cout << "\t" << MH::mId << " is initiallized" << endl;
 }
 
+template<class PaxosListenerType> void AcceptorMH<PaxosListenerType>::configure(const property_tree::ptree& configuration)
+{
+	MH::configure(configuration);
+	mLogDir = configuration.get<std::string>(XML_ACCEPTOR_LOG_DIR, "");
+	mLogMaxBytes = configuration.get<size_t>(XML_ACCEPTOR_LOG_MAX_BYTES, 16 << 20);
+	if (!mLogDir.empty()) cout << "\t" << MH::mId << " write-ahead log in " << mLogDir << endl;
+}
+
+/**
+ * Rebuilds the promise and the accepted values from the write-ahead log.
+ */
+template<class PaxosListenerType> void AcceptorMH<PaxosListenerType>::recover()
+{
+	vector<AcceptorLogRecord> records;
+	mLog.setMaxBytes(mLogMaxBytes);
+	mLog.open(mLogDir + "/" + MH::mId + ".wal", records);
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		const AcceptorLogRecord& record = records[i];
+		moveTo(record.mDecisionId);
+		if (record.mType == LOG_PROMISE)
+		{
+			mLastPromisedProposalId = record.mProposal;
+			mLastSenderId = record.mData;
+		}
+		else
+		{
+			AcceptedSlot& slot = getSlot(record.mDecisionId);
+			slot.mProposal = record.mProposal;
+			slot.mValue = record.mData;
+			slot.mDigest = slot.mValue == ACCEPTED_VALUE_INIT ? 0 : ValueDigest::of(slot.mValue);
+		}
+	}
+	if (!records.empty())
+	{//a lease granted before the restart may still run
+		grantLease(mLastSenderId);
+	}
+	cout << "\t" << MH::mId << " recovered " << records.size() << " log records: decision#" << MH::mDecisionId << " promised proposal#" << mLastPromisedProposalId << " to " << mLastSenderId << endl;
+}
+
+/**
+ * Makes the promises and accepted values of the last replies durable before they are sent.
+ * The log is compacted to the current promise and window once it exceeds log_max_bytes.
+ */
+template<class PaxosListenerType> bool AcceptorMH<PaxosListenerType>::commitLog()
+{
+	if (!mLog.commit())
+	{
+		return false;
+	}
+	if (mLog.isCompactionDue())
+	{
+		mLog.startCompaction();
+		mLog.appendPromise(MH::mDecisionId, mLastPromisedProposalId, mLastSenderId);
+		for (uint32_t decisionId = MH::mDecisionId; decisionId != MH::mDecisionId + MH::mPipelineWindow; decisionId++)
+		{
+			if (hasAcceptedValue(decisionId))
+			{
+				mLog.appendAccept(decisionId, getSlot(decisionId).mProposal, getAcceptedValue(decisionId));
+			}
+		}
+		mLog.commit();//on failure the previous log is still complete
+	}
+	return true;
+}
+
+/**
+ * Drops the accepted values of the decisions < decisionId, which are covered by a snapshot:
+ * the write-ahead log is compacted to the current promise and window.
+ */
+template<class PaxosListenerType> void AcceptorMH<PaxosListenerType>::truncate(uint32_t decisionId)
+{
+	for (size_t i = 0; i < mSlots.size(); i++)
+	{
+		if (mSlots[i].mDecisionId < decisionId && mSlots[i].mDecisionId < MH::mDecisionId)
+		{
+			clearSlot(mSlots[i]);
+		}
+	}
+	if (mLog.isOpen())
+	{
+		mLog.requestCompaction();
+		commitLog();
+	}
+}
+
+/**
+ * Lease of lease.duration_ms plus the drift, from the reception of an accept request: the
+ * proposer counts its own from the sending (see PaxosLH::hasLeaderLease).
+ */
+template<class PaxosListenerType> inline void AcceptorMH<PaxosListenerType>::grantLease(const string& proposerId)
+{
+	if (mLeaseGrantUs != 0)
+	{
+		mLeaseHolder = proposerId;
+		mLeaseExpiryUs = mClock->getMicroseconds() + mLeaseGrantUs;
+	}
+}
+
+template<class PaxosListenerType> inline bool AcceptorMH<PaxosListenerType>::isLeasedToOther(const string& proposerId)
+{
+	return mLeaseGrantUs != 0 && proposerId != mLeaseHolder && mClock->getMicroseconds() < mLeaseExpiryUs;
+}
+
+template<class PaxosListenerType> inline void AcceptorMH<PaxosListenerType>::moveTo(uint32_t decisionId)
+{
+	if (decisionId >= MH::mDecisionId + MH::mPipelineWindow)
+	{
+		reset(decisionId + 1 - MH::mPipelineWindow);
+	}
+}
+
 template<class PaxosListenerType> inline void AcceptorMH<PaxosListenerType>::reset(uint32_t peerId )
 {
-	MH::mDecisionId = peerId;
-	mAcceptedValue = ACCEPTED_VALUE_INIT;
-	mLastPromisedProposalId = 0;
-	mLastAcceptedProposalId = 0;
+	MH::mDecisionId = peerId;//slots of the previous decisions are recycled by getSlot()
+	if (!MH::mMultiPaxos)
+	{//in multi-paxos the promise (mLastPromisedProposalId, mLastSenderId) covers all the next decisions
+		mLastPromisedProposalId = 0;
+	}
+}
+
+template<class PaxosListenerType> inline typename AcceptorMH<PaxosListenerType>::AcceptedSlot& AcceptorMH<PaxosListenerType>::getSlot(uint32_t decisionId)
+{
+	AcceptedSlot& slot = mSlots[decisionId % mSlots.size()];
+	if (slot.mDecisionId != decisionId)
+	{
+		slot.mDecisionId = decisionId;
+		clearSlot(slot);
+	}
+	return slot;
+}
+
+template<class PaxosListenerType> inline void AcceptorMH<PaxosListenerType>::clearSlot(AcceptedSlot& slot)
+{
+	slot.mProposal = 0;
+	slot.mValue = ACCEPTED_VALUE_INIT;
+	slot.mDigest = 0;
+}
+
+template<class PaxosListenerType> inline const string& AcceptorMH<PaxosListenerType>::getAcceptedValue(uint32_t decisionId)
+{
+	const AcceptedSlot& slot = mSlots[decisionId % mSlots.size()];
+	return slot.mDecisionId == decisionId ? slot.mValue : ACCEPTED_VALUE_INIT;
+}
+
+template<class PaxosListenerType> inline bool AcceptorMH<PaxosListenerType>::hasAcceptedValue(uint32_t decisionId)
+{
+	const AcceptedSlot& slot = mSlots[decisionId % mSlots.size()];
+	return slot.mDecisionId == decisionId && slot.mDigest != 0;
 }
 
 }
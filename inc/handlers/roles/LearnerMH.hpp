@@ -0,0 +1,196 @@
+/*
+ * LearnerMH.h
+ *
+ *  Created on: Apr 15, 2016
+ *      Author: gll
+ */
+
+#ifndef LEARNERMH_H_
+#define LEARNERMH_H_
+
+#include <vector>
+#include "handlers/PaxosMH.hpp"
+#include "storage/DecidedLog.hpp"
+#include "storage/SnapshotStore.hpp"
+
+using namespace boost;
+
+namespace paxos
+{
+
+/**
+ * Handles values persistence: the decided values are appended to a memory-mapped
+ * log (when log_dir is set) and can be read back by decision id without copy.
+ * The log is made durable every sync_ms off the message path: the acceptors keep the
+ * decisions durable, a tail lost in a crash is caught up from the peers.
+ * Application snapshots are stored next to the log, which is truncated below them.
+ */
+template<class PaxosListenerType> class LearnerMH : public PaxosMH<PaxosListenerType>
+{
+	typedef PaxosMH<PaxosListenerType> 		MH;
+	typedef boost::shared_ptr<PaxosListenerType> 	paxos_listener_ptr_t;
+
+	public:
+		~LearnerMH(){};
+		void init(paxos_listener_ptr_t listener);
+		void configure(const property_tree::ptree& configuration);
+		std::string getXmlConfigurationTag();
+		void onConsensus(uint32_t decisionId, const std::string& value);
+		bool get(uint32_t decisionId, const char*& data, uint32_t& size) const { return mLog.get(decisionId, data, size); }
+		uint32_t getFirstDecisionId() const { return mLog.getFirstDecisionId(); }
+		size_t read(uint32_t from, uint32_t to, std::vector<DecidedValue>& values) const;
+		void sync(bool durable);
+		int getSyncMs() const { return mLog.isOpen() ? mSyncMs : 0; }
+		bool saveSnapshot(uint32_t decisionId, const std::string& state);
+		bool loadSnapshot(uint32_t& decisionId, std::string& state) const;
+		const std::string* getSnapshot(uint32_t& decisionId);
+		bool installSnapshot(uint32_t decisionId, const std::string& state);
+
+	protected:
+		void reset(uint32_t){};
+
+	private:
+		string			mLogDir;
+		uint32_t		mDecisionsPerSegment;
+		uint64_t		mSegmentBytes;
+		int				mSyncMs;//0: durable at the end of each receive batch
+		DecidedLog		mLog;
+		SnapshotStore	mSnapshots;
+		uint32_t		mSentSnapshotId;//snapshot loaded for the catch-up of the peers, NO_DECISION if none
+		std::string		mSentSnapshot;
+
+};
+
+template<class PaxosListenerType> std::string LearnerMH<PaxosListenerType>::getXmlConfigurationTag()
+ {
+	 return XML_LEARNER_ID;
+ }
+
+template<class PaxosListenerType> void LearnerMH<PaxosListenerType>::configure(const property_tree::ptree& configuration)
+{
+	MH::configure(configuration);
+	mLogDir = configuration.get<std::string>(XML_LEARNER_LOG_DIR, "");
+	mDecisionsPerSegment = configuration.get<uint32_t>(XML_LEARNER_DECISIONS_PER_SEGMENT, 65536);
+	mSegmentBytes = configuration.get<uint64_t>(XML_LEARNER_SEGMENT_BYTES, 16 << 20);
+	mSyncMs = configuration.get<int>(XML_LEARNER_SYNC_MS, 1000);
+	if (mSyncMs < 0)
+	{
+		throw std::runtime_error("In configuration " + XML_LEARNER_SYNC_MS + " must be >= 0");
+	}
+	if (mDecisionsPerSegment == 0 || mSegmentBytes == 0)
+	{
+		throw std::runtime_error("In configuration " + XML_LEARNER_DECISIONS_PER_SEGMENT + " and " + XML_LEARNER_SEGMENT_BYTES + " must be > 0");
+	}
+	if (!mLogDir.empty()) cout << "\t" << MH::mId << " decided log in " << mLogDir << endl;
+}
+
+template<class PaxosListenerType> void LearnerMH<PaxosListenerType>::init(paxos_listener_ptr_t listener)
+{
+	MH::init(listener);
+	mSentSnapshotId = NO_DECISION;
+	if (!mLogDir.empty())
+	{
+		mLog.open(mLogDir, MH::mId, mDecisionsPerSegment, mSegmentBytes);
+		mSnapshots.open(mLogDir, MH::mId);
+		uint32_t snapshotId;
+		std::string state;
+		if (mSnapshots.load(snapshotId, state))
+		{//the log is empty if the snapshot was taken at a segment boundary
+			mLog.skipTo(snapshotId);
+		}
+		MH::mDecisionId = mLog.getNextDecisionId();
+		cout << "\t" << MH::mId << " decided log holds decisions [" << mLog.getFirstDecisionId() << ", " << mLog.getNextDecisionId() << ")" << endl;
+	}
+}
+
+/**
+ * Stores a decided value, called in decision order (see DecisionSequencer).
+ */
+template<class PaxosListenerType> void LearnerMH<PaxosListenerType>::onConsensus(uint32_t decisionId, const std::string& value)
+{
+	mLog.append(decisionId, value.data(), value.size());
+	if (decisionId >= MH::mDecisionId)
+	{
+		MH::mDecisionId = decisionId + 1;
+	}
+}
+
+/**
+ * Flushes the values stored since the last call: at the end of each receive batch the write back
+ * is only scheduled (durable with sync_ms 0), every sync_ms it is waited for.
+ */
+template<class PaxosListenerType> inline void LearnerMH<PaxosListenerType>::sync(bool durable)
+{
+	if (mLog.isOpen())
+	{
+		mLog.sync(durable);
+	}
+}
+
+/**
+ * Appends the decided values of [from, to) found in the log. They point into the log
+ * mapping and are valid until the next value is stored or the log is truncated.
+ */
+template<class PaxosListenerType> inline size_t LearnerMH<PaxosListenerType>::read(uint32_t from, uint32_t to, std::vector<DecidedValue>& values) const
+{
+	return mLog.read(from, to, values);
+}
+
+/**
+ * Stores the application state reached once the decisions < decisionId are applied,
+ * then drops the log segments it covers.
+ */
+template<class PaxosListenerType> bool LearnerMH<PaxosListenerType>::saveSnapshot(uint32_t decisionId, const std::string& state)
+{
+	sync(true);//the decisions the snapshot does not cover are durable before it drops the older ones
+	if (!mSnapshots.save(decisionId, state))
+	{
+		return false;
+	}
+	mLog.truncate(decisionId);
+	mSentSnapshotId = NO_DECISION;//loaded again by the next catch-up which needs it
+	mSentSnapshot.clear();
+	cout << "\t" << MH::mId << " snapshot at decision#" << decisionId << ", log holds decisions [" << mLog.getFirstDecisionId() << ", " << mLog.getNextDecisionId() << ")" << endl;
+	return true;
+}
+
+template<class PaxosListenerType> inline bool LearnerMH<PaxosListenerType>::loadSnapshot(uint32_t& decisionId, std::string& state) const
+{
+	return mSnapshots.load(decisionId, state);
+}
+
+/**
+ * Latest snapshot, to send to a peer missing the decisions it covers. It is loaded once
+ * and kept until the next snapshot is saved. NULL if there is none.
+ */
+template<class PaxosListenerType> const std::string* LearnerMH<PaxosListenerType>::getSnapshot(uint32_t& decisionId)
+{
+	if (mSentSnapshotId == NO_DECISION && !mSnapshots.load(mSentSnapshotId, mSentSnapshot))
+	{
+		mSentSnapshotId = NO_DECISION;
+		return NULL;
+	}
+	decisionId = mSentSnapshotId;
+	return &mSentSnapshot;
+}
+
+/**
+ * Stores the snapshot of a peer restored by the listener: the log resumes at decisionId.
+ */
+template<class PaxosListenerType> bool LearnerMH<PaxosListenerType>::installSnapshot(uint32_t decisionId, const std::string& state)
+{
+	if (mLog.isOpen() && !saveSnapshot(decisionId, state))
+	{
+		return false;
+	}
+	mLog.skipTo(decisionId);
+	if (decisionId > MH::mDecisionId)
+	{
+		MH::mDecisionId = decisionId;
+	}
+	return true;
+}
+
+}
+
+#endif /* LEARNERMH_H_ */
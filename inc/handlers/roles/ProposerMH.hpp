@@ -9,9 +9,16 @@
 #define PROPOSERMH_H_
 
 #include <set>
+#include <algorithm>
 #include <map>
+#include <deque>
+#include <vector>
 #include <boost/foreach.hpp>
 #include "handlers/PaxosMH.hpp"
+#include "protocole/batch.hpp"
+#include "protocole/promise.hpp"
+#include "protocole/digest.hpp"
+#include "handlers/ValueCache.hpp"
 
 using namespace std;
 using namespace boost;
@@ -21,24 +28,44 @@ namespace paxos
 
 	template<class PaxosListenerType> class ProposerMH : public PaxosMH<PaxosListenerType>
 	{
-		typedef map<string, set<string> >	StringSetMap;
-		typedef set<string> ListOfUniqueStrings;
 		typedef PaxosMH<PaxosListenerType> MH;
 		typedef boost::shared_ptr<PaxosListenerType> paxos_listener_ptr_t;
 
 		public:
+			ProposerMH() : mValueCache(NULL) {};
 			~ProposerMH() {};
 			PaxosMessage replyPromise(const PaxosMessage& message);
+			PaxosMessage replyPromisedValue(const PaxosMessage& message);
 			PaxosMessage replyAccepted(const PaxosMessage& message);
 			PaxosMessage replyReject(const PaxosMessage& message);
 			PaxosMessage getPrepareRequest();
+			PaxosMessage getAcceptRequest();
+			PaxosMessage getNextRequest();
+			PaxosMessage getResentAcceptRequest(uint32_t decisionId);
+			bool startResend();
+			bool yield(const PaxosMessage& message);
 			bool belowQuorumMajority();
 			bool hasReachedQuorumMajority();
 			bool belowLearnQuorum ();
 			bool hasLearnQuorum ();
+			bool isLearned(uint32_t decisionId) {return getDecidedVote(getSlot(decisionId)) != NULL;}
+			PaxosMessage getConsensusNotification();
+			const string& getDecidedValue() {return *mDecidedValue;}
 			MsgId getPendingAcceptorMessageType();
 			void doEndOfCycle();
 			void synchronize(uint32_t decisionId, uint32_t proposalId);
+			void follow(const PaxosMessage& request);
+			bool enqueue(string& command, uint64_t proposedUs);
+			void abortBatches();
+			bool canPropose();
+			bool hasInFlightDecisions() {return mNextDecisionId != MH::mDecisionId;}
+			uint32_t getNextDecisionId() {return mNextDecisionId;}
+			bool hasPendingCommands() {return mPendingCommands.size() > mInFlightCount;}
+			bool hasAdoptedValue() {return hasAdoptedValue(mNextDecisionId);}
+			bool isBatchFull() {return mPendingCommands.size() - mInFlightCount >= mBatchMaxCount || mPendingBytes + MH::mId.size() + 1 >= mBatchMaxBytes;}
+			int getBatchLingerMs() {return mBatchLingerMs;}
+			const vector<uint64_t>& getDecidedCommandTimes() {return mDecidedTimes;}
+			void setValueCache(const ValueCache* cache) {mValueCache = cache;}
 
 			void init(paxos_listener_ptr_t listener);
 			std::string getXmlConfigurationTag();
@@ -48,31 +75,98 @@ namespace paxos
 			bool isCandidate() {return mState == LEAD_CANDIDATE;}
 			bool isLeader() {return mState == LEAD_PRIMARY;}
 			bool isStandby() {return mState == LEAD_STANDBY;}
+			bool hasPromise() {return mHasPromise;}
 			PaxosMessage candidate()
 			{
 				handleStateTransition(LEAD_CANDIDATE);
 				return getPrepareRequest();
 			}
-			void standby() {handleStateTransition(LEAD_STANDBY);}
+			void standby()
+			{
+				mHasPromise = false;
+				dropCommands();
+				handleStateTransition(LEAD_STANDBY);
+			}
 
 		protected:
 			void reset(uint32_t peerId );
 
 		private:
+			/**
+			 * Acceptors which accepted a value, tallied by digest. The value proposed by this
+			 * proposer is not copied (mProposed): it is the mProposedValue of the slot. With value
+			 * references the other values are empty, they are resolved in the value cache.
+			 */
+			struct Vote
+			{
+				uint64_t		mDigest;
+				string			mValue;
+				bool			mProposed;
+				QuorumMask		mAcceptors;
+			};
+
+			/**
+			 * Per decision state, kept for the mPipelineWindow decisions from mDecisionId.
+			 * The votes are recycled (mVoteCount) to keep their string capacity.
+			 */
+			struct Slot
+			{
+				uint32_t		mDecisionId;
+				vector<Vote>	mVotes;
+				size_t			mVoteCount;
+				size_t			mBatchCount; // commands of mPendingCommands proposed in this decision
+				bool			mInFlight; // this proposer sent an accept request for this decision
+				string			mProposedValue;
+				uint64_t		mProposedDigest;
+				uint32_t		mAdoptedProposal; // multi-paxos phase 1: highest proposal accepted for this decision, 0 if none
+				string			mAdoptedValue;
+				QuorumMask		mListed; // acceptors whose promise lists an accepted value for this decision
+				QuorumMask		mReported; // acceptors whose accepted value for this decision is received
+
+				Slot() : mDecisionId(0xFFFFFFFF), mVoteCount(0), mBatchCount(0), mInFlight(false), mProposedDigest(0), mAdoptedProposal(0) {}
+			};
+
 			PaxosMessage 				mReply;
 			MsgId						mPendingAcceptorMessageType;
-			set<string>  				mQuorumSet;
-			uint32_t        			mQuorumMajority;
 			uint32_t        			mLastProposedNumber; // number which we last proposed
 			string          			mCurrLeader;
 			string          			mAcceptedValue;
 			string          			mPromotedValue; // the value which we promote
-			set<string> 				mAcceptorsPositive; // acceptors which accepted our proposal
-			map<string, set<string> >	mLearnedValues;
+			QuorumMask	 				mAcceptorsPositive; // acceptors which promised our proposal
+			QuorumMask					mPromisesReceived; // counted in mAcceptorsPositive once their listed values are received
+			vector<Slot>				mSlots; // ring indexed by decision id
+			uint32_t					mNextDecisionId; // decisions [mDecisionId, mNextDecisionId) are in flight
+			uint32_t					mResentDecisionId; // oldest decision in flight when the accept requests were last sent again
+			const string*				mDecidedValue; // value of mDecisionId once hasLearnQuorum(), held by its slot
+			uint64_t					mDecidedDigest;
 			ProposerState 				mStartState;
 			ProposerState 				mState;
+			bool						mHasPromise; // multi-paxos: phase 1 is done for all decisions from mDecisionId
+			deque<string>				mPendingCommands; // proposed commands, the first mInFlightCount ones are in flight
+			deque<uint64_t>				mPendingTimes; // proposal time of each pending command, for the metrics
+			vector<uint64_t>			mDecidedTimes; // of the commands decided by the last doEndOfCycle()
+			size_t						mPendingBytes; // encoded size of the commands not in flight
+			size_t						mInFlightCount;
+			uint32_t					mBatchMaxBytes;
+			uint32_t					mBatchMaxCount;
+			int							mBatchLingerMs;
+			const ValueCache*			mValueCache; // of the line handler, see setValueCache()
 
 			void clearVote();
+			void countPromise(uint16_t index);
+			size_t countOwnCommands(const string& value);
+			bool hasAdoptedValue(uint32_t decisionId);
+			size_t findOwnCommands(const string& value, size_t& count);
+			void eraseOwnCommands(const string& value);
+			void clearVotes(Slot& slot) {slot.mVoteCount = 0;}
+			bool isDecidedAsProposed(const Slot& slot) {return slot.mInFlight && !mCurrLeader.empty() && mDecidedValue == &slot.mProposedValue;}
+			bool isProposedValue(const Slot& slot, uint64_t digest, const PaxosMessage& message);
+			bool isVoteFor(const Slot& slot, const Vote& vote, uint64_t digest, const PaxosMessage& message);
+			void clearAdoption(Slot& slot) {slot.mAdoptedProposal = 0; slot.mListed.reset(); slot.mReported.reset();}
+			const Vote* getDecidedVote(Slot& slot);
+			void detachVotes(Slot& slot);
+			void dropCommands();
+			Slot& getSlot(uint32_t decisionId);
 			void handleStateTransition(ProposerState newState);
 
 };
@@ -84,81 +178,147 @@ template<class PaxosListenerType> inline PaxosMessage ProposerMH<PaxosListenerTy
 
 	if (!MH::isSenderBehind(message, mLastProposedNumber))
 	{
-		if (message.mProposal == mLastProposedNumber)
+		uint16_t index = MH::mQuorum.indexOf(message);
+		if (message.mProposal == mLastProposedNumber && index != NO_NODE_INDEX && !mPromisesReceived.test(index))
 		{
-			mAcceptorsPositive.insert(message.mSenderId);
-			if (belowQuorumMajority())
-			{
-				mPendingAcceptorMessageType = PROMISE_REPLY;//still waiting
+			size_t offset = PromisedValues::findDecisions(message.mValue, MH::mId);
+			uint32_t decisionId;
+			if (MH::mMultiPaxos && offset == 0)
+			{//promise of another proposer running the same ballot
+				return mReply;
 			}
-			else if (hasReachedQuorumMajority())
+			mPromisesReceived.set(index);
+			while (PromisedValues::nextDecision(message.mValue, offset, decisionId))
 			{
-				if (MH::mTrace) cout << "REACHED PROMISE QUORUM" << endl;
-				if ((isCandidate() || isLeader()))
-				{
-					mReply.mMsgId = ACCEPT_REQUEST;
-					mReply.mDecisionId = MH::mDecisionId;
-					mReply.mSenderId = MH::mId;
-					mReply.mProposal = mLastProposedNumber;
-					mReply.mValue = mPromotedValue;
-					mPendingAcceptorMessageType = ACCEPTED_VALUE;
-				}
+				if (decisionId >= MH::mDecisionId && decisionId < MH::mDecisionId + MH::mPipelineWindow) getSlot(decisionId).mListed.set(index);
 			}
+			countPromise(index);
+		}
+	}
+	return mReply;
+}
+
+/**
+ * Multi-paxos phase 1b: adopts the value accepted with the highest proposal for its decision.
+ */
+template<class PaxosListenerType> inline PaxosMessage ProposerMH<PaxosListenerType>::replyPromisedValue(const PaxosMessage& message)
+{
+	mReply.init();
+	MH::logInbound(message);
+	uint16_t index = MH::mQuorum.indexOf(message);
+	uint32_t acceptedProposal;
+	const char* data;
+	uint32_t size;
+	if (message.mProposal != mLastProposedNumber || index == NO_NODE_INDEX || !PromisedValues::decodeValue(message.mValue, MH::mId, acceptedProposal, data, size))
+	{
+		return mReply;
+	}
+	if (message.mDecisionId >= MH::mDecisionId && message.mDecisionId < MH::mDecisionId + MH::mPipelineWindow)
+	{//the values of the decisions learned meanwhile are no longer needed
+		Slot& slot = getSlot(message.mDecisionId);
+		if (!slot.mReported.test(index) && acceptedProposal >= slot.mAdoptedProposal)
+		{
+			slot.mAdoptedProposal = std::max(acceptedProposal, (uint32_t) 1);
+			slot.mAdoptedValue.assign(data, size);
 		}
+		slot.mReported.set(index);
 	}
+	countPromise(index);
 	return mReply;
 }
 
+/**
+ * An acceptor counts in the promise quorum once its promise and the values it listed are received.
+ */
+template<class PaxosListenerType> inline void ProposerMH<PaxosListenerType>::countPromise(uint16_t index)
+{
+	if (!mPromisesReceived.test(index) || mAcceptorsPositive.test(index))
+	{
+		return;
+	}
+	for (uint32_t decisionId = MH::mDecisionId; decisionId != MH::mDecisionId + MH::mPipelineWindow; decisionId++)
+	{
+		const Slot& slot = getSlot(decisionId);
+		if (slot.mListed.test(index) && !slot.mReported.test(index)) return;
+	}
+	mAcceptorsPositive.set(index);
+	if (belowQuorumMajority())
+	{
+		mPendingAcceptorMessageType = PROMISE_REPLY;//still waiting
+	}
+	else if (hasReachedQuorumMajority())
+	{
+		if (MH::mTrace) PAXOS_DEBUG("REACHED PROMISE QUORUM");
+		if ((isCandidate() || isLeader()))
+		{
+			mHasPromise = MH::mMultiPaxos;
+			getAcceptRequest();
+		}
+	}
+}
+
+/**
+ * Tallies the accepted value in its decision slot, see hasLearnQuorum().
+ */
 template<class PaxosListenerType> inline PaxosMessage ProposerMH<PaxosListenerType>::replyAccepted(const PaxosMessage& message)
 {
 	mReply.init();
 	MH::logInbound(message);
 	if (!MH::isSenderBehind(message, mLastProposedNumber))
 	{
-		string value = message.mValue;
-		if (value != ACCEPTED_VALUE_INIT)//must be checked against proposedValue!
+		uint16_t index = MH::mQuorum.indexOf(message);
+		if (message.mValue != ACCEPTED_VALUE_INIT && index != NO_NODE_INDEX)//must be checked against proposedValue!
 		{
-			string senderId = message.mSenderId;
-			map<string, set<string> >::iterator found = mLearnedValues.find(value);
-			if (found == mLearnedValues.end())
-			{
-				set<string> newSet;
-				newSet.insert(senderId);
-				mLearnedValues[value] = newSet;
-			}
-			else
-			{//found
-				found->second.insert(senderId);
+			Slot& slot = getSlot(message.mDecisionId);
+			uint64_t digest = ValueDigest::get(message);
+			size_t i = 0;
+			while (i < slot.mVoteCount && !isVoteFor(slot, slot.mVotes[i], digest, message)) i++;
+			if (i == slot.mVoteCount)
+			{//first acceptor of this value: it is copied unless this proposer proposed it
+				if (i == slot.mVotes.size()) slot.mVotes.push_back(Vote());
+				Vote& vote = slot.mVotes[i];
+				vote.mDigest = digest;
+				vote.mProposed = isProposedValue(slot, digest, message);
+				if (!vote.mProposed) vote.mValue = message.mValue;
+				vote.mAcceptors.reset();
+				slot.mVoteCount++;
 			}
+			slot.mVotes[i].mAcceptors.set(index);
 			if (belowLearnQuorum())
 			{
 				mPendingAcceptorMessageType = ACCEPTED_VALUE;//still waiting
 			}
-			if (hasLearnQuorum())
-			{
-
-				if (MH::mTrace)  cout << "REACHED ACCEPT QUORUM: ELECTED PROPOSER=" << mCurrLeader << endl;
-				if (mCurrLeader == MH::mId)
-				{
-					mReply.mDecisionId = MH::mDecisionId;
-					mReply.mMsgId = CONSENSUS_NOTIFICATION;
-					mReply.mSenderId = MH::mId;
-					mReply.mProposal = mLastProposedNumber;
-					mReply.mValue = mPromotedValue;
-					handleStateTransition(LEAD_PRIMARY);
-					mPendingAcceptorMessageType = NULL_MESSAGE;
-				}
-			}
 		}
 	}
 	return mReply;
 }
 
+/**
+ * Reply to send once hasLearnQuorum(): the elected proposer notifies the consensus.
+ */
+template<class PaxosListenerType> inline PaxosMessage ProposerMH<PaxosListenerType>::getConsensusNotification()
+{
+	mReply.init();
+	if (MH::mTrace) PAXOS_DEBUG("REACHED ACCEPT QUORUM: ELECTED PROPOSER={}") << mCurrLeader;
+	if (mCurrLeader == MH::mId || isDecidedAsProposed(getSlot(MH::mDecisionId)))
+	{//or the value of another proposer this one adopted in phase 1
+		mReply.mDecisionId = MH::mDecisionId;
+		mReply.mMsgId = CONSENSUS_NOTIFICATION;
+		mReply.mSenderId = MH::mId;
+		mReply.mProposal = mLastProposedNumber;
+		if (!MH::mValueReferences) mReply.mValue = *mDecidedValue;//else the learners know it from the request
+		mReply.mDigest = mDecidedDigest;
+		handleStateTransition(LEAD_PRIMARY);
+	}
+	return mReply;
+}
+
 template<class PaxosListenerType> inline PaxosMessage ProposerMH<PaxosListenerType>::replyReject(const PaxosMessage& message)
 {
 	mReply.init();
 	MH::logInbound(message);
-	std::cout << "Received reject: Re-synchronizing to current decision/proposal ids" << std::endl;
+	PAXOS_INFO("Received reject: Re-synchronizing to current decision/proposal ids");
+	mHasPromise = false;
 	reset(message.mDecisionId);
 	mLastProposedNumber = message.mProposal;
 	return mReply;
@@ -166,72 +326,401 @@ template<class PaxosListenerType> inline PaxosMessage ProposerMH<PaxosListenerTy
 
 template<class PaxosListenerType> inline PaxosMessage ProposerMH<PaxosListenerType>::getPrepareRequest()
 {
-	if (MH::mTrace) cout << endl;
 	mLastProposedNumber++;
+	mHasPromise = false;
+	abortBatches();
 	clearVote();
+	mPromisesReceived.reset();
+	mResentDecisionId = NO_DECISION;
+	for (uint32_t decisionId = MH::mDecisionId; decisionId != MH::mDecisionId + MH::mPipelineWindow; decisionId++)
+	{
+		clearAdoption(getSlot(decisionId));
+	}
 	mReply.mDecisionId = MH::mDecisionId;
 	mReply.mMsgId = PREPARE_REQUEST;
 	mReply.mSenderId = MH::mId;
 	mReply.mProposal = mLastProposedNumber;
 	mReply.mValue = ACCEPTED_VALUE_INIT;
+	mReply.mDigest = 0;
 	mPendingAcceptorMessageType = PROMISE_REPLY;
 	return mReply;
 }
 
+/**
+ * Opens decision mNextDecisionId with a batch of the commands not in flight yet.
+ */
+template<class PaxosListenerType> inline PaxosMessage ProposerMH<PaxosListenerType>::getAcceptRequest()
+{
+	Slot& slot = getSlot(mNextDecisionId);
+	size_t bytes = MH::mId.size() + 1;
+	slot.mBatchCount = 0;
+	if (slot.mAdoptedProposal != 0)
+	{//a value may have been chosen in a previous ballot: it is proposed again
+		mPromotedValue = slot.mAdoptedValue;
+		slot.mBatchCount = countOwnCommands(mPromotedValue);
+		for (size_t i = 0; i < slot.mBatchCount; i++)
+		{
+			bytes += ValueBatch::encodedSize(mPendingCommands[mInFlightCount + i]);
+		}
+	}
+	else if (hasAdoptedValue(mNextDecisionId + 1))
+	{//a later decision may have been chosen with these commands: the gap is filled with a no-op
+		mPromotedValue = ValueBatch::noop(MH::mId);
+	}
+	else
+	{
+		while (mInFlightCount + slot.mBatchCount < mPendingCommands.size() && slot.mBatchCount < mBatchMaxCount
+				&& bytes + ValueBatch::encodedSize(mPendingCommands[mInFlightCount + slot.mBatchCount]) <= mBatchMaxBytes)
+		{
+			bytes += ValueBatch::encodedSize(mPendingCommands[mInFlightCount + slot.mBatchCount]);
+			slot.mBatchCount++;
+		}
+		ValueBatch::encode(mPromotedValue, MH::mId, mPendingCommands, mInFlightCount, slot.mBatchCount);
+	}
+	mPendingBytes -= bytes - (MH::mId.size() + 1);
+	mInFlightCount += slot.mBatchCount;
+	uint64_t digest = ValueDigest::of(mPromotedValue);//once per proposed value
+	if (digest != slot.mProposedDigest || mPromotedValue != slot.mProposedValue) detachVotes(slot);
+	slot.mProposedValue = mPromotedValue;
+	slot.mProposedDigest = digest;
+	slot.mInFlight = true;
+	mReply.mMsgId = ACCEPT_REQUEST;
+	mReply.mDecisionId = mNextDecisionId++;
+	mReply.mSenderId = MH::mId;
+	mReply.mProposal = mLastProposedNumber;
+	mReply.mValue = mPromotedValue;
+	mReply.mDigest = slot.mProposedDigest;
+	mPendingAcceptorMessageType = ACCEPTED_VALUE;
+	return mReply;
+}
+
+/**
+ * Multi-paxos: a leader still holding the promise of the quorum skips phase 1.
+ */
+template<class PaxosListenerType> inline PaxosMessage ProposerMH<PaxosListenerType>::getNextRequest()
+{
+	if (mHasPromise && isLeader())
+	{
+		clearVote();
+		return getAcceptRequest();
+	}
+	return getPrepareRequest();
+}
+
+/**
+ * Multi-paxos: true the first time the decisions in flight time out without progress. Their
+ * accept requests are then sent again, with the same ballot and values, before running phase 1.
+ */
+template<class PaxosListenerType> inline bool ProposerMH<PaxosListenerType>::startResend()
+{
+	if (!mHasPromise || mResentDecisionId == MH::mDecisionId)
+	{
+		return false;
+	}
+	mResentDecisionId = MH::mDecisionId;
+	return true;
+}
+
+/**
+ * Accept request of a decision in flight, see startResend(). NULL_MESSAGE if it is not in flight.
+ */
+template<class PaxosListenerType> inline PaxosMessage ProposerMH<PaxosListenerType>::getResentAcceptRequest(uint32_t decisionId)
+{
+	mReply.init();
+	Slot& slot = getSlot(decisionId);
+	if (slot.mInFlight)
+	{
+		mReply.mMsgId = ACCEPT_REQUEST;
+		mReply.mDecisionId = decisionId;
+		mReply.mSenderId = MH::mId;
+		mReply.mProposal = mLastProposedNumber;
+		mReply.mValue = slot.mProposedValue;
+		mReply.mDigest = slot.mProposedDigest;
+	}
+	return mReply;
+}
+
+/**
+ * True if phase 1 adopted a value for the next decision to open or a later one of the window,
+ * the decisions before it are opened with a no-op if they have none.
+ */
+template<class PaxosListenerType> inline bool ProposerMH<PaxosListenerType>::hasAdoptedValue(uint32_t decisionId)
+{
+	for (; decisionId - MH::mDecisionId < MH::mPipelineWindow; decisionId++)
+	{
+		if (getSlot(decisionId).mAdoptedProposal != 0) return true;
+	}
+	return false;
+}
+
+/**
+ * Position of the commands of a batch of this proposer among its pending commands not in flight,
+ * in the same order, with their number in count. mPendingCommands.size() if they are not found.
+ */
+template<class PaxosListenerType> inline size_t ProposerMH<PaxosListenerType>::findOwnCommands(const string& value, size_t& count)
+{
+	count = 0;
+	if (ValueBatch::leaderOf(value) != MH::mId)
+	{
+		return mPendingCommands.size();
+	}
+	const char* data = NULL;
+	uint32_t size = 0;
+	for (size_t first = mInFlightCount; first < mPendingCommands.size(); first++)
+	{
+		size_t offset = 0;
+		bool matches = true;
+		count = 0;
+		while (matches && ValueBatch::next(value, offset, data, size))
+		{
+			matches = first + count < mPendingCommands.size() && mPendingCommands[first + count].compare(0, string::npos, data, size) == 0;
+			count++;
+		}
+		if (matches && count != 0) return first;
+	}
+	count = 0;
+	return mPendingCommands.size();
+}
+
+/**
+ * Number of commands of an adopted batch which are pending commands of this proposer, 0 if the
+ * batch is not made of them. They are moved to the front of the commands not in flight, so that
+ * they are not proposed twice: a batch of the window may be chosen while an earlier one was not.
+ */
+template<class PaxosListenerType> inline size_t ProposerMH<PaxosListenerType>::countOwnCommands(const string& value)
+{
+	size_t count;
+	size_t first = findOwnCommands(value, count);
+	if (count != 0 && first != mInFlightCount)
+	{
+		std::rotate(mPendingCommands.begin() + mInFlightCount, mPendingCommands.begin() + first, mPendingCommands.begin() + first + count);
+		std::rotate(mPendingTimes.begin() + mInFlightCount, mPendingTimes.begin() + first, mPendingTimes.begin() + first + count);
+	}
+	return count;
+}
+
+/**
+ * A batch of this proposer was decided in another slot than the one proposing it, e.g. adopted
+ * by another leader: its commands are no longer pending.
+ */
+template<class PaxosListenerType> inline void ProposerMH<PaxosListenerType>::eraseOwnCommands(const string& value)
+{
+	size_t count;
+	size_t first = findOwnCommands(value, count);
+	if (count == 0)
+	{
+		return;
+	}
+	for (size_t i = first; i < first + count; i++)
+	{
+		mPendingBytes -= ValueBatch::encodedSize(mPendingCommands[i]);
+	}
+	mPendingCommands.erase(mPendingCommands.begin() + first, mPendingCommands.begin() + first + count);
+	mDecidedTimes.assign(mPendingTimes.begin() + first, mPendingTimes.begin() + first + count);
+	mPendingTimes.erase(mPendingTimes.begin() + first, mPendingTimes.begin() + first + count);
+}
+
+/**
+ * True if a new decision can be started: the proposer is idle or, in multi-paxos,
+ * less than pipeline_window decisions are in flight.
+ */
+template<class PaxosListenerType> inline bool ProposerMH<PaxosListenerType>::canPropose()
+{
+	if (mPendingAcceptorMessageType == NULL_MESSAGE)
+	{
+		return true;
+	}
+	return mHasPromise && isLeader() && mNextDecisionId - MH::mDecisionId < MH::mPipelineWindow;
+}
+
+/**
+ * Multi-paxos: a leader or candidate steps down when another proposer runs a ballot
+ * at least as high as its own, instead of duelling with it slot after slot.
+ * Returns true if this proposer switched to standby.
+ */
+template<class PaxosListenerType> inline bool ProposerMH<PaxosListenerType>::yield(const PaxosMessage& message)
+{
+	if (MH::mMultiPaxos && !isStandby() && message.mSenderId != MH::mId && message.mProposal >= mLastProposedNumber)
+	{
+		if (MH::mTrace) PAXOS_DEBUG("YIELDING TO {} PROPOSAL#{}") << message.mSenderId << message.mProposal;
+		standby();
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Queues an application command for the next batch, its content is taken (swapped with an empty string).
+ * proposedUs is kept for the propose to consensus latency. Returns false if the command can not fit in a batch.
+ */
+template<class PaxosListenerType> inline bool ProposerMH<PaxosListenerType>::enqueue(string& command, uint64_t proposedUs)
+{
+	size_t size = ValueBatch::encodedSize(command);
+	if (MH::mId.size() + 1 + size > mBatchMaxBytes)
+	{
+		PAXOS_WARN("Command of {} bytes exceeds batch_max_bytes={} => command is rejected.") << command.size() << mBatchMaxBytes;
+		return false;
+	}
+	mPendingCommands.push_back(string());
+	mPendingCommands.back().swap(command);
+	mPendingTimes.push_back(proposedUs);
+	mPendingBytes += size;
+	return true;
+}
+
+/**
+ * The decisions in flight were not chosen: their commands go back in front of the queue.
+ * They are proposed again in a new ballot, never with other values in this one.
+ */
+template<class PaxosListenerType> inline void ProposerMH<PaxosListenerType>::abortBatches()
+{
+	mHasPromise = false;
+	for (uint32_t decisionId = MH::mDecisionId; decisionId != mNextDecisionId; decisionId++)
+	{
+		Slot& slot = getSlot(decisionId);
+		slot.mInFlight = false;
+		slot.mBatchCount = 0;
+	}
+	for (size_t i = 0; i < mInFlightCount; i++)
+	{
+		mPendingBytes += ValueBatch::encodedSize(mPendingCommands[i]);
+	}
+	mInFlightCount = 0;
+	mNextDecisionId = MH::mDecisionId;
+	mPromotedValue = ValueBatch::noop(MH::mId);
+}
+
+template<class PaxosListenerType> inline void ProposerMH<PaxosListenerType>::dropCommands()
+{
+	if (!mPendingCommands.empty())
+	{
+		PAXOS_WARN("{} is no longer leader => {} proposed command(s) are dropped.") << MH::mId << mPendingCommands.size();
+		MH::count(METRIC_DROPPED_COMMANDS, mPendingCommands.size());
+	}
+	abortBatches();
+	mPendingCommands.clear();
+	mPendingTimes.clear();
+	mPendingBytes = 0;
+}
+
 template<class PaxosListenerType> inline bool ProposerMH<PaxosListenerType>::hasReachedQuorumMajority()
 {
-	bool reachedQuorum = (mAcceptorsPositive.size() == mQuorumMajority);////exact count (first hit) to avoid multiples send accept
+	bool reachedQuorum = (mAcceptorsPositive.count() == MH::mQuorum.getMajority());////exact count (first hit) to avoid multiples send accept
 	//if (reachedQuorum) cout << "REACHED PROMISE QUORUM" << endl;
 	return reachedQuorum;
 }
 
 template<class PaxosListenerType> inline bool ProposerMH<PaxosListenerType>::belowQuorumMajority()
 {
-	return mAcceptorsPositive.size() < mQuorumMajority;
+	return mAcceptorsPositive.count() < MH::mQuorum.getMajority();
 }
 
+/**
+ * True if decision mDecisionId reached the learn quorum. Decisions are learned in order,
+ * a decision further in the pipeline waits in its slot until the previous ones are done.
+ */
 template<class PaxosListenerType> inline bool ProposerMH<PaxosListenerType>::hasLearnQuorum ()
 {
-		StringSetMap::iterator i;
+		Slot& slot = getSlot(MH::mDecisionId);
+		const Vote* vote = getDecidedVote(slot);//the slot is cleared once notified
 		mCurrLeader = "";
-		for ( i = mLearnedValues.begin(); i != mLearnedValues.end(); i++ )
+		if (vote != NULL)
 		{
-			if (i->second.size() == mQuorumMajority) //only notify once
-			{
-				mCurrLeader = i->first;
-				ListOfUniqueStrings::iterator primary = i->second.find(mCurrLeader + PAXOS_ACCEPTOR_ID);
-				break;
+			mDecidedValue = vote->mProposed ? &slot.mProposedValue : &vote->mValue;
+			if (MH::mValueReferences && !vote->mProposed && mValueCache != NULL)
+			{//not learned until the accept request is received
+				mDecidedValue = mValueCache->get(vote->mDigest);
+				if (mDecidedValue == NULL) return false;
 			}
+			mDecidedDigest = vote->mDigest;
+			mCurrLeader = ValueBatch::leaderOf(*mDecidedValue);
 		}
-
 		return (!mCurrLeader.empty());
 }
 
 template<class PaxosListenerType> inline bool ProposerMH<PaxosListenerType>::belowLearnQuorum ()
 {
-	bool isBelow = true;
-		StringSetMap::iterator i;
-		mCurrLeader = "";
-		for ( i = mLearnedValues.begin(); i != mLearnedValues.end(); i++ )
+		return getDecidedVote(getSlot(MH::mDecisionId)) == NULL;
+}
+
+/**
+ * Vote of the slot accepted by a majority of the quorum, NULL if none.
+ */
+template<class PaxosListenerType> inline const typename ProposerMH<PaxosListenerType>::Vote* ProposerMH<PaxosListenerType>::getDecidedVote(Slot& slot)
+{
+	for (size_t i = 0; i < slot.mVoteCount; i++)
+	{
+		if (slot.mVotes[i].mAcceptors.count() >= MH::mQuorum.getMajority())
 		{
-			if (i->second.size() >= mQuorumMajority) //only notify once
-			{
-				isBelow = false;
-			}
+			return &slot.mVotes[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * The digest is not collision resistant: a value carried by the reply must also match the proposed
+ * one. With value references the reply carries the ballot instead, a ballot being promised to one
+ * proposer only, the value of this proposer was accepted if it is its current ballot.
+ */
+template<class PaxosListenerType> inline bool ProposerMH<PaxosListenerType>::isProposedValue(const Slot& slot, uint64_t digest, const PaxosMessage& message)
+{
+	if (digest != slot.mProposedDigest) return false;
+	return MH::mValueReferences ? message.mProposal == mLastProposedNumber : message.mValue == slot.mProposedValue;
+}
+
+template<class PaxosListenerType> inline bool ProposerMH<PaxosListenerType>::isVoteFor(const Slot& slot, const Vote& vote, uint64_t digest, const PaxosMessage& message)
+{
+	if (vote.mDigest != digest) return false;
+	if (MH::mValueReferences) return vote.mProposed == isProposedValue(slot, digest, message);
+	return message.mValue == (vote.mProposed ? slot.mProposedValue : vote.mValue);
+}
+
+/**
+ * The slot is about to propose another value: the votes for the previous one get their own copy.
+ */
+template<class PaxosListenerType> inline void ProposerMH<PaxosListenerType>::detachVotes(Slot& slot)
+{
+	for (size_t i = 0; i < slot.mVoteCount; i++)
+	{
+		if (slot.mVotes[i].mProposed)
+		{
+			slot.mVotes[i].mValue = slot.mProposedValue;
+			slot.mVotes[i].mProposed = false;
 		}
-		return isBelow;
+	}
 }
 
 template<class PaxosListenerType> inline void ProposerMH<PaxosListenerType>::doEndOfCycle()
 		{
-			if (MH::mTrace) cout << "PROCESSING END OF CYCLE#"  << MH::mDecisionId << endl;
+			if (MH::mTrace) PAXOS_DEBUG("PROCESSING END OF CYCLE#{}") << MH::mDecisionId;
+			Slot& slot = getSlot(MH::mDecisionId);
+			mDecidedTimes.clear();
+			if (isDecidedAsProposed(slot))
+			{//the batch is decided
+				mPendingCommands.erase(mPendingCommands.begin(), mPendingCommands.begin() + slot.mBatchCount);
+				mDecidedTimes.assign(mPendingTimes.begin(), mPendingTimes.begin() + slot.mBatchCount);
+				mPendingTimes.erase(mPendingTimes.begin(), mPendingTimes.begin() + slot.mBatchCount);
+				mInFlightCount -= slot.mBatchCount;
+			}
+			else
+			{
+				if (slot.mInFlight) abortBatches();
+				if (mCurrLeader == MH::mId) eraseOwnCommands(*mDecidedValue);
+			}
+			clearVotes(slot);
+			slot.mBatchCount = 0;
+			slot.mInFlight = false;
 			MH::mDecisionId++;
+			if (mNextDecisionId < MH::mDecisionId) mNextDecisionId = MH::mDecisionId;
 			mAcceptedValue = ACCEPTED_VALUE_INIT;
 			clearVote();
-			mLearnedValues.clear();
 			mCurrLeader = "";
-			mLastProposedNumber = 0;
-			mPendingAcceptorMessageType = NULL_MESSAGE;
+			if (!MH::mMultiPaxos)
+			{//the multi-paxos ballot is kept for the next decision
+				mLastProposedNumber = 0;
+			}
+			mPendingAcceptorMessageType = hasInFlightDecisions() ? ACCEPTED_VALUE : NULL_MESSAGE;
 
 }
 
@@ -249,9 +738,19 @@ template<class PaxosListenerType> void ProposerMH<PaxosListenerType>::init(paxos
 {
 	MH::init(listener);
 	mLastProposedNumber=0;
-	mPromotedValue = MH::mId;
+	mPromotedValue = ValueBatch::noop(MH::mId);
 	mAcceptedValue = ACCEPTED_VALUE_INIT;
+	mDecidedValue = &mPromotedValue;
+	mDecidedDigest = 0;
 	mState = INITIAL;
+	mHasPromise = false;
+	mSlots.assign(MH::mPipelineWindow, Slot());
+	mNextDecisionId = MH::mDecisionId;
+	mResentDecisionId = NO_DECISION;
+	mPendingCommands.clear();
+	mPendingTimes.clear();
+	mPendingBytes = 0;
+	mInFlightCount = 0;
 	mPendingAcceptorMessageType = NULL_MESSAGE;
 	cout << "\t" << MH::mId << " is initiallized" << endl;
 }
@@ -261,19 +760,17 @@ template<class PaxosListenerType> void ProposerMH<PaxosListenerType>::configure(
 	try
 	{
 		PaxosMH<PaxosListenerType>::configure(cf);
-		BOOST_FOREACH(property_tree::ptree::value_type const& v, cf.get_child(XML_QUORUM))
-		{
-			//mQuorumSet.insert(v.second.get("<xmlattr>.id", ""));
-			string value = v.second.get("<xmlattr>.id", "");
-			if (value.size() > 0) mQuorumSet.insert(value);
-		}
-		cout << "\tQuorum: " << mQuorumSet.size() << " acceptors [ " ;
-		BOOST_FOREACH(string const& v, mQuorumSet)
+		cf.get_child(XML_QUORUM);//mandatory for a proposer, interned by PaxosMH::configure()
+		cout << "\tQuorum: " << MH::mQuorum.size() << " acceptors [ " ;
+		BOOST_FOREACH(string const& v, MH::mQuorum.getIds())
 		{
 			cout << v << " ";
 		}
-		mQuorumMajority = (int)(mQuorumSet.size() / 2) + 1;
-		cout << "] - Majority=" << mQuorumMajority << endl;
+		cout << "] - Majority=" << MH::mQuorum.getMajority() << endl;
+		mBatchMaxBytes = cf.get<uint32_t>(XML_PROPOSER_BATCH_MAX_BYTES, 768);
+		mBatchMaxCount = cf.get<uint32_t>(XML_PROPOSER_BATCH_MAX_COUNT, 64);
+		mBatchLingerMs = cf.get<int>(XML_PROPOSER_BATCH_LINGER_MS, 5);
+		cout << "\tBatch: max_bytes=" << mBatchMaxBytes << " max_count=" << mBatchMaxCount << " linger_ms=" << mBatchLingerMs << endl;
 		mPromotedValue = cf.get<std::string>(XML_PROPOSER_START_STATE);
 		cout << "\t" << MH::mId << " starting mode=" << mPromotedValue << endl;
 		if (mPromotedValue == "PRIMARY") mStartState = LEAD_PRIMARY;
@@ -288,24 +785,60 @@ template<class PaxosListenerType> void ProposerMH<PaxosListenerType>::configure(
 
 template<class PaxosListenerType> inline void ProposerMH<PaxosListenerType>::clearVote()
 {
-	mAcceptorsPositive.clear();
+	mAcceptorsPositive.reset();
+}
+
+template<class PaxosListenerType> inline typename ProposerMH<PaxosListenerType>::Slot& ProposerMH<PaxosListenerType>::getSlot(uint32_t decisionId)
+{
+	Slot& slot = mSlots[decisionId % mSlots.size()];
+	if (slot.mDecisionId != decisionId)
+	{//recycled: the previous decision of this slot is out of the window
+		slot.mDecisionId = decisionId;
+		clearVotes(slot);
+		clearAdoption(slot);
+		slot.mBatchCount = 0;
+		slot.mInFlight = false;
+	}
+	return slot;
 }
 
 template<class PaxosListenerType> inline void ProposerMH<PaxosListenerType>::reset ( uint32_t peerId )
 {
-	if (MH::mTrace) cout << "RESET DECISION_ID FROM "  << MH::mDecisionId << " TO " << peerId << endl;
+	if (MH::mTrace) PAXOS_DEBUG("RESET DECISION_ID FROM {} TO {}") << MH::mDecisionId << peerId;
+	abortBatches();
 	mAcceptedValue = ACCEPTED_VALUE_INIT;
-	mLearnedValues.clear();
+	for (size_t i = 0; i < mSlots.size(); i++)
+	{
+		clearVotes(mSlots[i]);
+	}
 	mCurrLeader = "";
 	MH::mDecisionId = peerId;
+	mNextDecisionId = peerId;
 };
 
 template<class PaxosListenerType> void ProposerMH<PaxosListenerType>::synchronize(uint32_t decisionId, uint32_t proposalId)
 {
-	MH::mDecisionId = decisionId;
+	if (decisionId != MH::mDecisionId)
+	{
+		reset(decisionId);
+	}
 	mLastProposedNumber = proposalId;
 }
 
+/**
+ * Follows the ballot of the leader's accept requests. The decision id only moves
+ * when the request is out of the pipeline window, so that the decisions in flight
+ * are still learned.
+ */
+template<class PaxosListenerType> void ProposerMH<PaxosListenerType>::follow(const PaxosMessage& request)
+{
+	if (request.mDecisionId >= MH::mDecisionId + MH::mPipelineWindow)
+	{
+		reset(request.mDecisionId + 1 - MH::mPipelineWindow);
+	}
+	mLastProposedNumber = request.mProposal;
+}
+
 template<class PaxosListenerType> void ProposerMH<PaxosListenerType>::handleStateTransition(ProposerState newState)
 {
 	if (mState != newState)
@@ -0,0 +1,346 @@
+/*
+ * Logger.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <string>
+#include <algorithm>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include "concurrent/MpscRing.hpp"
+
+/**
+ * Statements below this level are compiled out, e.g. -DPAXOS_LOG_LEVEL=2 keeps warnings and errors only.
+ */
+#ifndef PAXOS_LOG_LEVEL
+#define PAXOS_LOG_LEVEL 0
+#endif
+
+/**
+ * Logs format with its {} replaced by the arguments streamed after the macro, e.g.
+ * PAXOS_WARN("Message#{} is dropped.") << decisionId; The format must be a string literal.
+ * The arguments are not evaluated if the level is disabled.
+ */
+#define PAXOS_LOG(level, format) \
+	((level) < PAXOS_LOG_LEVEL || !paxos::Logger::isEnabled(level)) ? (void) 0 : paxos::LogVoidify() & paxos::LogStatement((level), "" format)
+
+#define PAXOS_DEBUG(format)	PAXOS_LOG(paxos::LOG_DEBUG, format)
+#define PAXOS_INFO(format)	PAXOS_LOG(paxos::LOG_INFO, format)
+#define PAXOS_WARN(format)	PAXOS_LOG(paxos::LOG_WARN, format)
+#define PAXOS_ERROR(format)	PAXOS_LOG(paxos::LOG_ERROR, format)
+
+namespace paxos
+{
+
+	enum LogLevel
+	{
+		LOG_DEBUG = 0,
+		LOG_INFO,
+		LOG_WARN,
+		LOG_ERROR
+	};
+
+	/**
+	 * Log statement with its arguments in binary: numbers as is, strings copied (truncated
+	 * past TEXT_SIZE bytes in all). Formatted by the logger thread.
+	 */
+	struct LogRecord
+	{
+		static const size_t MAX_ARGS = 8;
+		static const size_t TEXT_SIZE = 160;
+
+		enum ArgType
+		{
+			ARG_SIGNED = 0,
+			ARG_UNSIGNED,
+			ARG_DOUBLE,
+			ARG_CHAR,
+			ARG_STRING // mValues holds offset << 16 | size in mText
+		};
+
+		const char*		mFormat;
+		uint64_t		mTimeUs;
+		uint8_t			mLevel;
+		uint8_t			mArgCount;
+		uint16_t		mTextSize;
+		uint8_t			mTypes[MAX_ARGS];
+		uint64_t		mValues[MAX_ARGS];
+		char			mText[TEXT_SIZE];
+	};
+
+	/**
+	 * Writes the log records from any thread without blocking: they are queued in a
+	 * lock-free ring (see MpscRing) and formatted by a background thread. DEBUG and INFO go to stdout, WARN and ERROR to stderr. A record
+	 * is dropped if the ring is full, the number dropped is logged afterwards.
+	 */
+	class Logger
+	{
+	public:
+		static const size_t CAPACITY = 4096;//records, power of 2
+		static constexpr long IDLE_SLEEP_MS = 5;
+
+		static Logger& instance()
+		{
+			static Logger logger;
+			return logger;
+		}
+
+		static bool isEnabled(LogLevel level)
+		{
+			return level >= getLevelRef().load(boost::memory_order_relaxed);
+		}
+
+		/**
+		 * Runtime level, on top of PAXOS_LOG_LEVEL.
+		 */
+		static void setLevel(LogLevel level)
+		{
+			getLevelRef().store(level, boost::memory_order_relaxed);
+		}
+
+		void push(const LogRecord& record)
+		{
+			size_t position;
+			LogRecord* queued = mRing.claim(position, false);
+			if (queued == NULL)
+			{
+				mDropped.fetch_add(1, boost::memory_order_relaxed);
+				return;//full
+			}
+			memcpy(queued, &record, offsetof(LogRecord, mText) + record.mTextSize);
+			mRing.publish(position);
+		}
+
+		/**
+		 * Waits until the records queued so far are written.
+		 */
+		void flush()
+		{
+			size_t target = mRing.getEnqueuePosition();
+			while (mWritten.load(boost::memory_order_acquire) < target)
+			{
+				boost::this_thread::sleep(boost::posix_time::millisec(1));
+			}
+		}
+
+		~Logger()
+		{
+			mStopped.store(true, boost::memory_order_release);
+			mThread.join();
+		}
+
+	private:
+		MpscRing<LogRecord>			mRing;//consumed by the logger thread
+		boost::atomic<size_t>		mWritten;
+		boost::atomic<uint64_t>		mDropped;
+		uint64_t					mDroppedReported;
+		boost::atomic<bool>			mStopped;
+		std::string					mLine;
+		boost::thread				mThread;
+
+		Logger() : mDroppedReported(0)
+		{
+			mRing.configure(CAPACITY);
+			mWritten.store(0, boost::memory_order_relaxed);
+			mDropped.store(0, boost::memory_order_relaxed);
+			mStopped.store(false, boost::memory_order_relaxed);
+			mThread = boost::thread(boost::bind(&Logger::run, this));
+		}
+
+		static boost::atomic<int>& getLevelRef()
+		{
+			static boost::atomic<int> level(LOG_DEBUG);
+			return level;
+		}
+
+		void run()
+		{
+			for (;;)
+			{
+				bool stopped = mStopped.load(boost::memory_order_acquire);
+				if (drain() == 0)
+				{
+					if (stopped) return;
+					boost::this_thread::sleep(boost::posix_time::millisec(IDLE_SLEEP_MS));
+				}
+			}
+		}
+
+		/**
+		 * Writes the queued records, returns their number.
+		 */
+		size_t drain()
+		{
+			size_t count = 0;
+			bool wroteOut = false;
+			bool wroteErr = false;
+			LogRecord* record;
+			while ((record = mRing.peek()) != NULL)
+			{
+				format(*record);
+				FILE* out = record->mLevel >= LOG_WARN ? stderr : stdout;
+				(out == stderr ? wroteErr : wroteOut) = true;
+				mRing.pop();
+				fwrite(mLine.data(), 1, mLine.size(), out);
+				count++;
+			}
+			uint64_t dropped = mDropped.load(boost::memory_order_relaxed);
+			if (dropped != mDroppedReported)
+			{
+				fprintf(stderr, "%llu log record(s) are dropped: the log ring is full.\n", (unsigned long long) (dropped - mDroppedReported));
+				mDroppedReported = dropped;
+				wroteErr = true;
+			}
+			if (wroteOut) fflush(stdout);
+			if (wroteErr) fflush(stderr);
+			mWritten.store(mRing.getDequeuePosition(), boost::memory_order_release);
+			return count;
+		}
+
+		void format(const LogRecord& record)
+		{
+			static const char* LEVELS[] = {"DEBUG", "INFO ", "WARN ", "ERROR"};
+			char buffer[64];
+			time_t seconds = (time_t) (record.mTimeUs / 1000000);
+			struct tm local;
+			localtime_r(&seconds, &local);
+			size_t length = strftime(buffer, sizeof(buffer), "%H:%M:%S", &local);
+			snprintf(buffer + length, sizeof(buffer) - length, ".%06u %s ", (unsigned) (record.mTimeUs % 1000000), LEVELS[record.mLevel & 3]);
+			mLine.assign(buffer);
+			size_t arg = 0;
+			for (const char* c = record.mFormat; *c != '\0'; c++)
+			{
+				if (c[0] != '{' || c[1] != '}' || arg == record.mArgCount)
+				{
+					mLine += *c;
+					continue;
+				}
+				c++;
+				uint64_t value = record.mValues[arg];
+				switch (record.mTypes[arg++])
+				{
+					case LogRecord::ARG_SIGNED:
+						snprintf(buffer, sizeof(buffer), "%lld", (long long) value);
+						mLine += buffer;
+						break;
+					case LogRecord::ARG_UNSIGNED:
+						snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long) value);
+						mLine += buffer;
+						break;
+					case LogRecord::ARG_DOUBLE:
+					{
+						double number;
+						memcpy(&number, &value, sizeof(number));
+						snprintf(buffer, sizeof(buffer), "%g", number);
+						mLine += buffer;
+						break;
+					}
+					case LogRecord::ARG_CHAR:
+						mLine += (char) value;
+						break;
+					default:
+						mLine.append(record.mText + (value >> 16), value & 0xFFFF);
+						break;
+				}
+			}
+			mLine += '\n';
+		}
+	};
+
+	/**
+	 * Collects the arguments of a PAXOS_LOG statement and queues the record at the end of the statement.
+	 */
+	class LogStatement
+	{
+	public:
+		LogStatement(LogLevel level, const char* format)
+		{
+			struct timeval tp;
+			gettimeofday(&tp, NULL);
+			mRecord.mFormat = format;
+			mRecord.mTimeUs = (uint64_t) tp.tv_sec * 1000000 + tp.tv_usec;
+			mRecord.mLevel = level;
+			mRecord.mArgCount = 0;
+			mRecord.mTextSize = 0;
+		}
+
+		~LogStatement()
+		{
+			Logger::instance().push(mRecord);
+		}
+
+		LogStatement& operator<<(int value) { return add(LogRecord::ARG_SIGNED, (uint64_t) (int64_t) value); }
+		LogStatement& operator<<(long value) { return add(LogRecord::ARG_SIGNED, (uint64_t) (int64_t) value); }
+		LogStatement& operator<<(long long value) { return add(LogRecord::ARG_SIGNED, (uint64_t) value); }
+		LogStatement& operator<<(short value) { return add(LogRecord::ARG_SIGNED, (uint64_t) (int64_t) value); }
+		LogStatement& operator<<(unsigned short value) { return add(LogRecord::ARG_UNSIGNED, value); }
+		LogStatement& operator<<(unsigned char value) { return add(LogRecord::ARG_UNSIGNED, value); }
+		LogStatement& operator<<(unsigned int value) { return add(LogRecord::ARG_UNSIGNED, value); }
+		LogStatement& operator<<(unsigned long value) { return add(LogRecord::ARG_UNSIGNED, value); }
+		LogStatement& operator<<(unsigned long long value) { return add(LogRecord::ARG_UNSIGNED, value); }
+		LogStatement& operator<<(bool value) { return add(LogRecord::ARG_UNSIGNED, value ? 1 : 0); }
+		LogStatement& operator<<(char value) { return add(LogRecord::ARG_CHAR, (uint8_t) value); }
+
+		LogStatement& operator<<(double value)
+		{
+			uint64_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			return add(LogRecord::ARG_DOUBLE, bits);
+		}
+
+		LogStatement& operator<<(const char* value)
+		{
+			return addText(value, strlen(value));
+		}
+
+		LogStatement& operator<<(const std::string& value)
+		{
+			return addText(value.data(), value.size());
+		}
+
+	private:
+		LogRecord	mRecord;
+
+		LogStatement& add(LogRecord::ArgType type, uint64_t value)
+		{
+			if (mRecord.mArgCount < LogRecord::MAX_ARGS)
+			{
+				mRecord.mTypes[mRecord.mArgCount] = type;
+				mRecord.mValues[mRecord.mArgCount++] = value;
+			}
+			return *this;
+		}
+
+		LogStatement& addText(const char* data, size_t size)
+		{
+			size_t offset = mRecord.mTextSize;
+			size = std::min(size, LogRecord::TEXT_SIZE - offset);
+			memcpy(mRecord.mText + offset, data, size);
+			mRecord.mTextSize += size;
+			return add(LogRecord::ARG_STRING, (uint64_t) offset << 16 | size);
+		}
+	};
+
+	/**
+	 * Turns a PAXOS_LOG statement into a void expression: & binds after the <<.
+	 */
+	struct LogVoidify
+	{
+		void operator&(const LogStatement&) {}
+	};
+
+}
+
+#endif /* LOGGER_H_ */
@@ -0,0 +1,122 @@
+/*
+ * LatencyHistogram.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+#include <stdint.h>
+#include <vector>
+
+namespace paxos
+{
+
+	/**
+	 * HDR-style histogram of latencies (e.g. in microseconds) with a relative error below 1/128:
+	 * values < 128 have their own bucket, then each power of 2 range is split in 128 buckets.
+	 * Recording is a few instructions and never allocates; percentiles return the highest
+	 * value of the bucket reached, so they are never under-estimated.
+	 */
+	class LatencyHistogram
+	{
+	public:
+		static const int SUB_BUCKET_BITS = 7;
+		static const uint64_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+		static const size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+		LatencyHistogram() : mCounts(BUCKET_COUNT, 0), mTotal(0), mSum(0), mMax(0) {}
+
+		void record(uint64_t value)
+		{
+			mCounts[indexOf(value)]++;
+			mTotal++;
+			mSum += value;
+			if (value > mMax) mMax = value;
+		}
+
+		void merge(const LatencyHistogram& other)
+		{
+			for (size_t i = 0; i < BUCKET_COUNT; i++)
+			{
+				mCounts[i] += other.mCounts[i];
+			}
+			mTotal += other.mTotal;
+			mSum += other.mSum;
+			if (other.mMax > mMax) mMax = other.mMax;
+		}
+
+		/**
+		 * Adds count values to the bucket index, e.g. copied from another histogram. addSum then
+		 * adds the sum and max of these values.
+		 */
+		void addCount(size_t index, uint64_t count)
+		{
+			mCounts[index] += count;
+			mTotal += count;
+		}
+
+		void addSum(uint64_t sum, uint64_t max)
+		{
+			mSum += sum;
+			if (max > mMax) mMax = max;
+		}
+
+		void reset()
+		{
+			mCounts.assign(BUCKET_COUNT, 0);
+			mTotal = 0;
+			mSum = 0;
+			mMax = 0;
+		}
+
+		uint64_t getCount() const { return mTotal; }
+		uint64_t getMax() const { return mMax; }
+		uint64_t getSum() const { return mSum; }
+		double getMean() const { return mTotal == 0 ? 0 : (double) mSum / mTotal; }
+
+		/**
+		 * Value below which percentile % of the recorded values are (e.g. 99.9), 0 if none.
+		 */
+		uint64_t getPercentile(double percentile) const
+		{
+			if (mTotal == 0) return 0;
+			uint64_t rank = (uint64_t) (percentile / 100.0 * mTotal + 0.5);
+			if (rank == 0) rank = 1;
+			if (rank > mTotal) rank = mTotal;
+			uint64_t seen = 0;
+			for (size_t i = 0; i < BUCKET_COUNT; i++)
+			{
+				seen += mCounts[i];
+				if (seen >= rank) return highestValueOf(i) < mMax ? highestValueOf(i) : mMax;
+			}
+			return mMax;
+		}
+
+		static size_t indexOf(uint64_t value)
+		{
+			if (value < SUB_BUCKET_COUNT) return (size_t) value;
+			int shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+			return (size_t) ((shift + 1) * SUB_BUCKET_COUNT + (value >> shift) - SUB_BUCKET_COUNT);
+		}
+
+		static uint64_t highestValueOf(size_t index)
+		{
+			if (index < SUB_BUCKET_COUNT) return index;
+			int shift = (int) (index / SUB_BUCKET_COUNT) - 1;
+			uint64_t lowest = ((uint64_t) (index % SUB_BUCKET_COUNT) + SUB_BUCKET_COUNT) << shift;
+			return lowest + ((uint64_t) 1 << shift) - 1;
+		}
+
+	private:
+		std::vector<uint64_t>	mCounts;
+		uint64_t				mTotal;
+		uint64_t				mSum;
+		uint64_t				mMax;
+	};
+
+}
+
+#endif /* LATENCYHISTOGRAM_H_ */
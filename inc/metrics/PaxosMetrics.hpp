@@ -0,0 +1,216 @@
+/*
+ * PaxosMetrics.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef PAXOSMETRICS_H_
+#define PAXOSMETRICS_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+#include "protocole/message.hpp"
+#include "metrics/LatencyHistogram.hpp"
+
+namespace paxos
+{
+
+	enum MetricCounter
+	{
+		METRIC_DROPPED_MESSAGES = 0, // malformed, out of date or not sent
+		METRIC_REJECTS, // reject replies received by the proposer
+		METRIC_PHASE_TIMEOUTS,
+		METRIC_LEADER_CHANGES, // leader of a delivered decision differs from the previous one
+		METRIC_PROPOSED_COMMANDS,
+		METRIC_DECIDED_COMMANDS, // proposed by this node
+		METRIC_DROPPED_COMMANDS, // proposed by this node, dropped when it lost the leadership
+		METRIC_REJECTED_COMMANDS, // submitted while this node was not the leader, or too large
+		METRIC_RESENT_ACCEPTS, // accept requests sent again before the phase timeout, see PaxosLH::resendOverdueAccepts
+		METRIC_COUNTER_COUNT
+	};
+
+	enum MetricLatency
+	{
+		METRIC_PREPARE_TO_PROMISE = 0, // prepare request sent -> promise quorum reached
+		METRIC_ACCEPT_TO_LEARN, // accept request sent -> learn quorum reached, per decision
+		METRIC_PROPOSE_TO_CONSENSUS, // PaxosService::propose -> onConsensus on this node, per command
+		METRIC_LATENCY_COUNT
+	};
+
+	inline const char* getMetricName(MetricCounter counter)
+	{
+		static const char* NAMES[] = {"dropped_messages", "rejects", "phase_timeouts", "leader_changes", "proposed_commands", "decided_commands", "dropped_commands", "rejected_commands", "resent_accepts"};
+		return NAMES[counter];
+	}
+
+	inline const char* getMetricName(MetricLatency latency)
+	{
+		static const char* NAMES[] = {"prepare_to_promise_us", "accept_to_learn_us", "propose_to_consensus_us"};
+		return NAMES[latency];
+	}
+
+	/**
+	 * Copy of the metrics of a line handler at some point in time, see PaxosMetrics::snapshot.
+	 */
+	class MetricsSnapshot
+	{
+	public:
+		MetricsSnapshot() : mCounters(METRIC_COUNTER_COUNT, 0), mReceived(LAST_MSG_ID + 1, 0), mSent(LAST_MSG_ID + 1, 0), mLatencies(METRIC_LATENCY_COUNT) {}
+
+		uint64_t getCounter(MetricCounter counter) const { return mCounters[counter]; }
+		uint64_t getReceived(MsgId msgId) const { return mReceived[msgId]; }
+		uint64_t getSent(MsgId msgId) const { return mSent[msgId]; }
+		const LatencyHistogram& getLatency(MetricLatency latency) const { return mLatencies[latency]; }
+
+		/**
+		 * Writes the metrics in the Prometheus text format, each name prefixed with prefix (e.g. "paxos_").
+		 */
+		void write(std::ostream& out, const std::string& prefix) const
+		{
+			for (int counter = 0; counter < METRIC_COUNTER_COUNT; counter++)
+			{
+				out << prefix << getMetricName((MetricCounter) counter) << "_total " << mCounters[counter] << "\n";
+			}
+			for (int msgId = PREPARE_REQUEST; msgId <= LAST_MSG_ID; msgId++)
+			{
+				out << prefix << "messages_received_total{type=\"" << getMsgName((MsgId) msgId) << "\"} " << mReceived[msgId] << "\n";
+				out << prefix << "messages_sent_total{type=\"" << getMsgName((MsgId) msgId) << "\"} " << mSent[msgId] << "\n";
+			}
+			static const double QUANTILES[] = {50, 90, 99, 99.9};
+			for (int latency = 0; latency < METRIC_LATENCY_COUNT; latency++)
+			{
+				const LatencyHistogram& histogram = mLatencies[latency];
+				std::string name = prefix + getMetricName((MetricLatency) latency);
+				for (size_t i = 0; i < sizeof(QUANTILES) / sizeof(QUANTILES[0]); i++)
+				{
+					out << name << "{quantile=\"" << QUANTILES[i] / 100 << "\"} " << histogram.getPercentile(QUANTILES[i]) << "\n";
+				}
+				out << name << "_max " << histogram.getMax() << "\n";
+				out << name << "_sum " << histogram.getSum() << "\n";
+				out << name << "_count " << histogram.getCount() << "\n";
+			}
+		}
+
+	private:
+		friend class PaxosMetrics;
+
+		std::vector<uint64_t>			mCounters;
+		std::vector<uint64_t>			mReceived;//by message id
+		std::vector<uint64_t>			mSent;
+		std::vector<LatencyHistogram>	mLatencies;
+	};
+
+	/**
+	 * Counters and latency histograms of a line handler. They are updated by the thread running
+	 * the line handler only: a relaxed load and store, no locked instruction. snapshot() may be
+	 * called from any thread, it sees each value as of some recent point in time.
+	 */
+	class PaxosMetrics
+	{
+	public:
+		PaxosMetrics()
+		{
+			for (int counter = 0; counter < METRIC_COUNTER_COUNT; counter++) mCounters[counter] = 0;
+			for (int msgId = 0; msgId <= LAST_MSG_ID; msgId++)
+			{
+				mReceived[msgId] = 0;
+				mSent[msgId] = 0;
+			}
+		}
+
+		void increment(MetricCounter counter, uint64_t count = 1)
+		{
+			add(mCounters[counter], count);
+		}
+
+		void countReceived(MsgId msgId)
+		{
+			add(mReceived[msgId], 1);
+		}
+
+		void countSent(MsgId msgId)
+		{
+			add(mSent[msgId], 1);
+		}
+
+		void record(MetricLatency latency, uint64_t us)
+		{
+			mLatencies[latency].record(us);
+		}
+
+		void snapshot(MetricsSnapshot& snapshot) const
+		{
+			for (int counter = 0; counter < METRIC_COUNTER_COUNT; counter++)
+			{
+				snapshot.mCounters[counter] = mCounters[counter].load(boost::memory_order_relaxed);
+			}
+			for (int msgId = 0; msgId <= LAST_MSG_ID; msgId++)
+			{
+				snapshot.mReceived[msgId] = mReceived[msgId].load(boost::memory_order_relaxed);
+				snapshot.mSent[msgId] = mSent[msgId].load(boost::memory_order_relaxed);
+			}
+			for (int latency = 0; latency < METRIC_LATENCY_COUNT; latency++)
+			{
+				mLatencies[latency].snapshot(snapshot.mLatencies[latency]);
+			}
+		}
+
+	private:
+		typedef boost::atomic<uint64_t>	counter_t;
+
+		/**
+		 * LatencyHistogram with relaxed atomic buckets, same single writer.
+		 */
+		class AtomicHistogram
+		{
+		public:
+			AtomicHistogram() : mCounts(new counter_t[LatencyHistogram::BUCKET_COUNT])
+			{
+				for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; i++) mCounts[i] = 0;
+				mSum = 0;
+				mMax = 0;
+			}
+
+			void record(uint64_t value)
+			{
+				add(mCounts[LatencyHistogram::indexOf(value)], 1);
+				add(mSum, value);
+				if (value > mMax.load(boost::memory_order_relaxed)) mMax.store(value, boost::memory_order_relaxed);
+			}
+
+			void snapshot(LatencyHistogram& histogram) const
+			{
+				histogram.reset();
+				for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; i++)
+				{
+					uint64_t count = mCounts[i].load(boost::memory_order_relaxed);
+					if (count != 0) histogram.addCount(i, count);
+				}
+				histogram.addSum(mSum.load(boost::memory_order_relaxed), mMax.load(boost::memory_order_relaxed));
+			}
+
+		private:
+			boost::scoped_array<counter_t>	mCounts;
+			counter_t						mSum;
+			counter_t						mMax;
+		};
+
+		counter_t			mCounters[METRIC_COUNTER_COUNT];
+		counter_t			mReceived[LAST_MSG_ID + 1];//by message id
+		counter_t			mSent[LAST_MSG_ID + 1];
+		AtomicHistogram		mLatencies[METRIC_LATENCY_COUNT];
+
+		static void add(counter_t& counter, uint64_t count)
+		{
+			counter.store(counter.load(boost::memory_order_relaxed) + count, boost::memory_order_relaxed);
+		}
+	};
+
+}
+
+#endif /* PAXOSMETRICS_H_ */
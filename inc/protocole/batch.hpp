@@ -0,0 +1,104 @@
+/*
+ * batch.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <stdint.h>
+#include <string>
+#include <deque>
+#include "protocole/bytes.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Value agreed on by a decision: the id of the proposer which promoted it, a kind
+	 * and, for a batch, the application commands:
+	 *
+	 *   leaderId '\0' kind ( u32 little-endian length, command bytes )*
+	 *
+	 * kind is NOOP for the values of heartbeats and promotions, which carry no command
+	 * and are not delivered to the application. A plain leader id is read as a no-op.
+	 */
+	class ValueBatch
+	{
+	public:
+		static const char SEPARATOR = '\0';
+		static const char COMMANDS = 'C';
+		static const char NOOP = 'N';
+
+		/**
+		 * Number of bytes a command adds to an encoded batch.
+		 */
+		static size_t encodedSize(const std::string& command)
+		{
+			return 4 + command.size();
+		}
+
+		/**
+		 * Encodes leaderId and the count commands starting at first into value, a no-op if count is 0.
+		 */
+		static void encode(std::string& value, const std::string& leaderId, const std::deque<std::string>& commands, size_t first, size_t count)
+		{
+			value = leaderId;
+			value += SEPARATOR;
+			value += count == 0 ? NOOP : COMMANDS;
+			for (size_t i = first; i < first + count; i++)
+			{
+				char length[4];
+				LittleEndian::put32(length, commands[i].size());
+				value.append(length, 4);
+				value.append(commands[i]);
+			}
+		}
+
+		static std::string leaderOf(const std::string& value)
+		{
+			return value.substr(0, value.find(SEPARATOR));
+		}
+
+		/**
+		 * Encodes the no-op value of leaderId, proposed by its heartbeats and promotions.
+		 */
+		static std::string noop(const std::string& leaderId)
+		{
+			std::string value(leaderId);
+			value += SEPARATOR;
+			value += NOOP;
+			return value;
+		}
+
+		static bool isNoop(const std::string& value)
+		{
+			size_t separator = value.find(SEPARATOR);
+			return separator == std::string::npos || separator + 1 == value.size() || value[separator + 1] != COMMANDS;
+		}
+
+		/**
+		 * Iterates over the commands of value, starting with offset = 0.
+		 * Returns false when there are no more (or malformed) commands.
+		 */
+		static bool next(const std::string& value, size_t& offset, const char*& data, uint32_t& size)
+		{
+			if (offset == 0)
+			{
+				if (isNoop(value)) return false;
+				offset = value.find(SEPARATOR) + 2;
+			}
+			if (offset + 4 > value.size()) return false;
+			size = LittleEndian::get32(value.data() + offset);
+			if (offset + 4 + size > value.size()) return false;
+			data = value.data() + offset + 4;
+			offset += 4 + size;
+			return true;
+		}
+	};
+
+}
+
+#endif /* BATCH_H_ */
@@ -0,0 +1,79 @@
+/*
+ * bytes.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#ifndef BYTES_H_
+#define BYTES_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace paxos
+{
+
+	/**
+	 * Little-endian integers of the wire formats and of the files, at any alignment.
+	 */
+	class LittleEndian
+	{
+	public:
+		static void put16(void* out, uint16_t v)
+		{
+			uint8_t* u = (uint8_t*) out;
+			u[0] = (uint8_t) v;
+			u[1] = (uint8_t) (v >> 8);
+		}
+
+		static void put32(void* out, uint32_t v)
+		{
+			uint8_t* u = (uint8_t*) out;
+			for (int i = 0; i < 4; i++) u[i] = (uint8_t) (v >> (8 * i));
+		}
+
+		static void put64(void* out, uint64_t v)
+		{
+			put32(out, (uint32_t) v);
+			put32((uint8_t*) out + 4, (uint32_t) (v >> 32));
+		}
+
+		static uint16_t get16(const void* in)
+		{
+			const uint8_t* u = (const uint8_t*) in;
+			return (uint16_t) (u[0] | (u[1] << 8));
+		}
+
+		static uint32_t get32(const void* in)
+		{
+			const uint8_t* u = (const uint8_t*) in;
+			return (uint32_t) u[0] | ((uint32_t) u[1] << 8) | ((uint32_t) u[2] << 16) | ((uint32_t) u[3] << 24);
+		}
+
+		static uint64_t get64(const void* in)
+		{
+			return (uint64_t) get32(in) | ((uint64_t) get32((const uint8_t*) in + 4) << 32);
+		}
+	};
+
+	/**
+	 * 32-bit FNV-1a checksum of the records and snapshots stored on disk, to detect torn writes.
+	 */
+	class Fnv1a
+	{
+	public:
+		static uint32_t of(const char* data, size_t size)
+		{
+			uint32_t hash = 2166136261u;
+			for (size_t i = 0; i < size; i++)
+			{
+				hash = (hash ^ (uint8_t) data[i]) * 16777619u;
+			}
+			return hash;
+		}
+	};
+
+}
+
+#endif /* BYTES_H_ */
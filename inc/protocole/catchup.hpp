@@ -0,0 +1,64 @@
+/*
+ * catchup.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef CATCHUP_H_
+#define CATCHUP_H_
+
+#include <stdint.h>
+#include <string>
+#include "protocole/bytes.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Value of a CATCHUP_CHUNK message: decided values of consecutive decisions,
+	 *
+	 *   ( u32 little-endian decision id, u32 little-endian size, value bytes )*
+	 *
+	 * The CATCHUP_REQUEST message asks for the decisions [mDecisionId, mProposal), its value
+	 * names the node which should answer (any node holding the range if empty).
+	 * The mProposal of a chunk is the lowest decision its sender still holds. To a request sent to
+	 * any node, a node behind the range answers with an empty chunk whose mDecisionId is its next
+	 * decision to deliver.
+	 * A node which no longer holds the start of the range sends its latest snapshot in a
+	 * CATCHUP_SNAPSHOT message before the chunks: its mDecisionId is the decision the snapshot was
+	 * taken at, its mProposal the lowest decision the sender still holds, its value the state.
+	 */
+	class CatchUpChunk
+	{
+	public:
+		static const size_t ENTRY_HEADER_SIZE = 8;
+
+		static void append(std::string& chunk, uint32_t decisionId, const char* data, uint32_t size)
+		{
+			char header[ENTRY_HEADER_SIZE];
+			LittleEndian::put32(header, decisionId);
+			LittleEndian::put32(header + 4, size);
+			chunk.append(header, ENTRY_HEADER_SIZE);
+			chunk.append(data, size);
+		}
+
+		/**
+		 * Iterates over the decisions of chunk, starting with offset = 0.
+		 * Returns false when there are no more (or malformed) entries.
+		 */
+		static bool next(const std::string& chunk, size_t& offset, uint32_t& decisionId, const char*& data, uint32_t& size)
+		{
+			if (offset + ENTRY_HEADER_SIZE > chunk.size()) return false;
+			decisionId = LittleEndian::get32(chunk.data() + offset);
+			size = LittleEndian::get32(chunk.data() + offset + 4);
+			if (offset + ENTRY_HEADER_SIZE + size > chunk.size()) return false;
+			data = chunk.data() + offset + ENTRY_HEADER_SIZE;
+			offset += ENTRY_HEADER_SIZE + size;
+			return true;
+		}
+	};
+
+}
+
+#endif /* CATCHUP_H_ */
@@ -0,0 +1,127 @@
+/*
+ * codec.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef CODEC_H_
+#define CODEC_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <stdexcept>
+#include "protocole/bytes.hpp"
+#include "protocole/message.hpp"
+
+namespace paxos
+{
+
+	enum WireFormat
+	{
+		WIRE_TEXT = 0,
+		WIRE_BINARY
+	};
+
+	/**
+	 * Binary encoding of a PaxosMessage. All integers are little-endian:
+	 *
+	 *   0  u16 magic           4  u32 decision id     12 u16 sender index     20 u64 value digest
+	 *   2  u8  version         8  u32 proposal        14 u16 sender length
+	 *   3  u8  msg id                                 16 u32 value length
+	 *  28  sender bytes, then value bytes
+	 *
+	 * The sender index is its quorum index (see protocole/quorum.hpp) or NO_NODE_INDEX,
+	 * the sender name is always carried. The digest is the one of protocole/digest.hpp or 0,
+	 * the text format does not carry it. Receivers accept both encodings whatever the
+	 * configured wire format is, so a cluster can be switched from text to binary node by node.
+	 */
+	class MessageCodec
+	{
+	public:
+		static const uint16_t MAGIC = 0x50A5;
+		static const uint8_t  VERSION = 2;
+		static const size_t   HEADER_SIZE = 28;
+
+		MessageCodec() : mFormat(WIRE_TEXT) {}
+
+		void setFormat(WireFormat format) { mFormat = format; }
+		WireFormat getFormat() const { return mFormat; }
+
+		static WireFormat parseFormat(const std::string& name)
+		{
+			if (name == "binary") return WIRE_BINARY;
+			if (name == "text") return WIRE_TEXT;
+			throw std::runtime_error("Unknown wire_format " + name);
+		}
+
+		/**
+		 * Buffer size large enough to encode a message in either format.
+		 */
+		static size_t getCapacity(const std::string& sender, const std::string& value)
+		{
+			return HEADER_SIZE + 64 + sender.size() + value.size();//the text header of the numbers fits in 64 bytes
+		}
+
+		/**
+		 * Encodes the message into buffer with the configured format.
+		 * Returns the number of bytes written or 0 if the buffer is too small.
+		 */
+		size_t encode(char* buffer, size_t capacity, const uint32_t decision, const MsgId msgId, const std::string& sender, const uint32_t proposal, const std::string& value, const uint16_t senderIndex = NO_NODE_INDEX, const uint64_t digest = 0) const
+		{
+			if (mFormat == WIRE_TEXT)
+			{
+				return PaxosMessage::format(buffer, capacity, decision, msgId, sender, proposal, value);
+			}
+			size_t size = HEADER_SIZE + sender.size() + value.size();
+			if (size > capacity || sender.size() > 0xFFFF) return 0;
+			uint8_t* out = (uint8_t*) buffer;
+			LittleEndian::put16(out, MAGIC);
+			out[2] = VERSION;
+			out[3] = (uint8_t) msgId;
+			LittleEndian::put32(out + 4, decision);
+			LittleEndian::put32(out + 8, proposal);
+			LittleEndian::put16(out + 12, senderIndex);
+			LittleEndian::put16(out + 14, (uint16_t) sender.size());
+			LittleEndian::put32(out + 16, (uint32_t) value.size());
+			LittleEndian::put64(out + 20, digest);
+			memcpy(out + HEADER_SIZE, sender.data(), sender.size());
+			memcpy(out + HEADER_SIZE + sender.size(), value.data(), value.size());
+			return size;
+		}
+
+		/**
+		 * Decodes either encoding into message. The message strings are re-assigned,
+		 * so a reused message does not allocate once its capacity is reached.
+		 * Returns false if the datagram is malformed.
+		 */
+		static bool decode(const char* buffer, size_t size, PaxosMessage& message)
+		{
+			const uint8_t* in = (const uint8_t*) buffer;
+			if (size < 2 || LittleEndian::get16(in) != MAGIC)
+			{
+				return message.parse(buffer, size);
+			}
+			message.mMsgId = NULL_MESSAGE;
+			if (size < HEADER_SIZE || in[2] != VERSION || in[3] > LAST_MSG_ID) return false;
+			size_t senderSize = LittleEndian::get16(in + 14);
+			size_t valueSize = LittleEndian::get32(in + 16);
+			if (HEADER_SIZE + senderSize + valueSize != size) return false;
+			message.mDecisionId = LittleEndian::get32(in + 4);
+			message.mProposal = LittleEndian::get32(in + 8);
+			message.mSenderIndex = LittleEndian::get16(in + 12);
+			message.mDigest = LittleEndian::get64(in + 20);
+			message.mSenderId.assign(buffer + HEADER_SIZE, senderSize);
+			message.mValue.assign(buffer + HEADER_SIZE + senderSize, valueSize);
+			message.mMsgId = (MsgId) in[3];
+			return true;
+		}
+
+	private:
+		WireFormat mFormat;
+	};
+
+}
+
+#endif /* CODEC_H_ */
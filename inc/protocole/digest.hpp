@@ -0,0 +1,84 @@
+/*
+ * digest.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef DIGEST_H_
+#define DIGEST_H_
+
+#include <stdint.h>
+#include <string>
+#include "protocole/message.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * 64-bit content digest of a proposed value (MurmurHash64A, 8 bytes per step). The proposer
+	 * computes it once per value and carries it in PaxosMessage::mDigest, the acceptors and
+	 * proposers compare and tally the values of a decision by digest first.
+	 * It is not collision resistant (fixed seed, crafted values may share a digest): the content
+	 * is still compared wherever it is carried, see also ValueCache.
+	 * A digest is never 0, which stands for "not carried" (e.g. text wire format).
+	 */
+	class ValueDigest
+	{
+	public:
+		static uint64_t of(const char* data, size_t size)
+		{
+			const uint64_t m = 0xc6a4a7935bd1e995ULL;
+			const int r = 47;
+			uint64_t h = 0x9747b28c5f1d2e3bULL ^ (size * m);
+			const char* end = data + (size & ~(size_t) 7);
+			for (const char* p = data; p != end; p += 8)
+			{
+				uint64_t k = load(p, 8);
+				k *= m;
+				k ^= k >> r;
+				k *= m;
+				h ^= k;
+				h *= m;
+			}
+			size_t tail = size & 7;
+			if (tail != 0)
+			{
+				h ^= load(end, tail);
+				h *= m;
+			}
+			h ^= h >> r;
+			h *= m;
+			h ^= h >> r;
+			return h != 0 ? h : 1;
+		}
+
+		static uint64_t of(const std::string& value)
+		{
+			return of(value.data(), value.size());
+		}
+
+		/**
+		 * Digest of the value of message: the carried one, else computed.
+		 */
+		static uint64_t get(const PaxosMessage& message)
+		{
+			return message.mDigest != 0 ? message.mDigest : of(message.mValue);
+		}
+
+	private:
+		/**
+		 * Little-endian load of size <= 8 bytes, so that all the nodes compute the same digest.
+		 */
+		static uint64_t load(const char* data, size_t size)
+		{
+			const uint8_t* in = (const uint8_t*) data;
+			uint64_t v = 0;
+			for (size_t i = 0; i < size; i++) v |= (uint64_t) in[i] << (8 * i);
+			return v;
+		}
+	};
+
+}
+
+#endif /* DIGEST_H_ */
@@ -0,0 +1,122 @@
+/*
+ * fragment.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef FRAGMENT_H_
+#define FRAGMENT_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <algorithm>
+#include "protocole/bytes.hpp"
+#include "protocole/message.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Datagram carrying a part of an encoded message too large for one datagram. All integers
+	 * are little-endian:
+	 *
+	 *   0  u16 magic           4  u32 sequence        12 u32 fragment index   20 u16 sender length
+	 *   2  u8  version         8  u32 message size    16 u32 fragment count   22 u16 0
+	 *   3  u8  msg id
+	 *  24  sender bytes, then the fragment bytes
+	 *
+	 * The message is split in fragment count parts of the same size (the last one excepted),
+	 * fragment i holds the bytes from i * ceil(message size / fragment count). The sequence numbers
+	 * the messages of the sending node, the msg id is the one of the message (it routes the fragments).
+	 */
+	class MessageFragment
+	{
+	public:
+		static const uint16_t MAGIC = 0x46A5;
+		static const uint8_t  VERSION = 1;
+		static const size_t   HEADER_SIZE = 24;
+
+		uint32_t		mSequence;
+		uint32_t		mMessageSize;
+		uint32_t		mIndex;
+		uint32_t		mCount;
+		const char*		mSender;
+		size_t			mSenderSize;
+		const char*		mData;
+		size_t			mSize;
+
+		/**
+		 * Number of datagrams of datagramSize bytes needed for a message of messageSize bytes, 0 if
+		 * the sender name leaves no room.
+		 */
+		static uint32_t getCount(size_t messageSize, size_t datagramSize, const std::string& sender)
+		{
+			if (HEADER_SIZE + sender.size() >= datagramSize || sender.size() > 0xFFFF) return 0;
+			size_t capacity = datagramSize - HEADER_SIZE - sender.size();
+			return (uint32_t) ((messageSize + capacity - 1) / capacity);
+		}
+
+		/**
+		 * Encodes fragment index of count of message into buffer (of at least the datagram size
+		 * count was computed for). Returns the number of bytes written.
+		 */
+		static size_t encode(char* buffer, MsgId msgId, const std::string& sender, uint32_t sequence, const char* message, uint32_t messageSize, uint32_t index, uint32_t count)
+		{
+			uint32_t fragmentSize = getFragmentSize(messageSize, count);
+			uint32_t offset = index * fragmentSize;
+			uint32_t size = std::min(fragmentSize, messageSize - offset);
+			uint8_t* out = (uint8_t*) buffer;
+			LittleEndian::put16(out, MAGIC);
+			out[2] = VERSION;
+			out[3] = (uint8_t) msgId;
+			LittleEndian::put32(out + 4, sequence);
+			LittleEndian::put32(out + 8, messageSize);
+			LittleEndian::put32(out + 12, index);
+			LittleEndian::put32(out + 16, count);
+			LittleEndian::put16(out + 20, (uint16_t) sender.size());
+			LittleEndian::put16(out + 22, 0);
+			memcpy(out + HEADER_SIZE, sender.data(), sender.size());
+			memcpy(out + HEADER_SIZE + sender.size(), message + offset, size);
+			return HEADER_SIZE + sender.size() + size;
+		}
+
+		static bool isFragment(const char* data, size_t size)
+		{
+			return size >= 2 && LittleEndian::get16(data) == MAGIC;
+		}
+
+		/**
+		 * Reads the header of a fragment, the pointers refer to data. Returns false if it is malformed.
+		 */
+		bool decode(const char* data, size_t size)
+		{
+			const uint8_t* in = (const uint8_t*) data;
+			if (size < HEADER_SIZE || LittleEndian::get16(in) != MAGIC || in[2] != VERSION) return false;
+			mSequence = LittleEndian::get32(in + 4);
+			mMessageSize = LittleEndian::get32(in + 8);
+			mIndex = LittleEndian::get32(in + 12);
+			mCount = LittleEndian::get32(in + 16);
+			mSenderSize = LittleEndian::get16(in + 20);
+			if (mCount == 0 || mIndex >= mCount || mCount > mMessageSize || HEADER_SIZE + mSenderSize > size) return false;
+			mSender = data + HEADER_SIZE;
+			mData = mSender + mSenderSize;
+			mSize = size - HEADER_SIZE - mSenderSize;
+			uint64_t fragmentSize = getFragmentSize(mMessageSize, mCount);
+			uint64_t offset = mIndex * fragmentSize;
+			return offset < mMessageSize && mSize == std::min<uint64_t>(fragmentSize, mMessageSize - offset);
+		}
+
+		uint32_t getOffset() const { return mIndex * getFragmentSize(mMessageSize, mCount); }
+
+	private:
+		static uint32_t getFragmentSize(uint32_t messageSize, uint32_t count)
+		{
+			return (uint32_t) (((uint64_t) messageSize + count - 1) / count);
+		}
+	};
+
+}
+
+#endif /* FRAGMENT_H_ */
@@ -1,100 +1,138 @@
 /*
- * PaxosMH.h
+ * message.hpp
  *
  *  Created on: Apr 15, 2016
  *      Author: gll
  */
 
-#ifndef PAXOSMH_H_
-#define PAXOSMH_H_
+#ifndef MESSAGE_H_
+#define MESSAGE_H_
 
-#include <boost/shared_ptr.hpp>
-#include "configuration/Configurator.h"
-
-using namespace std;
-using namespace boost;
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <iostream>
 
 namespace paxos
 {
 
-#define PAXOS_PROPOSER_ID   "-proposer"
-#define PAXOS_ACCEPTOR_ID   "-acceptor"
-
-template<class PaxosListenerType> class PaxosMH
-{
-	typedef boost::shared_ptr<PaxosListenerType> paxos_listener_ptr_t;
-
-public:
-	PaxosMH() : mDecisionId(0), mTrace(false) {};
-	virtual ~PaxosMH(){};
-
-	virtual string getXmlConfigurationTag() = 0;
-
-	virtual void init(paxos_listener_ptr_t listener);
-	virtual void configure(const property_tree::ptree& configuration);
-	string getId() const;
-	void logInbound(const PaxosMessage& message);
-
+	const std::string ACCEPTED_VALUE_INIT = "-";
+	const uint16_t NO_NODE_INDEX = 0xFFFF; // sender out of the quorum or index not carried (text format)
 
-protected:
-	string					mId;
-	uint32_t				mDecisionId;
-	paxos_listener_ptr_t 	mListener;
-	bool					mTrace;
-
-
-	virtual void reset(uint32_t peerId ) = 0;
+	enum MsgId
+	{
+		NULL_MESSAGE = 0,
+		PREPARE_REQUEST,
+		PROMISE_REPLY,
+		ACCEPT_REQUEST,
+		ACCEPTED_VALUE,
+		CONSENSUS_NOTIFICATION,
+		REJECT_REPLY,
+		CATCHUP_REQUEST,
+		CATCHUP_CHUNK,
+		PROMISED_VALUE, // see protocole/promise.hpp
+		CATCHUP_SNAPSHOT // see protocole/catchup.hpp
+	};
+
+	const MsgId LAST_MSG_ID = CATCHUP_SNAPSHOT;
+
+	const uint32_t NO_DECISION = 0xFFFFFFFF;
+
+	inline const char* getMsgName(MsgId msgId)
+	{
+		static const char* NAMES[] = {"NULL_MESSAGE", "PREPARE_REQUEST", "PROMISE_REPLY", "ACCEPT_REQUEST", "ACCEPTED_VALUE",
+				"CONSENSUS_NOTIFICATION", "REJECT_REPLY", "CATCHUP_REQUEST", "CATCHUP_CHUNK", "PROMISED_VALUE", "CATCHUP_SNAPSHOT"};
+		return msgId <= LAST_MSG_ID ? NAMES[msgId] : "UNKNOWN";
+	}
 
-	bool isSenderBehind(const PaxosMessage& message, uint32_t proposalId)
+	enum ProposerState
 	{
-		if (message.mDecisionId < mDecisionId)
-		{
-			return true;
-		}
-		if ( message.mDecisionId > mDecisionId )
+		INITIAL = 0,
+		LEAD_CANDIDATE,
+		LEAD_PRIMARY,
+		LEAD_STANDBY
+	};
+
+	/**
+	 * Paxos message exchanged between proposers, acceptors and learners.
+	 * The text representation is "decision,msgId,sender,proposal,value\n"
+	 * (see protocole/codec.hpp for the binary one).
+	 */
+	class PaxosMessage
+	{
+	public:
+		uint32_t		mDecisionId;
+		MsgId			mMsgId;
+		std::string		mSenderId;
+		uint16_t		mSenderIndex; // see protocole/quorum.hpp
+		uint32_t		mProposal;
+		std::string		mValue;
+		uint64_t		mDigest; // of mValue, 0 if not carried (see protocole/digest.hpp)
+
+		PaxosMessage() { init(); }
+
+		void init()
 		{
-			reset (message.mDecisionId);
+			mDecisionId = 0;
+			mMsgId = NULL_MESSAGE;
+			mSenderId.clear();
+			mSenderIndex = NO_NODE_INDEX;
+			mProposal = 0;
+			mValue.clear();
+			mDigest = 0;
 		}
-		else if (message.mProposal < proposalId)
+
+		/**
+		 * Parses the text representation. The value is everything after the 4th comma
+		 * up to the trailing new line, so it may itself contain commas.
+		 * Returns false (and leaves mMsgId to NULL_MESSAGE) if the buffer is malformed.
+		 */
+		bool parse(const char* buffer, size_t size)
 		{
-			cerr << "\tProposalId is behind: Expected >= " << proposalId << " => message is dropped." << endl;
+			init();
+			const char* end = buffer + size;
+			const char* fields[4];
+			const char* cursor = buffer;
+			for (int i = 0; i < 4; i++)
+			{
+				fields[i] = cursor;
+				cursor = (const char*) memchr(cursor, ',', end - cursor);
+				if (cursor == NULL) return false;
+				cursor++;
+			}
+			if (end > cursor && *(end - 1) == '\n') end--;
+			mDecisionId = strtoul(fields[0], NULL, 10);
+			uint32_t msgId = strtoul(fields[1], NULL, 10);
+			mSenderId.assign(fields[2], fields[3] - fields[2] - 1);
+			mProposal = strtoul(fields[3], NULL, 10);
+			mValue.assign(cursor, end - cursor);
+			if (msgId > LAST_MSG_ID) return false;
+			mMsgId = (MsgId) msgId;
 			return true;
 		}
-		return false;
-	}
 
-};
-
-template<class PaxosListenerType> void PaxosMH<PaxosListenerType>::init(paxos_listener_ptr_t listener)
-{
-	mDecisionId = 0;
-	mListener = listener;
-	mListener->onStateChange(mId,INITIAL);
-}
-
-template<class PaxosListenerType> void PaxosMH<PaxosListenerType>::configure(const property_tree::ptree& configuration)
- {
-   		try
-   		{
-   			mId = configuration.get<std::string>(getXmlConfigurationTag());
-   			cout << "\t" << mId << " is configured" << endl;
-   		}
-   		catch (std::exception& e)
-   		{
-   			std::string xmlError = e.what();
-   			throw std::runtime_error("In configuration " + xmlError);
-   		}
-}
+		/**
+		 * Writes the text representation into buffer.
+		 * Returns the number of bytes written or 0 if the buffer is too small.
+		 */
+		static size_t format(char* buffer, size_t capacity, const uint32_t decision, const MsgId msgId, const std::string& sender, const uint32_t proposal, const std::string& value)
+		{
+			int len = snprintf(buffer, capacity, "%u,%u,%s,%u,", decision, (uint32_t) msgId, sender.c_str(), proposal);
+			if (len < 0 || len + value.size() + 1 > capacity) return 0;
+			memcpy(buffer + len, value.data(), value.size());
+			len += value.size();
+			buffer[len++] = '\n';
+			return len;
+		}
+	};
 
-template<class PaxosListenerType> inline string  PaxosMH<PaxosListenerType>::getId() const
+	inline std::ostream& operator<<(std::ostream& os, const PaxosMessage& message)
 	{
-		return mId;
+		return os << message.mDecisionId << "," << (uint32_t) message.mMsgId << "," << message.mSenderId << "," << message.mProposal << "," << message.mValue;
 	}
 
-template<class PaxosListenerType> inline void PaxosMH<PaxosListenerType>::logInbound(const PaxosMessage& message)
-	{
-	 if (mTrace)	std::cout << "INBOUND [" << mId << "] = " <<  message << std::endl;
-	}
 }
 
-#endif /* PAXOSMH_H_ */
+#endif /* MESSAGE_H_ */
@@ -0,0 +1,97 @@
+/*
+ * promise.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef PROMISE_H_
+#define PROMISE_H_
+
+#include <stdint.h>
+#include <string>
+#include "protocole/bytes.hpp"
+#include "protocole/message.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Multi-paxos phase 1: an acceptor promising a ballot reports the values it accepted for the
+	 * decisions of the pipeline window. The value of its PROMISE_REPLY lists these decisions and
+	 * each accepted value follows in a PROMISED_VALUE message for its decision, so that it fits
+	 * in a datagram. Both name the proposer promised, since ballot numbers are not unique:
+	 *
+	 *   PROMISE_REPLY:  proposer id, '\0', u32 little-endian decision ids
+	 *   PROMISED_VALUE: proposer id, '\0', u32 little-endian accepted proposal, value bytes
+	 *
+	 * The proposer counts the promise once all the listed values are received, then proposes
+	 * again the value of the highest accepted proposal of each decision.
+	 */
+	class PromisedValues
+	{
+	public:
+		static void startList(std::string& list, const std::string& proposerId)
+		{
+			list.assign(proposerId);
+			list.push_back('\0');
+		}
+
+		static void appendDecision(std::string& list, uint32_t decisionId)
+		{
+			char entry[4];
+			LittleEndian::put32(entry, decisionId);
+			list.append(entry, 4);
+		}
+
+		/**
+		 * Offset of the first decision of list, 0 if it is not a promise to proposerId.
+		 */
+		static size_t findDecisions(const std::string& list, const std::string& proposerId)
+		{
+			return isFor(list, proposerId) ? proposerId.size() + 1 : 0;
+		}
+
+		/**
+		 * Iterates over the decisions of list, starting at the offset given by findDecisions().
+		 */
+		static bool nextDecision(const std::string& list, size_t& offset, uint32_t& decisionId)
+		{
+			if (offset == 0 || offset + 4 > list.size()) return false;
+			decisionId = LittleEndian::get32(list.data() + offset);
+			offset += 4;
+			return true;
+		}
+
+		static void encodeValue(std::string& out, const std::string& proposerId, uint32_t acceptedProposal, const std::string& value)
+		{
+			char header[4];
+			LittleEndian::put32(header, acceptedProposal);
+			startList(out, proposerId);
+			out.append(header, 4);
+			out.append(value);
+		}
+
+		/**
+		 * Returns false if in is not a value promised to proposerId.
+		 */
+		static bool decodeValue(const std::string& in, const std::string& proposerId, uint32_t& acceptedProposal, const char*& data, uint32_t& size)
+		{
+			size_t offset = proposerId.size() + 1;
+			if (!isFor(in, proposerId) || in.size() < offset + 4) return false;
+			acceptedProposal = LittleEndian::get32(in.data() + offset);
+			data = in.data() + offset + 4;
+			size = in.size() - offset - 4;
+			return true;
+		}
+
+	private:
+		static bool isFor(const std::string& value, const std::string& proposerId)
+		{
+			return value.size() > proposerId.size() && value.compare(0, proposerId.size(), proposerId) == 0 && value[proposerId.size()] == '\0';
+		}
+	};
+
+}
+
+#endif /* PROMISE_H_ */
@@ -0,0 +1,90 @@
+/*
+ * quorum.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef QUORUM_H_
+#define QUORUM_H_
+
+#include <stdint.h>
+#include <bitset>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "protocole/message.hpp"
+
+namespace paxos
+{
+
+	const size_t MAX_QUORUM_SIZE = 64;
+
+	/**
+	 * Set of acceptors, one bit per quorum index.
+	 */
+	typedef std::bitset<MAX_QUORUM_SIZE> QuorumMask;
+
+	/**
+	 * Acceptor ids of the <quorum> interned into dense indices.
+	 *
+	 * The indices follow the sorted ids, so every node configured with the same quorum
+	 * agrees on them whatever the order of the XML list. Binary messages carry the index
+	 * of their sender, text messages are resolved by name.
+	 */
+	class Quorum
+	{
+	public:
+		Quorum() : mMajority(0) {}
+
+		void assign(const std::set<std::string>& ids)
+		{
+			if (ids.size() > MAX_QUORUM_SIZE)
+			{
+				throw std::runtime_error("quorum holds more than 64 acceptors");
+			}
+			mIds.assign(ids.begin(), ids.end());
+			mIndexes.clear();
+			for (size_t i = 0; i < mIds.size(); i++)
+			{
+				mIndexes[mIds[i]] = i;
+			}
+			mMajority = mIds.size() / 2 + 1;
+		}
+
+		size_t size() const { return mIds.size(); }
+		uint32_t getMajority() const { return mMajority; }
+		const std::vector<std::string>& getIds() const { return mIds; }
+
+		/**
+		 * Index of id, NO_NODE_INDEX if it is not in the quorum.
+		 */
+		uint16_t indexOf(const std::string& id) const
+		{
+			std::map<std::string, uint16_t>::const_iterator i = mIndexes.find(id);
+			return i == mIndexes.end() ? NO_NODE_INDEX : i->second;
+		}
+
+		/**
+		 * Index of the sender of message: the one carried on the wire, or looked up by name.
+		 */
+		uint16_t indexOf(const PaxosMessage& message) const
+		{
+			if (message.mSenderIndex < mIds.size())
+			{
+				return message.mSenderIndex;
+			}
+			return indexOf(message.mSenderId);
+		}
+
+	private:
+		std::vector<std::string>			mIds;
+		std::map<std::string, uint16_t>		mIndexes;
+		uint32_t							mMajority;
+	};
+
+}
+
+#endif /* QUORUM_H_ */
@@ -0,0 +1,238 @@
+/*
+ * AcceptorLog.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef ACCEPTORLOG_H_
+#define ACCEPTORLOG_H_
+
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "logging/Logger.hpp"
+#include "protocole/bytes.hpp"
+
+namespace paxos
+{
+
+	enum AcceptorLogRecordType
+	{
+		LOG_PROMISE = 1,
+		LOG_ACCEPT
+	};
+
+	struct AcceptorLogRecord
+	{
+		AcceptorLogRecordType	mType;
+		uint32_t				mDecisionId;
+		uint32_t				mProposal;
+		std::string				mData; // promised proposer id or accepted value
+	};
+
+	/**
+	 * Write-ahead log of the acceptor promises and accepted values.
+	 *
+	 * Records are buffered by append*() and written with a single write + fdatasync by commit(),
+	 * so all the replies produced while handling a batch of messages share one sync (group commit).
+	 * Replies must only be sent once commit() succeeded.
+	 *
+	 * Record layout (little-endian): u32 payload size, u32 FNV-1a checksum of the payload, then
+	 * the payload: u8 type, u32 decision id, u32 proposal, u32 data size, data bytes.
+	 * A torn or corrupted tail is truncated when the log is opened.
+	 *
+	 * Once the file exceeds max_bytes, the owner re-appends its live state after startCompaction()
+	 * and the next commit() atomically replaces the file, which bounds the recovery time.
+	 */
+	class AcceptorLog
+	{
+	public:
+		static const size_t RECORD_HEADER_SIZE = 8;
+		static const size_t PAYLOAD_HEADER_SIZE = 13;
+
+		AcceptorLog() : mFd(-1), mFileSize(0), mMaxBytes(16 << 20), mCompacting(false), mCompactionRequested(false) {}
+		~AcceptorLog() { close(); }
+
+		bool isOpen() const { return mFd >= 0; }
+		bool hasPendingRecords() const { return !mBuffer.empty(); }
+		bool isCompactionDue() const { return isOpen() && !mCompacting && (mCompactionRequested || mFileSize > mMaxBytes); }
+		void setMaxBytes(size_t maxBytes) { mMaxBytes = maxBytes; }
+		void requestCompaction() { mCompactionRequested = true; }
+
+		/**
+		 * Opens (or creates) the log and returns its valid records in write order.
+		 */
+		void open(const std::string& path, std::vector<AcceptorLogRecord>& records)
+		{
+			mPath = path;
+			mFd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+			if (mFd < 0)
+			{
+				throw std::runtime_error("Can not open acceptor log " + path + ": " + strerror(errno));
+			}
+			std::vector<char> content;
+			char chunk[65536];
+			ssize_t size;
+			while ((size = ::read(mFd, chunk, sizeof(chunk))) > 0)
+			{
+				content.insert(content.end(), chunk, chunk + size);
+			}
+			size_t offset = 0;
+			AcceptorLogRecord record;
+			while (decode(content, offset, record))
+			{
+				records.push_back(record);
+			}
+			if (offset != content.size())
+			{
+				PAXOS_WARN("Acceptor log {}: truncating {} bytes of torn tail.") << path << content.size() - offset;
+				if (ftruncate(mFd, offset) != 0) throw std::runtime_error("Can not truncate acceptor log " + path);
+			}
+			mFileSize = offset;
+			lseek(mFd, mFileSize, SEEK_SET);
+		}
+
+		void close()
+		{
+			if (mFd >= 0) ::close(mFd);
+			mFd = -1;
+		}
+
+		void appendPromise(uint32_t decisionId, uint32_t proposal, const std::string& senderId)
+		{
+			append(LOG_PROMISE, decisionId, proposal, senderId);
+		}
+
+		void appendAccept(uint32_t decisionId, uint32_t proposal, const std::string& value)
+		{
+			append(LOG_ACCEPT, decisionId, proposal, value);
+		}
+
+		/**
+		 * The records appended from now on are the whole live state: the next commit() replaces the file.
+		 */
+		void startCompaction()
+		{
+			mBuffer.clear();
+			mCompacting = true;
+			mCompactionRequested = false;
+		}
+
+		/**
+		 * Makes the appended records durable. Returns false on I/O error: the pending replies must not be sent.
+		 */
+		bool commit()
+		{
+			if (mBuffer.empty() && !mCompacting) return true;
+			bool done = mCompacting ? rewrite() : writeAll(mFd, mBuffer) && fdatasync(mFd) == 0;
+			if (!done)
+			{
+				PAXOS_ERROR("Acceptor log {}: write failed {}") << mPath << strerror(errno);
+				if (ftruncate(mFd, mFileSize) != 0 || lseek(mFd, mFileSize, SEEK_SET) < 0)
+				{
+					PAXOS_ERROR("Acceptor log {}: can not drop the partial write.") << mPath;
+				}
+			}
+			else if (!mCompacting)
+			{
+				mFileSize += mBuffer.size();
+			}
+			mCompacting = false;
+			mBuffer.clear();
+			return done;
+		}
+
+	private:
+		int					mFd;
+		std::string			mPath;
+		size_t				mFileSize;
+		size_t				mMaxBytes;
+		bool				mCompacting;
+		bool				mCompactionRequested;
+		std::vector<char>	mBuffer;
+
+		void append(AcceptorLogRecordType type, uint32_t decisionId, uint32_t proposal, const std::string& data)
+		{
+			if (!isOpen()) return;
+			size_t start = mBuffer.size();
+			size_t payloadSize = PAYLOAD_HEADER_SIZE + data.size();
+			mBuffer.resize(start + RECORD_HEADER_SIZE + payloadSize);
+			char* payload = &mBuffer[start + RECORD_HEADER_SIZE];
+			payload[0] = (char) type;
+			LittleEndian::put32(payload + 1, decisionId);
+			LittleEndian::put32(payload + 5, proposal);
+			LittleEndian::put32(payload + 9, data.size());
+			memcpy(payload + PAYLOAD_HEADER_SIZE, data.data(), data.size());
+			LittleEndian::put32(&mBuffer[start], payloadSize);
+			LittleEndian::put32(&mBuffer[start + 4], Fnv1a::of(payload, payloadSize));
+		}
+
+		static bool decode(const std::vector<char>& content, size_t& offset, AcceptorLogRecord& record)
+		{
+			if (offset + RECORD_HEADER_SIZE + PAYLOAD_HEADER_SIZE > content.size()) return false;
+			const char* in = &content[offset];
+			uint32_t payloadSize = LittleEndian::get32(in);
+			if (payloadSize < PAYLOAD_HEADER_SIZE || offset + RECORD_HEADER_SIZE + payloadSize > content.size()) return false;
+			const char* payload = in + RECORD_HEADER_SIZE;
+			if (LittleEndian::get32(in + 4) != Fnv1a::of(payload, payloadSize)) return false;
+			if (LittleEndian::get32(payload + 9) != payloadSize - PAYLOAD_HEADER_SIZE) return false;
+			if (payload[0] != LOG_PROMISE && payload[0] != LOG_ACCEPT) return false;
+			record.mType = (AcceptorLogRecordType) payload[0];
+			record.mDecisionId = LittleEndian::get32(payload + 1);
+			record.mProposal = LittleEndian::get32(payload + 5);
+			record.mData.assign(payload + PAYLOAD_HEADER_SIZE, payloadSize - PAYLOAD_HEADER_SIZE);
+			offset += RECORD_HEADER_SIZE + payloadSize;
+			return true;
+		}
+
+		static bool writeAll(int fd, const std::vector<char>& buffer)
+		{
+			size_t written = 0;
+			while (written < buffer.size())
+			{
+				ssize_t size = ::write(fd, &buffer[written], buffer.size() - written);
+				if (size < 0 && errno == EINTR) continue;
+				if (size <= 0) return false;
+				written += size;
+			}
+			return true;
+		}
+
+		/**
+		 * Writes the compacted state to a temporary file and renames it over the log.
+		 */
+		bool rewrite()
+		{
+			std::string tmpPath = mPath + ".tmp";
+			int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (fd < 0) return false;
+			if (!writeAll(fd, mBuffer) || fsync(fd) != 0 || rename(tmpPath.c_str(), mPath.c_str()) != 0)
+			{
+				::close(fd);
+				return false;
+			}
+			::close(mFd);
+			mFd = fd;
+			mFileSize = mBuffer.size();
+			std::string dir = mPath.substr(0, mPath.find_last_of('/') + 1);
+			int dirFd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+			if (dirFd >= 0)
+			{//make the rename durable
+				fsync(dirFd);
+				::close(dirFd);
+			}
+			return true;
+		}
+	};
+
+}
+
+#endif /* ACCEPTORLOG_H_ */
@@ -0,0 +1,421 @@
+/*
+ * DecidedLog.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef DECIDEDLOG_H_
+#define DECIDEDLOG_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include <deque>
+#include <algorithm>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "logging/Logger.hpp"
+#include "protocole/bytes.hpp"
+#include "protocole/digest.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * A decided value as stored in the log: the data points into the mapped segment.
+	 */
+	struct DecidedValue
+	{
+		uint32_t		mDecisionId;
+		const char*		mData;
+		uint32_t		mSize;
+	};
+
+	/**
+	 * Append-only log of the decided values, split in memory-mapped segments.
+	 *
+	 * Segment n holds the decisions [n * decisions_per_segment, (n + 1) * decisions_per_segment):
+	 *  - <prefix>.<first decision>.idx: one 16-byte entry per decision (u64 data offset, u32 size,
+	 *    u32 checksum of the value, 0 if absent), so a decision is found with two divisions and no search.
+	 *  - <prefix>.<first decision>.dat: the values, appended in arrival order. The file is grown
+	 *    by doubling, which re-maps it.
+	 *
+	 * Read results point into the mappings: they are valid until the next append() or truncate().
+	 * Decisions which were never appended (e.g. missed notifications) are absent.
+	 *
+	 * sync(false) schedules the write back of the values and entries appended since the previous
+	 * call without waiting for it (MS_ASYNC), sync(true) waits until all of them are on disk.
+	 * The kernel writes the dirty pages back in no particular order, so after a crash an entry may
+	 * be on disk without its value. open() checks every entry against its checksum and drops the
+	 * torn ones, which are then caught up like missed decisions.
+	 */
+	class DecidedLog
+	{
+		/**
+		 * Values appended from mDataFrom and index entries [mFrom, mTo), none if mFrom >= mTo.
+		 */
+		struct Dirty
+		{
+			uint64_t		mDataFrom;
+			uint32_t		mFrom;
+			uint32_t		mTo;
+
+			bool isEmpty() const { return mFrom >= mTo; }
+
+			void add(uint32_t index)
+			{
+				mFrom = isEmpty() ? index : std::min(mFrom, index);
+				mTo = isEmpty() ? index + 1 : std::max(mTo, index + 1);
+			}
+
+			void clear(uint64_t dataSize)
+			{
+				mDataFrom = dataSize;
+				mFrom = mTo = 0;
+			}
+		};
+
+		struct Segment
+		{
+			uint32_t		mFirstDecisionId;
+			int				mIndexFd;
+			int				mDataFd;
+			char*			mIndex;
+			char*			mData;
+			uint64_t		mDataCapacity;
+			uint64_t		mDataSize;
+			Dirty			mUnscheduled;// appended since the last sync(false)
+			Dirty			mUnsynced;// appended since the last sync(true)
+		};
+
+	public:
+		static const size_t ENTRY_SIZE = 16;
+
+		DecidedLog() : mDecisionsPerSegment(65536), mSegmentBytes(16 << 20), mNextDecisionId(0) {}
+		~DecidedLog() { close(); }
+
+		bool isOpen() const { return !mPrefix.empty(); }
+
+		/**
+		 * First decision which may be stored (lower ones were truncated).
+		 */
+		uint32_t getFirstDecisionId() const { return mSegments.empty() ? mNextDecisionId : mSegments.front().mFirstDecisionId; }
+
+		/**
+		 * One past the highest decision stored.
+		 */
+		uint32_t getNextDecisionId() const { return mNextDecisionId; }
+
+		/**
+		 * Raises the next decision id to decisionId, e.g. the one of a snapshot taken at a segment
+		 * boundary which truncated all the segments: the lower decisions are then reported as truncated.
+		 */
+		void skipTo(uint32_t decisionId)
+		{
+			if (decisionId > mNextDecisionId) mNextDecisionId = decisionId;
+		}
+
+		/**
+		 * Maps the existing segments of <dir>/<name>.*.
+		 */
+		void open(const std::string& dir, const std::string& name, uint32_t decisionsPerSegment, uint64_t segmentBytes)
+		{
+			mPrefix = dir + "/" + name;
+			mDecisionsPerSegment = decisionsPerSegment;
+			mSegmentBytes = segmentBytes;
+			std::vector<uint32_t> firsts;
+			DIR* directory = opendir(dir.c_str());
+			if (directory == NULL) throw std::runtime_error("Can not open decided log directory " + dir + ": " + strerror(errno));
+			std::string pattern = name + ".";
+			struct dirent* entry;
+			while ((entry = readdir(directory)) != NULL)
+			{
+				std::string file = entry->d_name;
+				if (file.compare(0, pattern.size(), pattern) == 0 && file.size() > 4 && file.compare(file.size() - 4, 4, ".idx") == 0)
+				{
+					firsts.push_back(strtoul(file.c_str() + pattern.size(), NULL, 10));
+				}
+			}
+			closedir(directory);
+			std::sort(firsts.begin(), firsts.end());
+			for (size_t i = 0; i < firsts.size(); i++)
+			{
+				if (firsts[i] % mDecisionsPerSegment != 0 || (i > 0 && firsts[i] != firsts[i - 1] + mDecisionsPerSegment))
+				{
+					throw std::runtime_error("Decided log " + mPrefix + ": segments do not match decisions_per_segment or are not contiguous");
+				}
+				mSegments.push_back(mapSegment(firsts[i]));
+			}
+			recoverTail();
+		}
+
+		void close()
+		{
+			while (!mSegments.empty())
+			{
+				unmapSegment(mSegments.front());
+				mSegments.pop_front();
+			}
+		}
+
+		/**
+		 * Stores the value of decisionId. Returns false if it is already stored or was truncated.
+		 */
+		bool append(uint32_t decisionId, const char* data, uint32_t size)
+		{
+			if (!isOpen() || decisionId < getFirstDecisionId() || contains(decisionId)) return false;
+			Segment& segment = getOrCreateSegment(decisionId);
+			if (segment.mDataSize + size > segment.mDataCapacity)
+			{
+				uint64_t capacity = segment.mDataCapacity;
+				while (segment.mDataSize + size > capacity) capacity *= 2;
+				remapData(segment, capacity);
+			}
+			memcpy(segment.mData + segment.mDataSize, data, size);
+			char* entry = segment.mIndex + (decisionId - segment.mFirstDecisionId) * ENTRY_SIZE;
+			LittleEndian::put64(entry, segment.mDataSize);
+			LittleEndian::put32(entry + 8, size);
+			LittleEndian::put32(entry + 12, getChecksum(data, size));
+			segment.mDataSize += size;
+			uint32_t index = decisionId - segment.mFirstDecisionId;
+			segment.mUnscheduled.add(index);
+			segment.mUnsynced.add(index);
+			if (decisionId >= mNextDecisionId) mNextDecisionId = decisionId + 1;
+			return true;
+		}
+
+		/**
+		 * O(1) lookup of a decided value.
+		 */
+		bool get(uint32_t decisionId, const char*& data, uint32_t& size) const
+		{
+			const char* entry = findEntry(decisionId);
+			if (entry == NULL) return false;
+			data = mSegments[(decisionId - mSegments.front().mFirstDecisionId) / mDecisionsPerSegment].mData + LittleEndian::get64(entry);
+			size = LittleEndian::get32(entry + 8);
+			return true;
+		}
+
+		bool contains(uint32_t decisionId) const
+		{
+			return findEntry(decisionId) != NULL;
+		}
+
+		/**
+		 * Appends the stored values of the decisions [from, to) to values, without copying them.
+		 * Returns the number of values found.
+		 */
+		size_t read(uint32_t from, uint32_t to, std::vector<DecidedValue>& values) const
+		{
+			size_t found = 0;
+			DecidedValue value;
+			if (from < getFirstDecisionId()) from = getFirstDecisionId();
+			if (to > mNextDecisionId) to = mNextDecisionId;
+			for (uint32_t decisionId = from; decisionId < to; decisionId++)
+			{
+				if (get(decisionId, value.mData, value.mSize))
+				{
+					value.mDecisionId = decisionId;
+					values.push_back(value);
+					found++;
+				}
+			}
+			return found;
+		}
+
+		/**
+		 * Drops the segments which only hold decisions lower than decisionId.
+		 */
+		void truncate(uint32_t decisionId)
+		{
+			while (!mSegments.empty() && mSegments.front().mFirstDecisionId + mDecisionsPerSegment <= decisionId)
+			{
+				Segment& segment = mSegments.front();
+				unmapSegment(segment);
+				unlink(getPath(segment.mFirstDecisionId, "idx").c_str());
+				unlink(getPath(segment.mFirstDecisionId, "dat").c_str());
+				mSegments.pop_front();
+			}
+		}
+
+		/**
+		 * Writes the values appended since the last sync to disk, then their index entries: durably,
+		 * or only scheduled if durable is false. Returns false if a flush failed.
+		 */
+		bool sync(bool durable)
+		{
+			bool done = true;
+			for (size_t i = 0; i < mSegments.size(); i++)
+			{
+				Segment& segment = mSegments[i];
+				Dirty& dirty = durable ? segment.mUnsynced : segment.mUnscheduled;
+				if (dirty.isEmpty()) continue;
+				int flags = durable ? MS_SYNC : MS_ASYNC;
+				done = flush(segment.mData, dirty.mDataFrom, segment.mDataSize, flags) && done;
+				done = flush(segment.mIndex, (uint64_t) dirty.mFrom * ENTRY_SIZE, (uint64_t) dirty.mTo * ENTRY_SIZE, flags) && done;
+				segment.mUnscheduled.clear(segment.mDataSize);//a durable sync also writes the unscheduled ones
+				if (durable) segment.mUnsynced.clear(segment.mDataSize);
+			}
+			if (!done) PAXOS_ERROR("Decided log {}: sync failed {}") << mPrefix << strerror(errno);
+			return done;
+		}
+
+	private:
+		std::string			mPrefix;
+		uint32_t			mDecisionsPerSegment;
+		uint64_t			mSegmentBytes;
+		uint32_t			mNextDecisionId;
+		std::deque<Segment>	mSegments;
+
+		/**
+		 * Checksum of a stored value, never 0 which marks an absent entry.
+		 */
+		static uint32_t getChecksum(const char* data, uint32_t size)
+		{
+			uint64_t digest = ValueDigest::of(data, size);
+			uint32_t checksum = (uint32_t) (digest ^ (digest >> 32));
+			return checksum != 0 ? checksum : 1;
+		}
+
+		/**
+		 * msync of the pages holding [from, to) of a mapping, MS_SYNC or MS_ASYNC.
+		 */
+		static bool flush(char* mapping, uint64_t from, uint64_t to, int flags)
+		{
+			if (from >= to) return true;
+			uint64_t page = sysconf(_SC_PAGESIZE);
+			from -= from % page;
+			return msync(mapping + from, to - from, flags) == 0;
+		}
+
+		std::string getPath(uint32_t firstDecisionId, const char* extension) const
+		{
+			char suffix[32];
+			snprintf(suffix, sizeof(suffix), ".%010u.%s", firstDecisionId, extension);
+			return mPrefix + suffix;
+		}
+
+		/**
+		 * Index entry of decisionId, NULL if it is not stored.
+		 */
+		const char* findEntry(uint32_t decisionId) const
+		{
+			if (mSegments.empty() || decisionId < mSegments.front().mFirstDecisionId) return NULL;
+			size_t index = (decisionId - mSegments.front().mFirstDecisionId) / mDecisionsPerSegment;
+			if (index >= mSegments.size()) return NULL;
+			const Segment& segment = mSegments[index];
+			const char* entry = segment.mIndex + (decisionId - segment.mFirstDecisionId) * ENTRY_SIZE;
+			return LittleEndian::get32(entry + 12) != 0 ? entry : NULL;
+		}
+
+		static char* mapFile(int fd, uint64_t size, const std::string& path)
+		{
+			void* address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (address == MAP_FAILED) throw std::runtime_error("Can not map " + path + ": " + strerror(errno));
+			return (char*) address;
+		}
+
+		static int openFile(const std::string& path, uint64_t minSize, uint64_t& size)
+		{
+			int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+			struct stat status;
+			if (fd < 0 || fstat(fd, &status) != 0) throw std::runtime_error("Can not open " + path + ": " + strerror(errno));
+			size = status.st_size;
+			if (size < minSize)
+			{
+				if (ftruncate(fd, minSize) != 0) throw std::runtime_error("Can not allocate " + path + ": " + strerror(errno));
+				size = minSize;
+			}
+			return fd;
+		}
+
+		Segment mapSegment(uint32_t firstDecisionId)
+		{
+			Segment segment;
+			uint64_t indexSize;
+			segment.mFirstDecisionId = firstDecisionId;
+			segment.mIndexFd = openFile(getPath(firstDecisionId, "idx"), mDecisionsPerSegment * ENTRY_SIZE, indexSize);
+			segment.mIndex = mapFile(segment.mIndexFd, mDecisionsPerSegment * ENTRY_SIZE, getPath(firstDecisionId, "idx"));
+			segment.mDataFd = openFile(getPath(firstDecisionId, "dat"), mSegmentBytes, segment.mDataCapacity);
+			segment.mData = mapFile(segment.mDataFd, segment.mDataCapacity, getPath(firstDecisionId, "dat"));
+			segment.mDataSize = 0;
+			for (uint32_t i = 0; i < mDecisionsPerSegment; i++)
+			{
+				char* entry = segment.mIndex + i * ENTRY_SIZE;
+				uint32_t checksum = LittleEndian::get32(entry + 12);
+				if (checksum == 0) continue;
+				uint64_t end = LittleEndian::get64(entry) + LittleEndian::get32(entry + 8);
+				if (end > segment.mDataCapacity || getChecksum(segment.mData + LittleEndian::get64(entry), LittleEndian::get32(entry + 8)) != checksum)
+				{
+					PAXOS_WARN("Decided log {}: dropping torn entry of decision {}.") << mPrefix << firstDecisionId + i;
+					memset(entry, 0, ENTRY_SIZE);
+					continue;
+				}
+				if (end > segment.mDataSize) segment.mDataSize = end;
+			}
+			segment.mUnscheduled.clear(segment.mDataSize);
+			segment.mUnsynced.clear(segment.mDataSize);
+			return segment;
+		}
+
+		void unmapSegment(Segment& segment)
+		{
+			munmap(segment.mIndex, mDecisionsPerSegment * ENTRY_SIZE);
+			munmap(segment.mData, segment.mDataCapacity);
+			::close(segment.mIndexFd);
+			::close(segment.mDataFd);
+		}
+
+		void remapData(Segment& segment, uint64_t capacity)
+		{
+			std::string path = getPath(segment.mFirstDecisionId, "dat");
+			if (ftruncate(segment.mDataFd, capacity) != 0) throw std::runtime_error("Can not grow " + path + ": " + strerror(errno));
+			munmap(segment.mData, segment.mDataCapacity);
+			segment.mData = mapFile(segment.mDataFd, capacity, path);
+			segment.mDataCapacity = capacity;
+		}
+
+		Segment& getOrCreateSegment(uint32_t decisionId)
+		{
+			uint32_t first = decisionId - decisionId % mDecisionsPerSegment;
+			if (mSegments.empty())
+			{
+				mSegments.push_back(mapSegment(first));
+			}
+			while (mSegments.back().mFirstDecisionId < first)
+			{
+				mSegments.push_back(mapSegment(mSegments.back().mFirstDecisionId + mDecisionsPerSegment));
+			}
+			return mSegments[(first - mSegments.front().mFirstDecisionId) / mDecisionsPerSegment];
+		}
+
+		void recoverTail()
+		{
+			mNextDecisionId = mSegments.empty() ? 0 : mSegments.front().mFirstDecisionId;
+			for (size_t i = mSegments.size(); i-- > 0 && mNextDecisionId == getFirstDecisionId();)
+			{
+				for (uint32_t j = mDecisionsPerSegment; j-- > 0;)
+				{
+					if (LittleEndian::get32(mSegments[i].mIndex + j * ENTRY_SIZE + 12) != 0)
+					{
+						mNextDecisionId = mSegments[i].mFirstDecisionId + j + 1;
+						break;
+					}
+				}
+			}
+		}
+	};
+
+}
+
+#endif /* DECIDEDLOG_H_ */
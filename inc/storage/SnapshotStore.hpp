@@ -0,0 +1,176 @@
+/*
+ * SnapshotStore.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef SNAPSHOTSTORE_H_
+#define SNAPSHOTSTORE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include "logging/Logger.hpp"
+#include "protocole/bytes.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Application state snapshots, one file per snapshot: <dir>/<name>.<decision id>.snap
+	 *
+	 * File layout (little-endian): u32 magic, u32 decision id, u32 state size,
+	 * u32 FNV-1a checksum of the state, then the state bytes.
+	 * A snapshot is written to a temporary file and renamed, so it is either complete or absent.
+	 * The previous snapshot is kept as a fallback, older ones are removed.
+	 */
+	class SnapshotStore
+	{
+	public:
+		static const uint32_t MAGIC = 0x50A55AA5;
+		static const size_t HEADER_SIZE = 16;
+
+		bool isOpen() const { return !mDir.empty(); }
+
+		void open(const std::string& dir, const std::string& name)
+		{
+			mDir = dir;
+			mName = name;
+		}
+
+		/**
+		 * Durably stores the state of the application once the decisions < decisionId were applied.
+		 */
+		bool save(uint32_t decisionId, const std::string& state)
+		{
+			if (!isOpen()) return false;
+			std::vector<char> content(HEADER_SIZE);
+			LittleEndian::put32(&content[0], MAGIC);
+			LittleEndian::put32(&content[4], decisionId);
+			LittleEndian::put32(&content[8], state.size());
+			LittleEndian::put32(&content[12], Fnv1a::of(state.data(), state.size()));
+			content.insert(content.end(), state.begin(), state.end());
+			std::string path = getPath(decisionId);
+			std::string tmpPath = path + ".tmp";
+			int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (fd < 0 || !writeAll(fd, content) || fsync(fd) != 0 || rename(tmpPath.c_str(), path.c_str()) != 0)
+			{
+				PAXOS_ERROR("Snapshot {}: write failed {}") << path << strerror(errno);
+				if (fd >= 0) ::close(fd);
+				unlink(tmpPath.c_str());
+				return false;
+			}
+			::close(fd);
+			int dirFd = ::open(mDir.c_str(), O_RDONLY);
+			if (dirFd >= 0)
+			{//make the rename durable
+				fsync(dirFd);
+				::close(dirFd);
+			}
+			std::vector<uint32_t> decisionIds = list();
+			for (size_t i = 0; i + 2 < decisionIds.size(); i++)
+			{
+				unlink(getPath(decisionIds[i]).c_str());
+			}
+			return true;
+		}
+
+		/**
+		 * Loads the latest valid snapshot. Returns false if there is none.
+		 */
+		bool load(uint32_t& decisionId, std::string& state) const
+		{
+			if (!isOpen()) return false;
+			std::vector<uint32_t> decisionIds = list();
+			for (size_t i = decisionIds.size(); i-- > 0;)
+			{
+				if (read(decisionIds[i], state))
+				{
+					decisionId = decisionIds[i];
+					return true;
+				}
+				PAXOS_WARN("Snapshot {} is corrupted => it is ignored.") << getPath(decisionIds[i]);
+			}
+			return false;
+		}
+
+	private:
+		std::string			mDir;
+		std::string			mName;
+
+		static bool writeAll(int fd, const std::vector<char>& buffer)
+		{
+			size_t written = 0;
+			while (written < buffer.size())
+			{
+				ssize_t size = ::write(fd, &buffer[written], buffer.size() - written);
+				if (size < 0 && errno == EINTR) continue;
+				if (size <= 0) return false;
+				written += size;
+			}
+			return true;
+		}
+
+		std::string getPath(uint32_t decisionId) const
+		{
+			char suffix[32];
+			snprintf(suffix, sizeof(suffix), ".%010u.snap", decisionId);
+			return mDir + "/" + mName + suffix;
+		}
+
+		/**
+		 * Decision ids of the stored snapshots, in increasing order.
+		 */
+		std::vector<uint32_t> list() const
+		{
+			std::vector<uint32_t> decisionIds;
+			DIR* directory = opendir(mDir.c_str());
+			if (directory == NULL) return decisionIds;
+			std::string pattern = mName + ".";
+			struct dirent* entry;
+			while ((entry = readdir(directory)) != NULL)
+			{
+				std::string file = entry->d_name;
+				if (file.compare(0, pattern.size(), pattern) == 0 && file.size() > 5 && file.compare(file.size() - 5, 5, ".snap") == 0)
+				{
+					decisionIds.push_back(strtoul(file.c_str() + pattern.size(), NULL, 10));
+				}
+			}
+			closedir(directory);
+			std::sort(decisionIds.begin(), decisionIds.end());
+			return decisionIds;
+		}
+
+		bool read(uint32_t decisionId, std::string& state) const
+		{
+			int fd = ::open(getPath(decisionId).c_str(), O_RDONLY);
+			if (fd < 0) return false;
+			std::vector<char> content;
+			char chunk[65536];
+			ssize_t size;
+			while ((size = ::read(fd, chunk, sizeof(chunk))) > 0)
+			{
+				content.insert(content.end(), chunk, chunk + size);
+			}
+			::close(fd);
+			if (content.size() < HEADER_SIZE || LittleEndian::get32(&content[0]) != MAGIC || LittleEndian::get32(&content[4]) != decisionId) return false;
+			if (LittleEndian::get32(&content[8]) != content.size() - HEADER_SIZE) return false;
+			state.assign(content.begin() + HEADER_SIZE, content.end());
+			return LittleEndian::get32(&content[12]) == Fnv1a::of(state.data(), state.size());
+		}
+	};
+
+}
+
+#endif /* SNAPSHOTSTORE_H_ */
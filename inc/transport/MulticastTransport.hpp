@@ -0,0 +1,68 @@
+/*
+ * MulticastTransport.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef MULTICASTTRANSPORT_H_
+#define MULTICASTTRANSPORT_H_
+
+#include <sstream>
+#include "transport/UdpTransport.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Every message is sent once to the multicast group joined by all the nodes, whatever its type.
+	 */
+	class MulticastTransport : public UdpTransport
+	{
+	public:
+		MulticastTransport() : mTTL(22) {}
+
+		virtual void configure(const boost::property_tree::ptree& configuration)
+		{
+			UdpTransport::configure(configuration);
+			mGroup = configuration.get<std::string>(XML_GROUP);
+			mTTL = configuration.get<uint8_t>(XML_TTL);
+		}
+
+		virtual std::string getDescription() const
+		{
+			std::ostringstream description;
+			description << mLocalAddr << "," << mGroup << ":" << mPort;
+			return description.str();
+		}
+
+	protected:
+		virtual void openSockets(io_service_ptr_t ioService)
+		{
+			mMCAddr.assign(1, boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string(mGroup), mPort));
+
+			mSocketSend = socket_ptr_t(new boost::asio::ip::udp::socket(*ioService, mMCAddr[0].protocol()));
+			mSocketSend->set_option(boost::asio::ip::multicast::hops(mTTL));
+
+			boost::asio::ip::udp::endpoint listen_endpoint(boost::asio::ip::address::from_string(mLocalAddr), mPort);
+			mSocketRcvd = socket_ptr_t(new boost::asio::ip::udp::socket(*ioService));
+			mSocketRcvd->open(listen_endpoint.protocol());
+			mSocketRcvd->set_option(boost::asio::ip::udp::socket::reuse_address(true));
+			mSocketRcvd->bind(listen_endpoint);
+			mSocketRcvd->set_option(boost::asio::ip::multicast::join_group(boost::asio::ip::address::from_string(mGroup)));
+		}
+
+		virtual const std::vector<boost::asio::ip::udp::endpoint>& getDestinations(MsgId) const
+		{
+			return mMCAddr;
+		}
+
+	private:
+		std::string										mGroup;
+		uint8_t											mTTL;
+		std::vector<boost::asio::ip::udp::endpoint>		mMCAddr;
+	};
+
+}
+
+#endif /* MULTICASTTRANSPORT_H_ */
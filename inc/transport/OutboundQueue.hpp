@@ -0,0 +1,180 @@
+/*
+ * OutboundQueue.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef OUTBOUNDQUEUE_H_
+#define OUTBOUNDQUEUE_H_
+
+#include <errno.h>
+#include <string.h>
+#include <vector>
+#include <iostream>
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include "logging/Logger.hpp"
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+namespace paxos
+{
+
+	/**
+	 * Datagrams waiting to be sent, encoded in place in a ring of preallocated slots.
+	 * A datagram sent to several destinations takes one slot and one message header per destination.
+	 *
+	 * flush() sends all of them with one non-blocking sendmmsg (a send_to loop elsewhere).
+	 * When the socket buffer is full, the rest is sent once the socket is writable again,
+	 * so the io_service thread never blocks on a send.
+	 */
+	class OutboundQueue
+	{
+		typedef boost::shared_ptr<boost::asio::ip::udp::socket> socket_ptr_t;
+
+	public:
+		OutboundQueue() : mSlotSize(0), mSlotCount(0), mHead(0), mCount(0), mWaiting(false) {}
+
+		void init(socket_ptr_t socket, size_t capacity, size_t slotSize)
+		{
+			mSocket = socket;
+			mSocket->non_blocking(true);
+			mSlotSize = slotSize;
+			mRing.assign(capacity * slotSize, 0);
+			mSlots.assign(capacity, 0);
+			mSizes.assign(capacity, 0);
+			mDestinations.assign(capacity, boost::asio::ip::udp::endpoint());
+#ifdef __linux__
+			mHeaders.assign(capacity, mmsghdr());
+			mVectors.assign(capacity, iovec());
+			for (size_t i = 0; i < capacity; i++)
+			{
+				mHeaders[i].msg_hdr.msg_iov = &mVectors[i];
+				mHeaders[i].msg_hdr.msg_iovlen = 1;
+			}
+#endif
+		}
+
+		size_t size() const { return mCount - mHead; }
+		size_t getSlotSize() const { return mSlotSize; }
+
+		/**
+		 * Slot of getSlotSize() bytes to encode the next datagram into, NULL if the queue
+		 * can not take it for destinationCount destinations.
+		 */
+		char* reserve(size_t destinationCount)
+		{
+			if (mSlotCount == mSlots.size() || mCount + destinationCount > mSizes.size())
+			{
+				flush();
+				if (mSlotCount == mSlots.size() || mCount + destinationCount > mSizes.size()) return NULL;
+			}
+			return &mRing[mSlotCount * mSlotSize];
+		}
+
+		/**
+		 * Queues the datagram encoded in the reserved slot for each destination.
+		 */
+		void commit(size_t size, const std::vector<boost::asio::ip::udp::endpoint>& destinations)
+		{
+			for (size_t i = 0; i < destinations.size(); i++)
+			{
+				mSlots[mCount] = mSlotCount;
+				mSizes[mCount] = size;
+				mDestinations[mCount] = destinations[i];
+#ifdef __linux__
+				mVectors[mCount].iov_base = &mRing[mSlotCount * mSlotSize];
+				mVectors[mCount].iov_len = size;
+				mHeaders[mCount].msg_hdr.msg_name = mDestinations[mCount].data();
+				mHeaders[mCount].msg_hdr.msg_namelen = mDestinations[mCount].size();
+#endif
+				mCount++;
+			}
+			mSlotCount++;
+		}
+
+		void flush()
+		{
+			if (mWaiting) return;
+#ifdef __linux__
+			while (mHead < mCount)
+			{
+				int sent = sendmmsg(mSocket->native_handle(), &mHeaders[mHead], mCount - mHead, MSG_DONTWAIT);
+				if (sent > 0)
+				{//stops at the first datagram failing, whose error the next call reports
+					mHead += sent;
+					continue;
+				}
+				if (sent < 0 && errno == EINTR)
+				{
+					continue;
+				}
+				if (sent == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+				{
+					waitWritable();
+					return;
+				}
+				PAXOS_ERROR("ERROR on sendmmsg {} => message is dropped.") << strerror(errno);
+				mHead++;//only the failing datagram, mHead, was not sent
+			}
+#else
+			boost::system::error_code ec;
+			while (mHead < mCount)
+			{
+				mSocket->send_to(boost::asio::buffer(&mRing[mSlots[mHead] * mSlotSize], mSizes[mHead]), mDestinations[mHead], 0, ec);
+				if (ec == boost::asio::error::would_block)
+				{
+					waitWritable();
+					return;
+				}
+				if (ec) PAXOS_ERROR("ERROR on send {} => message is dropped.") << ec.message();
+				mHead++;//sent or dropped, one datagram per call
+			}
+#endif
+			mHead = 0;
+			mCount = 0;
+			mSlotCount = 0;
+		}
+
+	private:
+		socket_ptr_t							mSocket;
+		size_t									mSlotSize;
+		size_t									mSlotCount;//slots used
+		size_t									mHead;//first datagram not sent yet
+		size_t									mCount;//datagrams queued (one per destination)
+		bool									mWaiting;
+		std::vector<char>						mRing;
+		std::vector<size_t>						mSlots;//slot of each datagram
+		std::vector<size_t>						mSizes;
+		std::vector<boost::asio::ip::udp::endpoint>	mDestinations;
+#ifdef __linux__
+		std::vector<struct mmsghdr>				mHeaders;
+		std::vector<struct iovec>				mVectors;
+#endif
+
+		void waitWritable()
+		{
+			mWaiting = true;
+			mSocket->async_send(boost::asio::null_buffers(), boost::bind(&OutboundQueue::onWritable, this, boost::asio::placeholders::error));
+		}
+
+		void onWritable(const boost::system::error_code& error)
+		{
+			mWaiting = false;
+			if (!error)
+			{
+				flush();
+			}
+			else if (error != boost::asio::error::operation_aborted)
+			{
+				PAXOS_ERROR("ERROR on send {}") << error.message();
+			}
+		}
+	};
+
+}
+
+#endif /* OUTBOUNDQUEUE_H_ */
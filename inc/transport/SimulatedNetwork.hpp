@@ -0,0 +1,370 @@
+/*
+ * SimulatedNetwork.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef SIMULATEDNETWORK_H_
+#define SIMULATEDNETWORK_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include "handlers/Clock.hpp"
+#include "transport/Transport.hpp"
+
+namespace paxos
+{
+
+	class SimulatedTransport;
+
+	/**
+	 * Network and virtual clock of line handlers running in one thread: a message is delivered
+	 * after a random latency, or lost, duplicated or delayed further (reordered) with the given
+	 * probabilities. Timers and deliveries are events run in virtual time order, ties in the
+	 * order they were scheduled, so that a run only depends on the seed.
+	 */
+	class SimulatedNetwork : public Clock
+	{
+	public:
+		SimulatedNetwork(uint32_t seed)
+			: mNowUs(0), mSequence(0), mRandom(seed),
+			  mLatencyMinUs(100), mLatencyMaxUs(500), mLoss(0), mDuplication(0), mReordering(0), mReorderDelayUs(2000),
+			  mLost(0), mDuplicated(0), mReordered(0), mDelivered(0), mSent(LAST_MSG_ID + 1, 0), mSentBytes(LAST_MSG_ID + 1, 0)
+		{
+		}
+
+		/**
+		 * Latency drawn in [minUs, maxUs]; probabilities in [0, 1]; a reordered message is delayed by reorderDelayUs more.
+		 */
+		void setFaults(uint32_t latencyMinUs, uint32_t latencyMaxUs, double loss, double duplication, double reordering, uint32_t reorderDelayUs)
+		{
+			mLatencyMinUs = latencyMinUs;
+			mLatencyMaxUs = std::max(latencyMinUs, latencyMaxUs);
+			mLoss = toThreshold(loss);
+			mDuplication = toThreshold(duplication);
+			mReordering = toThreshold(reordering);
+			mReorderDelayUs = reorderDelayUs;
+		}
+
+		/**
+		 * Registers a node hosting the given roles (see Transport.hpp), returns its index.
+		 */
+		size_t attach(SimulatedTransport* node, int roles)
+		{
+			mNodes.push_back(node);
+			mRoles.push_back(roles);
+			return mNodes.size() - 1;
+		}
+
+		/**
+		 * Sends a message to the nodes hosting a role that handles it, the sender included.
+		 */
+		void post(MsgId msgId, const char* data, size_t size)
+		{
+			int recipients = Transport::getRecipientRoles(msgId);
+			for (size_t node = 0; node < mNodes.size(); node++)
+			{
+				if (!(mRoles[node] & recipients)) continue;
+				mSent[msgId]++;
+				mSentBytes[msgId] += size;
+				if (draw(mLoss))
+				{
+					mLost++;
+					continue;
+				}
+				scheduleDelivery(node, data, size);
+				if (draw(mDuplication))
+				{
+					mDuplicated++;
+					scheduleDelivery(node, data, size);
+				}
+			}
+		}
+
+		/**
+		 * Calls action once the virtual clock has advanced by delayUs.
+		 */
+		void schedule(uint64_t delayUs, boost::function<void ()> action)
+		{
+			size_t slot = allocate(mActions, mFreeActions);
+			mActions[slot] = action;
+			push(mNowUs + delayUs, TIMER_NODE, slot);
+		}
+
+		/**
+		 * Runs the events up to untilUs (virtual). Returns the number of events run.
+		 */
+		uint64_t run(uint64_t untilUs)
+		{
+			uint64_t count = 0;
+			while (!mEvents.empty() && mEvents.top().mTimeUs <= untilUs)
+			{
+				Event event = mEvents.top();
+				mEvents.pop();
+				mNowUs = event.mTimeUs;
+				if (event.mNode == TIMER_NODE)
+				{
+					boost::function<void ()> action;
+					action.swap(mActions[event.mSlot]);
+					mFreeActions.push_back(event.mSlot);
+					action();
+				}
+				else
+				{
+					mDelivered++;
+					mDelivering.swap(mPayloads[event.mSlot]);//the handlers may send, i.e. grow mPayloads
+					mFreePayloads.push_back(event.mSlot);
+					deliver(event.mNode, mDelivering);
+				}
+				count++;
+			}
+			mNowUs = std::max(mNowUs, untilUs);
+			return count;
+		}
+
+		uint64_t getNowUs() const { return mNowUs; }
+		uint64_t getSent(MsgId msgId) const { return mSent[msgId]; }
+		uint64_t getSentBytes(MsgId msgId) const { return mSentBytes[msgId]; }
+		uint64_t getLost() const { return mLost; }
+		uint64_t getDuplicated() const { return mDuplicated; }
+		uint64_t getReordered() const { return mReordered; }
+		uint64_t getDelivered() const { return mDelivered; }
+
+		virtual long getTimestamp()
+		{
+			return mNowUs / 1000;
+		}
+
+		virtual uint64_t getMicroseconds()
+		{
+			return mNowUs;
+		}
+
+		virtual timer_ptr_t createTimer();
+
+		virtual void post(boost::function<void ()> handler)
+		{
+			schedule(0, handler);
+		}
+
+	private:
+		static const uint32_t TIMER_NODE = 0xFFFFFFFF;
+
+		struct Event
+		{
+			uint64_t	mTimeUs;
+			uint64_t	mSequence;
+			uint32_t	mNode;//TIMER_NODE for the scheduled actions
+			uint32_t	mSlot;//in mActions or mPayloads
+
+			bool operator<(const Event& other) const
+			{//top of the priority queue is the earliest
+				return mTimeUs != other.mTimeUs ? mTimeUs > other.mTimeUs : mSequence > other.mSequence;
+			}
+		};
+
+		uint64_t								mNowUs;
+		uint64_t								mSequence;
+		boost::random::mt19937					mRandom;
+		uint32_t								mLatencyMinUs;
+		uint32_t								mLatencyMaxUs;
+		uint32_t								mLoss;//probabilities scaled to 2^32 - 1
+		uint32_t								mDuplication;
+		uint32_t								mReordering;
+		uint32_t								mReorderDelayUs;
+		uint64_t								mLost;
+		uint64_t								mDuplicated;
+		uint64_t								mReordered;
+		uint64_t								mDelivered;
+		std::vector<uint64_t>					mSent;//by message id, one per recipient
+		std::vector<uint64_t>					mSentBytes;
+		std::vector<SimulatedTransport*>		mNodes;
+		std::vector<int>						mRoles;
+		std::priority_queue<Event>				mEvents;
+		std::vector<boost::function<void ()> >	mActions;
+		std::vector<size_t>						mFreeActions;
+		std::vector<std::string>				mPayloads;
+		std::vector<size_t>						mFreePayloads;
+		std::string								mDelivering;
+
+		static uint32_t toThreshold(double probability)
+		{
+			return probability <= 0 ? 0 : probability >= 1 ? 0xFFFFFFFF : (uint32_t) (probability * 4294967295.0);
+		}
+
+		bool draw(uint32_t threshold)
+		{
+			return threshold != 0 && mRandom() <= threshold;
+		}
+
+		template<class T> static size_t allocate(std::vector<T>& slots, std::vector<size_t>& freeSlots)
+		{
+			if (freeSlots.empty())
+			{
+				slots.push_back(T());
+				return slots.size() - 1;
+			}
+			size_t slot = freeSlots.back();
+			freeSlots.pop_back();
+			return slot;
+		}
+
+		void push(uint64_t timeUs, uint32_t node, size_t slot)
+		{
+			Event event;
+			event.mTimeUs = timeUs;
+			event.mSequence = mSequence++;
+			event.mNode = node;
+			event.mSlot = slot;
+			mEvents.push(event);
+		}
+
+		void scheduleDelivery(size_t node, const char* data, size_t size)
+		{
+			uint64_t delayUs = mLatencyMinUs + mRandom() % (mLatencyMaxUs - mLatencyMinUs + 1);
+			if (draw(mReordering))
+			{
+				mReordered++;
+				delayUs += mReorderDelayUs;
+			}
+			size_t slot = allocate(mPayloads, mFreePayloads);
+			mPayloads[slot].assign(data, size);
+			push(mNowUs + delayUs, node, slot);
+		}
+
+		void deliver(size_t node, const std::string& datagram);
+	};
+
+	/**
+	 * Timer of the virtual clock, see Timer.
+	 */
+	class SimulatedTimer : public Timer, public boost::enable_shared_from_this<SimulatedTimer>
+	{
+	public:
+		SimulatedTimer(SimulatedNetwork& network) : mNetwork(network), mExpiryUs(0), mGeneration(0), mWaiting(false) {}
+
+		virtual void expiresFromNow(long ms)
+		{
+			mExpiryUs = mNetwork.getNowUs() + ms * 1000;
+			if (mWaiting)
+			{
+				mWaiting = false;
+				mGeneration++;
+				handler_t handler;
+				handler.swap(mHandler);
+				mNetwork.schedule(0, boost::bind(handler, boost::system::error_code(boost::asio::error::operation_aborted)));
+			}
+		}
+
+		virtual void asyncWait(handler_t handler)
+		{
+			mHandler = handler;
+			mWaiting = true;
+			uint64_t nowUs = mNetwork.getNowUs();
+			mNetwork.schedule(mExpiryUs > nowUs ? mExpiryUs - nowUs : 0, boost::bind(&SimulatedTimer::expire, shared_from_this(), mGeneration));
+		}
+
+	private:
+		SimulatedNetwork&	mNetwork;
+		uint64_t			mExpiryUs;
+		uint64_t			mGeneration;//expiries of the cancelled waits are ignored
+		bool				mWaiting;
+		handler_t			mHandler;
+
+		void expire(uint64_t generation)
+		{
+			if (generation != mGeneration || !mWaiting) return;
+			mWaiting = false;
+			handler_t handler;
+			handler.swap(mHandler);
+			handler(boost::system::error_code());
+		}
+	};
+
+	/**
+	 * Transport of one simulated node: each message received is a batch of its own.
+	 */
+	class SimulatedTransport : public Transport
+	{
+	public:
+		SimulatedTransport(SimulatedNetwork& network, int roles) : mNetwork(network), mStarted(false), mReservedMsgId(NULL_MESSAGE)
+		{
+			mIndex = mNetwork.attach(this, roles);
+		}
+
+		virtual void configure(const boost::property_tree::ptree&) {}
+		virtual void open(io_service_ptr_t) {}
+
+		virtual void start(datagram_handler_t onDatagram, batch_handler_t onBatchEnd)
+		{
+			mOnDatagram = onDatagram;
+			mOnBatchEnd = onBatchEnd;
+			mStarted = true;
+		}
+
+		/**
+		 * The node no longer receives (crash), its timers still run.
+		 */
+		virtual void close()
+		{
+			mStarted = false;
+		}
+
+		virtual std::string getDescription() const
+		{
+			std::ostringstream description;
+			description << "simulated node#" << mIndex;
+			return description.str();
+		}
+
+		virtual char* reserve(MsgId msgId)
+		{
+			mReservedMsgId = msgId;
+			return mBuffer;
+		}
+
+		virtual void commit(size_t size)
+		{
+			if (mStarted) mNetwork.post(mReservedMsgId, mBuffer, size);
+		}
+
+		void receive(const std::string& datagram)
+		{
+			if (!mStarted) return;
+			mOnDatagram(datagram.data(), datagram.size());
+			mOnBatchEnd();
+		}
+
+	private:
+		SimulatedNetwork&		mNetwork;
+		size_t					mIndex;
+		bool					mStarted;
+		MsgId					mReservedMsgId;
+		char					mBuffer[BUFFER_SIZE];
+		datagram_handler_t		mOnDatagram;
+		batch_handler_t			mOnBatchEnd;
+	};
+
+	inline timer_ptr_t SimulatedNetwork::createTimer()
+	{
+		return timer_ptr_t(new SimulatedTimer(*this));
+	}
+
+	inline void SimulatedNetwork::deliver(size_t node, const std::string& datagram)
+	{
+		mNodes[node]->receive(datagram);
+	}
+
+}
+
+#endif /* SIMULATEDNETWORK_H_ */
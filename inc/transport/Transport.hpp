@@ -0,0 +1,101 @@
+/*
+ * Transport.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef TRANSPORT_H_
+#define TRANSPORT_H_
+
+#include <string.h>
+#include <string>
+#include <boost/asio.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include "protocole/message.hpp"
+
+#define BUFFER_SIZE 1024
+
+namespace paxos
+{
+
+	typedef boost::shared_ptr<boost::asio::io_service> 	io_service_ptr_t;
+
+	enum Role
+	{
+		ROLE_PROPOSER = 1,
+		ROLE_ACCEPTOR = 2,
+		ROLE_LEARNER = 4,
+		ROLE_ALL = ROLE_PROPOSER | ROLE_ACCEPTOR | ROLE_LEARNER
+	};
+
+	/**
+	 * Moves the encoded paxos messages (datagrams of at most BUFFER_SIZE bytes) between the nodes.
+	 *
+	 * A message is encoded in place: reserve() returns the buffer, commit() queues it for the
+	 * nodes hosting a role that handles its type (see getRecipientRoles). The datagrams received
+	 * are handed to the datagram handler in batches, the batch handler is called at the end of
+	 * each batch and the messages sent meanwhile are flushed after it.
+	 */
+	class Transport
+	{
+	public:
+		typedef boost::function<void (const char*, size_t)>	datagram_handler_t;
+		typedef boost::function<void ()>					batch_handler_t;
+
+		virtual ~Transport() {}
+
+		virtual void configure(const boost::property_tree::ptree& configuration) = 0;
+		virtual void open(io_service_ptr_t ioService) = 0;
+		virtual void start(datagram_handler_t onDatagram, batch_handler_t onBatchEnd) = 0;
+		virtual void close() = 0;
+		virtual std::string getDescription() const = 0;
+
+		/**
+		 * Buffer of BUFFER_SIZE bytes to encode a message of type msgId into, NULL if it can not be queued.
+		 */
+		virtual char* reserve(MsgId msgId) = 0;
+		/**
+		 * Queues the message encoded in the reserved buffer.
+		 */
+		virtual void commit(size_t size) = 0;
+
+		/**
+		 * Copies an encoded message. Returns false if it can not be queued.
+		 */
+		bool send(MsgId msgId, const char* data, size_t size)
+		{
+			char* buffer = reserve(msgId);
+			if (buffer == NULL || size > BUFFER_SIZE) return false;
+			memcpy(buffer, data, size);
+			commit(size);
+			return true;
+		}
+
+		/**
+		 * Roles handling the messages of type msgId: replies go to the proposers only.
+		 */
+		static int getRecipientRoles(MsgId msgId, bool valueReferences = false)
+		{
+			switch (msgId)
+			{
+				case PREPARE_REQUEST:
+					return ROLE_ACCEPTOR | ROLE_PROPOSER;//proposers follow the requests of the leader
+				case ACCEPT_REQUEST:
+					return valueReferences ? ROLE_ALL : ROLE_ACCEPTOR | ROLE_PROPOSER;//the learners cache the payload the notification refers to
+				case PROMISE_REPLY:
+				case ACCEPTED_VALUE:
+				case REJECT_REPLY:
+				case PROMISED_VALUE:
+					return ROLE_PROPOSER;
+				default:
+					return ROLE_ALL;//decisions and catch-up
+			}
+		}
+	};
+
+}
+
+#endif /* TRANSPORT_H_ */
@@ -0,0 +1,217 @@
+/*
+ * UdpTransport.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef UDPTRANSPORT_H_
+#define UDPTRANSPORT_H_
+
+#include <errno.h>
+#include <string.h>
+#include <vector>
+#include <stdexcept>
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include "configuration/Configurator.h"
+#include "logging/Logger.hpp"
+#include "transport/Transport.hpp"
+#include "transport/OutboundQueue.hpp"
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+namespace paxos
+{
+
+	typedef boost::shared_ptr<boost::asio::ip::udp::socket> 	socket_ptr_t;
+
+	const int MAX_RECEIVE_BATCH = 64;//default datagrams handled per wake up, their acceptor replies share one log commit
+	const int SEND_QUEUE_SIZE = 256;//default datagrams queued before a flush
+
+	/**
+	 * Datagram transport over UDP sockets: batched receive (recvmmsg) and send queue (sendmmsg).
+	 * The subclasses open the sockets and give the destinations of each message type.
+	 */
+	class UdpTransport : public Transport
+	{
+	public:
+		UdpTransport() : mPort(0), mReceiveBatch(MAX_RECEIVE_BATCH), mReceiveBufferBytes(0), mSendQueueSize(SEND_QUEUE_SIZE), mReceiving(false), mReservedMsgId(NULL_MESSAGE) {}
+
+		virtual void configure(const boost::property_tree::ptree& configuration)
+		{
+			mLocalAddr = configuration.get<std::string>(XML_INTERFACE);
+			mPort = configuration.get<unsigned short>(XML_PORT);
+			mReceiveBatch = configuration.get<size_t>(XML_RECEIVE_BATCH, MAX_RECEIVE_BATCH);
+			mReceiveBufferBytes = configuration.get<int>(XML_RCVBUF_BYTES, 0);
+			mSendQueueSize = configuration.get<size_t>(XML_SEND_QUEUE, SEND_QUEUE_SIZE);
+			if (mReceiveBatch == 0 || mSendQueueSize == 0)
+			{
+				throw std::runtime_error(XML_RECEIVE_BATCH + " and " + XML_SEND_QUEUE + " must be > 0");
+			}
+		}
+
+		virtual void open(io_service_ptr_t ioService)
+		{
+			openSockets(ioService);
+			mSocketRcvd->non_blocking(true);
+			if (mReceiveBufferBytes > 0)
+			{
+				boost::asio::socket_base::receive_buffer_size option(mReceiveBufferBytes);
+				mSocketRcvd->set_option(option);
+				mSocketRcvd->get_option(option);
+				PAXOS_INFO("Receive buffer of {} is {} bytes: requested {}, capped by net.core.rmem_max.") << getDescription() << option.value() << mReceiveBufferBytes;
+			}
+			mOutbound.init(mSocketSend, mSendQueueSize, BUFFER_SIZE);
+			mReceiveRing.assign(mReceiveBatch * BUFFER_SIZE, 0);
+			mReceiveSizes.assign(mReceiveBatch, 0);
+#ifdef __linux__
+			mReceiveHeaders.assign(mReceiveBatch, mmsghdr());
+			mReceiveVectors.assign(mReceiveBatch, iovec());
+			for (size_t i = 0; i < mReceiveBatch; i++)
+			{
+				mReceiveVectors[i].iov_base = &mReceiveRing[i * BUFFER_SIZE];
+				mReceiveVectors[i].iov_len = BUFFER_SIZE;
+				mReceiveHeaders[i].msg_hdr.msg_iov = &mReceiveVectors[i];
+				mReceiveHeaders[i].msg_hdr.msg_iovlen = 1;
+			}
+#endif
+		}
+
+		virtual void start(datagram_handler_t onDatagram, batch_handler_t onBatchEnd)
+		{
+			mOnDatagram = onDatagram;
+			mOnBatchEnd = onBatchEnd;
+			postReceive();
+		}
+
+		virtual void close()
+		{
+			if (mSocketSend) mSocketSend->close();
+			if (mSocketRcvd) mSocketRcvd->close();
+		}
+
+		virtual char* reserve(MsgId msgId)
+		{
+			const std::vector<boost::asio::ip::udp::endpoint>& destinations = getDestinations(msgId);
+			char* buffer = mOutbound.reserve(destinations.size());
+			if (buffer == NULL)
+			{
+				PAXOS_WARN("Send queue is full ({} datagrams) => message is dropped.") << mSendQueueSize;
+				return NULL;
+			}
+			mReservedMsgId = msgId;
+			return buffer;
+		}
+
+		virtual void commit(size_t size)
+		{
+			mOutbound.commit(size, getDestinations(mReservedMsgId));
+			if (!mReceiving)
+			{
+				mOutbound.flush();
+			}
+		}
+
+	protected:
+		std::string						mLocalAddr;
+		unsigned short					mPort;
+		socket_ptr_t					mSocketSend;
+		socket_ptr_t					mSocketRcvd;
+
+		virtual void openSockets(io_service_ptr_t ioService) = 0;
+		virtual const std::vector<boost::asio::ip::udp::endpoint>& getDestinations(MsgId msgId) const = 0;
+
+	private:
+		size_t							mReceiveBatch;
+		int								mReceiveBufferBytes;
+		size_t							mSendQueueSize;
+		bool							mReceiving;//sends are flushed at the end of the receive batch
+		MsgId							mReservedMsgId;
+		OutboundQueue					mOutbound;
+		std::vector<char>				mReceiveRing;//mReceiveBatch buffers of BUFFER_SIZE
+		std::vector<size_t>				mReceiveSizes;
+#ifdef __linux__
+		std::vector<struct mmsghdr>		mReceiveHeaders;
+		std::vector<struct iovec>		mReceiveVectors;
+#endif
+		boost::asio::ip::udp::endpoint	mSenderEndpoint;
+		datagram_handler_t				mOnDatagram;
+		batch_handler_t					mOnBatchEnd;
+
+		/**
+		 * Waits for the socket to be readable: the datagrams are read by receiveBatch().
+		 */
+		void postReceive()
+		{
+			mSocketRcvd->async_receive(
+					boost::asio::null_buffers(),
+					boost::bind(&UdpTransport::handleReceive, this,
+							boost::asio::placeholders::error,
+							boost::asio::placeholders::bytes_transferred)
+			);
+		}
+
+		void handleReceive(const boost::system::error_code& error, std::size_t)
+		{
+			if (error)
+			{
+				if (error != boost::asio::error::operation_aborted) PAXOS_ERROR("ERROR on receive {}") << error.message();
+				close();
+				return;
+			}
+			size_t count = receiveBatch();
+			mReceiving = true;
+			for (size_t i = 0; i < count; i++)
+			{
+				mOnDatagram(&mReceiveRing[i * BUFFER_SIZE], mReceiveSizes[i]);
+			}
+			mOnBatchEnd();
+			mReceiving = false;
+			mOutbound.flush();//the replies of the whole batch
+			postReceive();
+		}
+
+		/**
+		 * Reads up to receive_batch queued datagrams into the buffer ring, with a single recvmmsg on Linux.
+		 * Returns the number of datagrams read, a truncated datagram has a size of 0.
+		 */
+		size_t receiveBatch()
+		{
+#ifdef __linux__
+			int count;
+			do
+			{
+				count = recvmmsg(mSocketRcvd->native_handle(), &mReceiveHeaders[0], mReceiveBatch, MSG_DONTWAIT, NULL);
+			}
+			while (count < 0 && errno == EINTR);
+			if (count < 0)
+			{
+				if (errno != EAGAIN && errno != EWOULDBLOCK) PAXOS_ERROR("ERROR on recvmmsg {}") << strerror(errno);
+				return 0;
+			}
+			for (int i = 0; i < count; i++)
+			{
+				bool truncated = mReceiveHeaders[i].msg_hdr.msg_flags & MSG_TRUNC;
+				mReceiveSizes[i] = truncated ? 0 : mReceiveHeaders[i].msg_len;
+			}
+			return count;
+#else
+			size_t count = 0;
+			boost::system::error_code ec;
+			while (count < mReceiveBatch)
+			{
+				size_t size = mSocketRcvd->receive_from(boost::asio::buffer(&mReceiveRing[count * BUFFER_SIZE], BUFFER_SIZE), mSenderEndpoint, 0, ec);
+				if (ec) break;
+				mReceiveSizes[count++] = size;
+			}
+			return count;
+#endif
+		}
+	};
+
+}
+
+#endif /* UDPTRANSPORT_H_ */
@@ -0,0 +1,99 @@
+/*
+ * UnicastTransport.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef UNICASTTRANSPORT_H_
+#define UNICASTTRANSPORT_H_
+
+#include <sstream>
+#include <boost/foreach.hpp>
+#include <boost/algorithm/string.hpp>
+#include "transport/UdpTransport.hpp"
+
+namespace paxos
+{
+
+	/**
+	 * Each message is sent by UDP to every peer hosting a role that handles it, e.g. the acceptor
+	 * replies only reach the proposers. Peers are listed in the line handler configuration, this
+	 * node included, with the roles they host:
+	 * <peers><peer id="node-1" address="10.0.0.1" port="1077" roles="proposer,acceptor"/>...</peers>
+	 */
+	class UnicastTransport : public UdpTransport
+	{
+	public:
+		UnicastTransport() : mPeerCount(0) {}
+
+		virtual void configure(const boost::property_tree::ptree& configuration)
+		{
+			UdpTransport::configure(configuration);
+			mDestinations.assign(LAST_MSG_ID + 1, std::vector<boost::asio::ip::udp::endpoint>());
+			mPeerCount = 0;
+			bool valueReferences = configuration.get<bool>(XML_VALUE_REFERENCES, false);
+			BOOST_FOREACH(boost::property_tree::ptree::value_type const& v, configuration.get_child(XML_PEERS))
+			{
+				if (v.first != "peer") continue;
+				std::string id = v.second.get<std::string>("<xmlattr>.id");
+				boost::asio::ip::udp::endpoint peer(boost::asio::ip::address::from_string(v.second.get<std::string>("<xmlattr>.address")), v.second.get<unsigned short>("<xmlattr>.port"));
+				int roles = parseRoles(v.second.get<std::string>("<xmlattr>.roles", "proposer,acceptor,learner"));
+				for (int msgId = PREPARE_REQUEST; msgId <= LAST_MSG_ID; msgId++)
+				{
+					if (roles & getRecipientRoles((MsgId) msgId, valueReferences)) mDestinations[msgId].push_back(peer);
+				}
+				mPeerCount++;
+				std::cout << "\tpeer " << id << " " << peer << std::endl;
+			}
+			if (mPeerCount == 0)
+			{
+				throw std::runtime_error(XML_PEERS + " has no peer");
+			}
+		}
+
+		virtual std::string getDescription() const
+		{
+			std::ostringstream description;
+			description << mLocalAddr << ":" << mPort << "," << mPeerCount << " peers";
+			return description.str();
+		}
+
+		static int parseRoles(const std::string& roles)
+		{
+			std::vector<std::string> names;
+			boost::split(names, roles, boost::is_any_of(", "), boost::token_compress_on);
+			int mask = 0;
+			BOOST_FOREACH(const std::string& name, names)
+			{
+				if (name == "proposer") mask |= ROLE_PROPOSER;
+				else if (name == "acceptor") mask |= ROLE_ACCEPTOR;
+				else if (name == "learner") mask |= ROLE_LEARNER;
+				else if (!name.empty()) throw std::runtime_error("unknown peer role " + name);
+			}
+			return mask;
+		}
+
+	protected:
+		virtual void openSockets(io_service_ptr_t ioService)
+		{
+			boost::asio::ip::udp::endpoint listen_endpoint(boost::asio::ip::address::from_string(mLocalAddr), mPort);
+			mSocketRcvd = socket_ptr_t(new boost::asio::ip::udp::socket(*ioService));
+			mSocketRcvd->open(listen_endpoint.protocol());
+			mSocketRcvd->bind(listen_endpoint);
+			mSocketSend = mSocketRcvd;
+		}
+
+		virtual const std::vector<boost::asio::ip::udp::endpoint>& getDestinations(MsgId msgId) const
+		{
+			return mDestinations[msgId];
+		}
+
+	private:
+		size_t														mPeerCount;
+		std::vector<std::vector<boost::asio::ip::udp::endpoint> >	mDestinations;//by message id
+	};
+
+}
+
+#endif /* UNICASTTRANSPORT_H_ */
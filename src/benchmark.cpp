@@ -0,0 +1,267 @@
+//============================================================================
+// Name        : benchmark.cpp
+// Author      : agent
+// Version     :
+// Copyright   : Your copyright notice
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <iostream>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include "PaxosService.hpp"
+#include "configuration/Configurator.h"
+#include "metrics/LatencyHistogram.hpp"
+
+using namespace std;
+
+static uint64_t getMonotonicUs()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/**
+ * Measures the commit latency on the leader: each command starts with the time it was proposed.
+ * All its methods run in the thread of the leader's io_service.
+ */
+class BenchmarkListener
+{
+public:
+	BenchmarkListener() : mRecording(false), mStartUs(0), mStopUs(0), mDecided(0), mCommands(0), mDecisions(0), mLastDecisionId(paxos::NO_DECISION), mLeader(false) {}
+
+	void onStateChange(const string&, const paxos::ProposerState state)
+	{
+		if (state == paxos::LEAD_PRIMARY) mLeader = true;
+	}
+
+	void onConsensus(const uint32_t decisionId, const std::string& acceptedValue)
+	{
+		mDecided++;
+		if (!mRecording) return;
+		uint64_t proposedUs = strtoull(acceptedValue.c_str(), NULL, 10);
+		uint64_t nowUs = getMonotonicUs();
+		mLatencies.record(nowUs > proposedUs ? nowUs - proposedUs : 0);
+		mCommands++;
+		if (decisionId != mLastDecisionId)
+		{
+			mDecisions++;
+			mLastDecisionId = decisionId;
+		}
+	}
+
+	void onDecisionsLost(const uint32_t, const uint32_t)
+	{
+		//the benchmark does not keep an application state
+	}
+
+	void startRecording()
+	{
+		mRecording = true;
+		mStartUs = getMonotonicUs();
+	}
+
+	void stopRecording()
+	{
+		mRecording = false;
+		mStopUs = getMonotonicUs();
+	}
+
+	uint64_t getDecided() const { return mDecided; }
+	bool isLeader() const { return mLeader; }
+	double getSeconds() const { return (mStopUs - mStartUs) / 1e6; }
+	uint64_t getCommands() const { return mCommands; }
+	uint64_t getDecisions() const { return mDecisions; }
+	const paxos::LatencyHistogram& getLatencies() const { return mLatencies; }
+
+private:
+	bool						mRecording;
+	uint64_t					mStartUs;
+	uint64_t					mStopUs;
+	uint64_t					mDecided;//commands decided since the start
+	uint64_t					mCommands;//commands decided while recording
+	uint64_t					mDecisions;
+	uint32_t					mLastDecisionId;
+	bool						mLeader;
+	paxos::LatencyHistogram		mLatencies;
+};
+
+typedef paxos::PaxosService<BenchmarkListener>	service_t;
+typedef boost::shared_ptr<service_t>			service_ptr_t;
+
+/**
+ * Proposes commands to the leader every millisecond, in the thread of its io_service.
+ */
+class LoadGenerator
+{
+public:
+	LoadGenerator(paxos::io_service_ptr_t ioService, service_t& leader, const BenchmarkListener& listener, uint32_t commandsPerMs, uint64_t maxPending, size_t valueBytes)
+		: mTimer(*ioService), mLeader(leader), mListener(listener), mCommandsPerMs(commandsPerMs), mMaxPending(maxPending), mValueBytes(valueBytes), mProposed(0)
+	{
+	}
+
+	void start()
+	{
+		mTimer.expires_from_now(boost::posix_time::millisec(1));
+		mTimer.async_wait(boost::bind(&LoadGenerator::tick, this, boost::asio::placeholders::error));
+	}
+
+	void tick(const boost::system::error_code& error)
+	{
+		if (error) return;
+		for (uint32_t i = 0; i < mCommandsPerMs && mProposed - mListener.getDecided() < mMaxPending; i++)
+		{
+			char command[32];
+			snprintf(command, sizeof(command), "%llu:", (unsigned long long) getMonotonicUs());
+			mCommand.assign(command);
+			mCommand.resize(std::max(mCommand.size(), mValueBytes), '.');
+			if (!mLeader.propose(mCommand)) break;//not elected yet
+			mProposed++;
+		}
+		start();
+	}
+
+private:
+	boost::asio::deadline_timer		mTimer;
+	service_t&						mLeader;
+	const BenchmarkListener&		mListener;
+	uint32_t						mCommandsPerMs;
+	uint64_t						mMaxPending;
+	size_t							mValueBytes;
+	uint64_t						mProposed;
+	string							mCommand;
+};
+
+/**
+ * Runs a cluster of nodes on loopback, one thread each, and prints the results of the run.
+ */
+static void runBenchmark(const boost::property_tree::ptree& benchmark, const boost::property_tree::ptree& run)
+{
+	string name = run.get<string>(paxos::XML_RUN_NAME, "run");
+	size_t nodeCount = run.get<size_t>(paxos::XML_RUN_ACCEPTORS, 3);
+	size_t proposerCount = run.get<size_t>(paxos::XML_RUN_PROPOSERS, 1);
+	size_t valueBytes = run.get<size_t>(paxos::XML_RUN_VALUE_BYTES, 32);
+	unsigned short basePort = benchmark.get<unsigned short>(paxos::XML_BENCHMARK_BASE_PORT, 1180);
+	if (nodeCount == 0 || nodeCount > paxos::MAX_QUORUM_SIZE || proposerCount == 0 || proposerCount > nodeCount)
+	{
+		throw std::runtime_error("In configuration of run " + name + " 0 < proposers <= acceptors <= 64 is required");
+	}
+
+	boost::property_tree::ptree shared = benchmark.get_child("benchmark.paxos_service");
+	if (run.count(paxos::XML_RUN_BATCH_MAX_COUNT)) shared.put("line_handler.proposer.batch_max_count", run.get<uint32_t>(paxos::XML_RUN_BATCH_MAX_COUNT));
+	if (run.count(paxos::XML_RUN_BATCH_MAX_BYTES)) shared.put("line_handler.proposer.batch_max_bytes", run.get<uint32_t>(paxos::XML_RUN_BATCH_MAX_BYTES));
+	if (run.count(paxos::XML_RUN_PIPELINE_WINDOW)) shared.put("pipeline_window", run.get<uint32_t>(paxos::XML_RUN_PIPELINE_WINDOW));
+	boost::property_tree::ptree quorum;
+	boost::property_tree::ptree peers;
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		string index = boost::lexical_cast<string>(i);
+		boost::property_tree::ptree acceptor;
+		acceptor.put("<xmlattr>.id", "acceptor-" + index);
+		quorum.add_child("acceptor", acceptor);
+		boost::property_tree::ptree peer;
+		peer.put("<xmlattr>.id", "node-" + index);
+		peer.put("<xmlattr>.address", "127.0.0.1");
+		peer.put("<xmlattr>.port", basePort + i);
+		peer.put("<xmlattr>.roles", i < proposerCount ? "proposer,acceptor,learner" : "acceptor,learner");
+		peers.add_child("peer", peer);
+	}
+
+	vector<paxos::io_service_ptr_t> ioServices;
+	vector<boost::shared_ptr<BenchmarkListener> > listeners;
+	vector<service_ptr_t> services;
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		string index = boost::lexical_cast<string>(i);
+		boost::property_tree::ptree configuration;
+		configuration.put_child("paxos_service", shared);
+		configuration.put_child(paxos::XML_QUORUM, quorum);
+		configuration.put_child(paxos::XML_PEERS, peers);
+		configuration.put(paxos::XML_TRANSPORT, "unicast");
+		configuration.put(paxos::XML_INTERFACE, "127.0.0.1");
+		configuration.put(paxos::XML_PORT, basePort + i);
+		configuration.put(paxos::XML_ACCEPTOR_ID, "acceptor-" + index);
+		configuration.put(paxos::XML_LEARNER_ID, "learner-" + index);
+		if (i < proposerCount)
+		{
+			configuration.put(paxos::XML_PROPOSER_ID, "proposer-" + index);
+			configuration.put(paxos::XML_PROPOSER_START_STATE, i == 0 ? "PRIMARY" : "STANDBY");
+		}
+		else
+		{
+			configuration.get_child("paxos_service.line_handler").erase("proposer");
+		}
+		ioServices.push_back(paxos::io_service_ptr_t(new boost::asio::io_service));
+		listeners.push_back(boost::shared_ptr<BenchmarkListener>(new BenchmarkListener));
+		services.push_back(service_ptr_t(new service_t(ioServices.back(), listeners.back(), configuration)));
+	}
+
+	LoadGenerator load(ioServices[0], *services[0], *listeners[0], run.get<uint32_t>(paxos::XML_RUN_COMMANDS_PER_MS, benchmark.get<uint32_t>(paxos::XML_BENCHMARK_COMMANDS_PER_MS, 200)),
+			benchmark.get<uint64_t>(paxos::XML_BENCHMARK_MAX_PENDING, 4096), valueBytes);
+	load.start();
+	boost::thread_group threads;
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		threads.create_thread(boost::bind(&service_t::start, services[i].get()));
+	}
+
+	boost::this_thread::sleep(boost::posix_time::millisec(benchmark.get<long>(paxos::XML_BENCHMARK_WARMUP_MS, 1000)));
+	ioServices[0]->post(boost::bind(&BenchmarkListener::startRecording, listeners[0].get()));
+	boost::this_thread::sleep(boost::posix_time::millisec(benchmark.get<long>(paxos::XML_BENCHMARK_DURATION_MS, 5000)));
+	ioServices[0]->post(boost::bind(&BenchmarkListener::stopRecording, listeners[0].get()));
+	boost::this_thread::sleep(boost::posix_time::millisec(10));
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		ioServices[i]->stop();
+	}
+	threads.join_all();
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		services[i]->stop();
+	}
+
+	const BenchmarkListener& leader = *listeners[0];
+	const paxos::LatencyHistogram& latencies = leader.getLatencies();
+	double seconds = leader.getSeconds() > 0 ? leader.getSeconds() : 1;
+	printf("%-16s %9zu %9zu %7zu %5u %12.0f %11.0f %8llu %8llu %8llu %8llu%s\n", name.c_str(), nodeCount, proposerCount, valueBytes,
+			shared.get<uint32_t>("line_handler.proposer.batch_max_count", 64), leader.getCommands() / seconds, leader.getDecisions() / seconds,
+			(unsigned long long) latencies.getPercentile(50), (unsigned long long) latencies.getPercentile(99),
+			(unsigned long long) latencies.getPercentile(99.9), (unsigned long long) latencies.getMax(), leader.isLeader() ? "" : " (no leader)");
+	fflush(stdout);
+}
+
+/**
+ * Runs the benchmark runs of etc/benchmark.xml on loopback: throughput and commit latency
+ * (from PaxosService::propose to onConsensus on the leader) of each configuration.
+ */
+int main(int argc, char* argv[])
+{
+	if (argc != 2)
+	{
+		std::cerr << "Usage: benchmark <benchmark.xml>\n";
+		return 1;
+	}
+	try
+	{
+		boost::property_tree::ptree benchmark = paxos::Configurator::load(argv[1]);
+		std::cout.setstate(std::ios::failbit);//the line handlers log to cout, the results are printed with printf
+		paxos::Logger::setLevel(paxos::LOG_WARN);//keeps stdout to the results
+		printf("%-16s %9s %9s %7s %5s %12s %11s %8s %8s %8s %8s\n", "run", "acceptors", "proposers", "value_B", "batch", "commands/s", "decisions/s", "p50_us", "p99_us", "p999_us", "max_us");
+		BOOST_FOREACH(boost::property_tree::ptree::value_type const& v, benchmark.get_child(paxos::XML_BENCHMARK))
+		{
+			if (v.first == "run") runBenchmark(benchmark, v.second);
+		}
+		return 0;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "Error while running the benchmark: " << e.what() << std::endl;
+	}
+	return 1;
+}
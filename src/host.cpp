@@ -0,0 +1,68 @@
+//============================================================================
+// Name        : host.cpp
+// Author      : agent
+// Version     :
+// Copyright   : Your copyright notice
+//============================================================================
+
+#include <iostream>
+#include "PaxosHost.hpp"
+#include "configuration/Configurator.h"
+
+using namespace std;
+
+/**
+ * Listener of one shard, called in the io thread of the shard.
+ */
+class ShardListener
+{
+public:
+	ShardListener(const string& shard) : mShard(shard) {}
+
+	void onStateChange(const string& id, const paxos::ProposerState state)
+	{
+		PAXOS_INFO("[{}] {} TRANSITION TO STATE {}") << mShard << id << (int) state;
+	}
+
+	void onConsensus(const uint32_t decisionId, const std::string& acceptedValue)
+	{
+		PAXOS_INFO("[{}] CONSENSUS#{} Value={}") << mShard << decisionId << acceptedValue;
+	}
+
+	void onDecisionsLost(const uint32_t from, const uint32_t to)
+	{
+		PAXOS_WARN("[{}] LOST DECISIONS [{}, {}): RESTORE A SNAPSHOT") << mShard << from << to;
+	}
+
+private:
+	string	mShard;
+};
+
+static boost::shared_ptr<ShardListener> createListener(const string& shard)
+{
+	return boost::shared_ptr<ShardListener>(new ShardListener(shard));
+}
+
+typedef paxos::PaxosHost<ShardListener> px_host;
+
+int main(int argc, char* argv[])
+{
+	if (argc != 2)
+	{
+		std::cerr << "Usage: host <host.xml>\n";
+		return 1;
+	}
+	try
+	{
+		px_host host(paxos::Configurator::load(argv[1]), createListener);
+		host.start();
+		host.join();
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "Error while starting paxos_host: " << e.what() << std::endl;
+		return 1;
+	}
+	std::cout << "paxos_host is stopped." << std::endl;
+	return 0;
+}
@@ -24,6 +24,11 @@ public:
 		std::cout << "CONSENSUS#" << decisionId << " Value=" << acceptedValue << std::endl;
 	}
 
+	void onDecisionsLost(const uint32_t from, const uint32_t to)
+	{
+		std::cout << "LOST DECISIONS [" << from << ", " << to << "): RESTORE A SNAPSHOT" << std::endl;
+	}
+
 };
 
 typedef paxos::PaxosService<MyPaxosListener> px_service;
@@ -0,0 +1,377 @@
+//============================================================================
+// Name        : simulator.cpp
+// Author      : agent
+// Version     :
+// Copyright   : Your copyright notice
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <boost/lexical_cast.hpp>
+#include "PaxosService.hpp"
+#include "configuration/Configurator.h"
+#include "transport/SimulatedNetwork.hpp"
+
+using namespace std;
+
+/**
+ * Counters shared by the listeners of the simulated nodes.
+ */
+struct SimulationStats
+{
+	SimulationStats() : mDecisions(0), mCommands(0), mElections(0), mDivergences(0), mDuplicates(0), mLost(0) {}
+
+	uint64_t			mDecisions;//highest decision delivered + 1
+	uint64_t			mCommands;//delivered by the node ahead
+	uint64_t			mElections;
+	uint64_t			mDivergences;//decisions delivered with different values
+	uint64_t			mDuplicates;//commands delivered again by a node, in another decision
+	uint64_t			mLost;//decisions skipped by a node, no peer held them
+	vector<uint32_t>	mHashes;//by decision id, 0 until delivered once
+
+	void record(uint32_t decisionId, uint32_t hash)
+	{
+		hash |= 1;
+		if (decisionId >= mHashes.size()) mHashes.resize(decisionId + 1 + mHashes.size() / 2, 0);
+		if (mHashes[decisionId] == 0) mHashes[decisionId] = hash;
+		else if (mHashes[decisionId] != hash) mDivergences++;
+		if (decisionId + 1 > mDecisions) mDecisions = decisionId + 1;
+	}
+};
+
+class SimulatedListener
+{
+public:
+	SimulatedListener(SimulationStats& stats) : mStats(stats), mDecisionId(paxos::NO_DECISION), mHash(0), mCommands(0) {}
+
+	void onStateChange(const string&, const paxos::ProposerState state)
+	{
+		if (state == paxos::LEAD_PRIMARY) mStats.mElections++;
+	}
+
+	void onConsensus(const uint32_t decisionId, const std::string& acceptedValue)
+	{
+		if (decisionId != mDecisionId)
+		{
+			finish();
+			mDecisionId = decisionId;
+			mHash = 2166136261u;
+		}
+		for (size_t i = 0; i < acceptedValue.size(); i++)
+		{
+			mHash = (mHash ^ (uint8_t) acceptedValue[i]) * 16777619u;
+		}
+		mHash = (mHash ^ 0xFF) * 16777619u;//command separator
+		uint64_t command = strtoull(acceptedValue.c_str() + 1, NULL, 10);//see Client::tick()
+		if (command >= mDelivered.size()) mDelivered.resize(command + 1 + mDelivered.size() / 2, false);
+		if (mDelivered[command]) mStats.mDuplicates++;
+		mDelivered[command] = true;
+		mCommands++;
+		if (mCommands > mStats.mCommands) mStats.mCommands = mCommands;
+	}
+
+	void onDecisionsLost(const uint32_t from, const uint32_t to)
+	{
+		mStats.mLost += to - from;
+	}
+
+	/**
+	 * Records the value of the last decision delivered.
+	 */
+	void finish()
+	{
+		if (mDecisionId != paxos::NO_DECISION) mStats.record(mDecisionId, mHash);
+		mDecisionId = paxos::NO_DECISION;
+	}
+
+private:
+	SimulationStats&	mStats;
+	uint32_t			mDecisionId;
+	uint32_t			mHash;
+	uint64_t			mCommands;
+	vector<bool>		mDelivered;//by command number
+};
+
+typedef paxos::PaxosLH<SimulatedListener> 	line_handler_t;
+typedef boost::shared_ptr<line_handler_t>	line_handler_ptr_t;
+
+/**
+ * Proposes the commands of the next millisecond to the leader, if any.
+ */
+class Client
+{
+public:
+	Client(paxos::SimulatedNetwork& network, const vector<line_handler_ptr_t>& proposers, SimulationStats& stats, uint32_t commandsPerMs, size_t commandBytes, uint64_t maxPending)
+		: mNetwork(network), mProposers(proposers), mStats(stats), mCommandsPerMs(commandsPerMs), mCommandBytes(commandBytes), mMaxPending(maxPending), mProposed(0), mRejected(0),
+		  mLeaderProposed(0), mLeaderDecided(0)
+	{
+	}
+
+	void tick()
+	{
+		line_handler_ptr_t leader;
+		for (size_t p = 0; p < mProposers.size() && !leader; p++)
+		{
+			if (mProposers[p]->isLeader()) leader = mProposers[p];
+		}
+		if (!leader)
+		{
+			mRejected++;//no leader
+		}
+		else if (leader != mLeader)
+		{//the commands held by the previous leader are lost or already decided
+			mLeader = leader;
+			mLeaderProposed = mProposed;
+			mLeaderDecided = mStats.mCommands;
+		}
+		for (uint32_t i = 0; leader && i < mCommandsPerMs && getPending() < mMaxPending; i++)
+		{
+			char command[32];
+			snprintf(command, sizeof(command), "c%llu", (unsigned long long) mProposed);
+			mCommand.assign(command);
+			mCommand.resize(std::max(mCommand.size(), mCommandBytes), '.');
+			if (!leader->propose(mCommand))
+			{
+				mRejected++;
+				break;
+			}
+			mProposed++;
+		}
+		mNetwork.schedule(1000, boost::bind(&Client::tick, this));
+	}
+
+	uint64_t getProposed() const { return mProposed; }
+	uint64_t getRejected() const { return mRejected; }
+
+private:
+	/**
+	 * Commands proposed to the current leader and not decided yet.
+	 */
+	uint64_t getPending() const
+	{
+		uint64_t proposed = mProposed - mLeaderProposed;
+		uint64_t decided = mStats.mCommands - mLeaderDecided;
+		return proposed > decided ? proposed - decided : 0;
+	}
+
+	paxos::SimulatedNetwork&			mNetwork;
+	const vector<line_handler_ptr_t>&	mProposers;
+	SimulationStats&					mStats;
+	uint32_t							mCommandsPerMs;
+	size_t								mCommandBytes;
+	uint64_t							mMaxPending;
+	uint64_t							mProposed;
+	uint64_t							mRejected;
+	line_handler_ptr_t					mLeader;//the last proposer seen leading
+	uint64_t							mLeaderProposed;//mProposed when it was first seen
+	uint64_t							mLeaderDecided;//mStats.mCommands then
+	string								mCommand;
+};
+
+/**
+ * Checks every millisecond that at most one proposer holds the leader lease, the crashed ones included.
+ */
+class LeaseMonitor
+{
+public:
+	LeaseMonitor(paxos::SimulatedNetwork& network, const vector<line_handler_ptr_t>& proposers)
+		: mNetwork(network), mProposers(proposers), mLeasedMs(0), mOverlaps(0)
+	{
+	}
+
+	void tick()
+	{
+		size_t holders = 0;
+		for (size_t p = 0; p < mProposers.size(); p++)
+		{
+			if (mProposers[p]->hasLeaderLease()) holders++;
+		}
+		if (holders > 0) mLeasedMs++;
+		if (holders > 1) mOverlaps++;
+		mNetwork.schedule(1000, boost::bind(&LeaseMonitor::tick, this));
+	}
+
+	uint64_t getLeasedMs() const { return mLeasedMs; }
+	uint64_t getOverlaps() const { return mOverlaps; }
+
+private:
+	paxos::SimulatedNetwork&			mNetwork;
+	vector<line_handler_ptr_t>			mProposers;
+	uint64_t							mLeasedMs;
+	uint64_t							mOverlaps;//milliseconds with several lease holders
+};
+
+static double getWallSeconds()
+{
+	struct timeval tp;
+	gettimeofday(&tp, NULL);
+	return tp.tv_sec + tp.tv_usec / 1e6;
+}
+
+/**
+ * Runs N line handlers over a simulated network in virtual time, see etc/simulation.xml.
+ */
+int main(int argc, char* argv[])
+{
+	if (argc < 2 || argc > 3)
+	{
+		std::cerr << "Usage: simulator <simulation.xml> [seed]\n";
+		return 1;
+	}
+	try
+	{
+		boost::property_tree::ptree simulation = paxos::Configurator::load(argv[1]);
+		uint32_t seed = argc == 3 ? boost::lexical_cast<uint32_t>(argv[2]) : simulation.get<uint32_t>(paxos::XML_SIMULATION_SEED, 1);
+		size_t nodeCount = simulation.get<size_t>(paxos::XML_SIMULATION_NODES);
+		size_t proposerCount = simulation.get<size_t>(paxos::XML_SIMULATION_PROPOSERS, 1);
+		uint64_t durationMs = simulation.get<uint64_t>(paxos::XML_SIMULATION_DURATION_MS);
+		uint64_t crashLeaderMs = simulation.get<uint64_t>(paxos::XML_SIMULATION_CRASH_LEADER_MS, 0);
+		uint64_t minDecisions = simulation.get<uint64_t>(paxos::XML_SIMULATION_MIN_DECISIONS, 0);
+		uint64_t minLeasedMs = simulation.get<uint64_t>(paxos::XML_SIMULATION_MIN_LEASED_MS, 0);
+		if (nodeCount == 0 || nodeCount > paxos::MAX_QUORUM_SIZE || proposerCount == 0 || proposerCount > nodeCount)
+		{
+			throw std::runtime_error("In configuration 0 < proposers <= nodes <= 64 is required");
+		}
+
+		boost::shared_ptr<paxos::SimulatedNetwork> clock(new paxos::SimulatedNetwork(seed));
+		paxos::SimulatedNetwork& network = *clock;
+		network.setFaults(simulation.get<uint32_t>(paxos::XML_SIMULATION_LATENCY_MIN_US, 100),
+				simulation.get<uint32_t>(paxos::XML_SIMULATION_LATENCY_MAX_US, 500),
+				simulation.get<double>(paxos::XML_SIMULATION_LOSS, 0),
+				simulation.get<double>(paxos::XML_SIMULATION_DUPLICATION, 0),
+				simulation.get<double>(paxos::XML_SIMULATION_REORDERING, 0),
+				simulation.get<uint32_t>(paxos::XML_SIMULATION_REORDER_DELAY_US, 2000));
+
+		boost::property_tree::ptree quorum;
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			boost::property_tree::ptree acceptor;
+			acceptor.put("<xmlattr>.id", "acceptor-" + boost::lexical_cast<string>(i));
+			quorum.add_child("acceptor", acceptor);
+		}
+		SimulationStats stats;
+		paxos::io_service_ptr_t io_service_ptr(new boost::asio::io_service);//not run
+		vector<boost::shared_ptr<SimulatedListener> > listeners;
+		vector<boost::shared_ptr<paxos::SimulatedTransport> > transports;
+		vector<line_handler_ptr_t> nodes;
+		vector<line_handler_ptr_t> proposers;
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			string index = boost::lexical_cast<string>(i);
+			boost::property_tree::ptree configuration;
+			configuration.put_child("paxos_service", simulation.get_child("simulation.paxos_service"));
+			configuration.put_child(paxos::XML_QUORUM, quorum);
+			configuration.put(paxos::XML_ACCEPTOR_ID, "acceptor-" + index);
+			configuration.put(paxos::XML_LEARNER_ID, "learner-" + index);
+			int roles = paxos::ROLE_ACCEPTOR | paxos::ROLE_LEARNER;
+			if (i < proposerCount)
+			{
+				configuration.put(paxos::XML_PROPOSER_ID, "proposer-" + index);
+				configuration.put(paxos::XML_PROPOSER_START_STATE, i == 0 ? "PRIMARY" : "STANDBY");
+				roles |= paxos::ROLE_PROPOSER;
+			}
+			else
+			{
+				configuration.get_child("paxos_service.line_handler").erase("proposer");
+			}
+			listeners.push_back(boost::shared_ptr<SimulatedListener>(new SimulatedListener(stats)));
+			transports.push_back(boost::shared_ptr<paxos::SimulatedTransport>(new paxos::SimulatedTransport(network, roles)));
+			nodes.push_back(line_handler_ptr_t(new line_handler_t(io_service_ptr, listeners.back(), transports.back(), clock)));
+			nodes.back()->configure(configuration);
+			nodes.back()->init();
+			if (i < proposerCount) proposers.push_back(nodes.back());
+		}
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			nodes[i]->async_start();
+		}
+
+		Client client(network, proposers, stats, simulation.get<uint32_t>(paxos::XML_SIMULATION_COMMANDS_PER_MS, 64),
+				simulation.get<size_t>(paxos::XML_SIMULATION_COMMAND_BYTES, 16), simulation.get<uint64_t>(paxos::XML_SIMULATION_MAX_PENDING, 8192));
+		network.schedule(1000, boost::bind(&Client::tick, &client));
+		LeaseMonitor leases(network, proposers);
+		network.schedule(1000, boost::bind(&LeaseMonitor::tick, &leases));
+
+		double start = getWallSeconds();
+		uint64_t events = 0;
+		if (crashLeaderMs > 0 && crashLeaderMs < durationMs)
+		{
+			events += network.run(crashLeaderMs * 1000);
+			transports[0]->close();
+			proposers.erase(proposers.begin());//the client fails over to the next proposers
+			std::cout << "node#0 is crashed at " << crashLeaderMs << " ms" << std::endl;
+		}
+		events += network.run(durationMs * 1000);
+		double wallSeconds = getWallSeconds() - start;
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			listeners[i]->finish();
+		}
+
+		uint64_t sent = 0;
+		for (int msgId = paxos::PREPARE_REQUEST; msgId <= paxos::LAST_MSG_ID; msgId++)
+		{
+			sent += network.getSent((paxos::MsgId) msgId);
+		}
+		printf("Simulation seed=%u nodes=%zu proposers=%zu: %llu ms virtual in %.3f s\n", seed, nodeCount, proposerCount, (unsigned long long) durationMs, wallSeconds);
+		printf("\tdecisions: %llu (%.1f/s virtual, %.1f/s wall), commands: %llu proposed %llu, divergences: %llu, duplicates: %llu, lost: %llu\n",
+				(unsigned long long) stats.mDecisions, stats.mDecisions * 1000.0 / durationMs, stats.mDecisions / wallSeconds,
+				(unsigned long long) stats.mCommands, (unsigned long long) client.getProposed(), (unsigned long long) stats.mDivergences,
+				(unsigned long long) stats.mDuplicates, (unsigned long long) stats.mLost);
+		printf("\tleader elections: %llu, ticks without leader: %llu, events: %llu\n",
+				(unsigned long long) stats.mElections, (unsigned long long) client.getRejected(), (unsigned long long) events);
+		printf("\tleader lease: held %llu ms, overlaps: %llu ms\n", (unsigned long long) leases.getLeasedMs(), (unsigned long long) leases.getOverlaps());
+		printf("\tmessages: sent %llu, delivered %llu, lost %llu, duplicated %llu, reordered %llu\n", (unsigned long long) sent,
+				(unsigned long long) network.getDelivered(), (unsigned long long) network.getLost(), (unsigned long long) network.getDuplicated(), (unsigned long long) network.getReordered());
+		for (int msgId = paxos::PREPARE_REQUEST; msgId <= paxos::LAST_MSG_ID; msgId++)
+		{
+			printf("\t\t%-24s %llu (%llu bytes)\n", paxos::getMsgName((paxos::MsgId) msgId), (unsigned long long) network.getSent((paxos::MsgId) msgId),
+					(unsigned long long) network.getSentBytes((paxos::MsgId) msgId));
+		}
+		uint64_t counters[paxos::METRIC_COUNTER_COUNT] = {0};
+		paxos::LatencyHistogram latencies[paxos::METRIC_LATENCY_COUNT];
+		paxos::MetricsSnapshot metrics;
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			nodes[i]->snapshotMetrics(metrics);
+			for (int counter = 0; counter < paxos::METRIC_COUNTER_COUNT; counter++)
+			{
+				counters[counter] += metrics.getCounter((paxos::MetricCounter) counter);
+			}
+			for (int latency = 0; latency < paxos::METRIC_LATENCY_COUNT; latency++)
+			{
+				latencies[latency].merge(metrics.getLatency((paxos::MetricLatency) latency));
+			}
+		}
+		printf("\tmetrics of all nodes:\n");
+		for (int counter = 0; counter < paxos::METRIC_COUNTER_COUNT; counter++)
+		{
+			printf("\t\t%-24s %llu\n", paxos::getMetricName((paxos::MetricCounter) counter), (unsigned long long) counters[counter]);
+		}
+		for (int latency = 0; latency < paxos::METRIC_LATENCY_COUNT; latency++)
+		{
+			printf("\t\t%-24s p50 %llu p99 %llu max %llu (%llu samples)\n", paxos::getMetricName((paxos::MetricLatency) latency),
+					(unsigned long long) latencies[latency].getPercentile(50), (unsigned long long) latencies[latency].getPercentile(99),
+					(unsigned long long) latencies[latency].getMax(), (unsigned long long) latencies[latency].getCount());
+		}
+		if (stats.mDecisions < minDecisions)
+		{
+			std::cerr << "Only " << stats.mDecisions << " decisions of min_decisions=" << minDecisions << std::endl;
+			return 2;
+		}
+		if (leases.getLeasedMs() < minLeasedMs)
+		{
+			std::cerr << "Lease held " << leases.getLeasedMs() << " ms of min_leased_ms=" << minLeasedMs << std::endl;
+			return 2;
+		}
+		return stats.mDivergences == 0 && stats.mDuplicates == 0 && leases.getOverlaps() == 0 ? 0 : 2;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "Error while running the simulation: " << e.what() << std::endl;
+	}
+	return 1;
+}
@@ -0,0 +1,134 @@
+/*
+ * PaxosHostTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE PaxosHostTest
+#include <boost/test/unit_test.hpp>
+#include <boost/make_shared.hpp>
+#include <string>
+#include <vector>
+#include "PaxosHost.hpp"
+
+using namespace paxos;
+
+struct NullListener
+{
+	void onStateChange(const std::string&, const ProposerState) {}
+	void onConsensus(const uint32_t, const std::string&) {}
+};
+
+typedef PaxosHost<NullListener> host_t;
+
+static std::vector<std::string> created;
+
+static boost::shared_ptr<NullListener> createListener(const std::string& shard)
+{
+	created.push_back(shard);
+	return boost::make_shared<NullListener>();
+}
+
+/**
+ * A host of acceptor shards on the loopback interface, declared in the given order.
+ */
+static boost::property_tree::ptree configure(size_t threads, const char* names[], const char* firstKeys[], size_t count)
+{
+	boost::property_tree::ptree cf;
+	cf.put(XML_HOST_THREADS, threads);
+	for (size_t i = 0; i < count; i++)
+	{
+		boost::property_tree::ptree shard;
+		shard.put(XML_SHARD_NAME, names[i]);
+		shard.put(XML_SHARD_FIRST_KEY, firstKeys[i]);
+		shard.put(XML_ACCEPTOR_ID, std::string(names[i]) + "-acceptor");
+		shard.put(XML_TRANSPORT, "unicast");
+		shard.put(XML_INTERFACE, "127.0.0.1");
+		shard.put(XML_PORT, 0);
+		boost::property_tree::ptree peer;
+		peer.put("<xmlattr>.id", std::string(names[i]) + "-proposer");
+		peer.put("<xmlattr>.address", "127.0.0.1");
+		peer.put("<xmlattr>.port", 9);
+		peer.put("<xmlattr>.roles", "proposer");
+		shard.add_child(XML_PEERS + ".peer", peer);
+		cf.add_child(XML_HOST + ".shard", shard);
+	}
+	return cf;
+}
+
+static const char* NAMES[] = {"orders", "accounts", "users"};
+static const char* FIRST_KEYS[] = {"p", "", "g"};
+
+BOOST_AUTO_TEST_CASE(finds_the_shard_owning_a_key)
+{
+	created.clear();
+	host_t host(configure(1, NAMES, FIRST_KEYS, 3), createListener);
+	BOOST_REQUIRE_EQUAL(host.getShardCount(), 3u);
+	BOOST_CHECK_EQUAL(created.size(), 3u);
+	BOOST_CHECK_EQUAL(host.getShardName(0), "accounts");
+	BOOST_CHECK_EQUAL(host.getShardName(1), "users");
+	BOOST_CHECK_EQUAL(host.getShardName(2), "orders");
+	BOOST_CHECK_EQUAL(host.findShard(""), 0u);
+	BOOST_CHECK_EQUAL(host.findShard("alice"), 0u);
+	BOOST_CHECK_EQUAL(host.findShard("g"), 1u);
+	BOOST_CHECK_EQUAL(host.findShard("gabriel"), 1u);
+	BOOST_CHECK_EQUAL(host.findShard("oz"), 1u);
+	BOOST_CHECK_EQUAL(host.findShard("p"), 2u);
+	BOOST_CHECK_EQUAL(host.findShard("zoe"), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(assigns_the_shards_to_the_io_threads_in_turn)
+{
+	host_t shared(configure(2, NAMES, FIRST_KEYS, 3), createListener);
+	BOOST_CHECK(shared.getIOService(0) == shared.getIOService(2));
+	BOOST_CHECK(shared.getIOService(0) != shared.getIOService(1));
+	host_t own(configure(8, NAMES, FIRST_KEYS, 3), createListener);//at most one io thread per shard
+	BOOST_CHECK(own.getIOService(0) != own.getIOService(1));
+	BOOST_CHECK(own.getIOService(0) != own.getIOService(2));
+	BOOST_CHECK(own.getIOService(1) != own.getIOService(2));
+}
+
+BOOST_AUTO_TEST_CASE(requires_distinct_first_keys_from_an_empty_one)
+{
+	const char* noEmpty[] = {"p", "g"};
+	BOOST_CHECK_THROW(host_t(configure(1, NAMES, noEmpty, 2), createListener), std::runtime_error);
+	const char* duplicated[] = {"", "g", "g"};
+	BOOST_CHECK_THROW(host_t(configure(1, NAMES, duplicated, 3), createListener), std::runtime_error);
+	BOOST_CHECK_THROW(host_t(configure(1, NAMES, FIRST_KEYS, 0), createListener), std::runtime_error);
+}
+
+static boost::mutex threadsMutex;
+static std::vector<boost::thread::id> threads(3);
+
+static void recordThread(size_t shard)
+{
+	boost::lock_guard<boost::mutex> lock(threadsMutex);
+	threads[shard] = boost::this_thread::get_id();
+}
+
+static bool recorded()
+{
+	boost::lock_guard<boost::mutex> lock(threadsMutex);
+	return threads[0] != boost::thread::id() && threads[1] != boost::thread::id() && threads[2] != boost::thread::id();
+}
+
+BOOST_AUTO_TEST_CASE(runs_the_posted_handlers_in_the_thread_of_the_shard)
+{
+	host_t host(configure(2, NAMES, FIRST_KEYS, 3), createListener);
+	host.start();
+	for (size_t i = 0; i < 3; i++)
+	{
+		host.post(i, boost::bind(recordThread, i));
+	}
+	for (int i = 0; i < 1000 && !recorded(); i++)
+	{
+		boost::this_thread::sleep(boost::posix_time::millisec(1));
+	}
+	host.stop();
+	BOOST_REQUIRE(threads[0] != boost::thread::id());
+	BOOST_CHECK(threads[0] == threads[2]);
+	BOOST_CHECK(threads[0] != threads[1]);
+	BOOST_CHECK(threads[1] != boost::thread::id());
+	BOOST_CHECK(threads[0] != boost::this_thread::get_id());
+}
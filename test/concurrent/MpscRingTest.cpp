@@ -0,0 +1,75 @@
+/*
+ * MpscRingTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE MpscRingTest
+#include <boost/test/unit_test.hpp>
+#include <boost/bind.hpp>
+#include <vector>
+#include "concurrent/MpscRing.hpp"
+
+using namespace paxos;
+
+BOOST_AUTO_TEST_CASE(is_bounded_and_ordered)
+{
+	MpscRing<int> ring;
+	ring.configure(3);
+	BOOST_CHECK_EQUAL(ring.getCapacity(), 4u);
+	size_t position;
+	for (int i = 0; i < 4; i++)
+	{
+		int* item = ring.claim(position, false);
+		BOOST_REQUIRE(item != NULL);
+		*item = i;
+		ring.publish(position);
+	}
+	BOOST_CHECK(ring.claim(position, false) == NULL);//full
+	for (int i = 0; i < 4; i++)
+	{
+		BOOST_REQUIRE(ring.peek() != NULL);
+		BOOST_CHECK_EQUAL(*ring.peek(), i);
+		ring.pop();
+	}
+	BOOST_CHECK(ring.peek() == NULL);
+	BOOST_CHECK_EQUAL(ring.getDequeuePosition(), 4u);
+}
+
+static void produce(MpscRing<uint64_t>* ring, uint64_t producer, uint64_t count)
+{
+	size_t position;
+	for (uint64_t i = 0; i < count; i++)
+	{
+		uint64_t* item = ring->claim(position, true);
+		*item = producer << 32 | i;
+		ring->publish(position);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(keeps_the_order_of_each_producer)
+{
+	const uint64_t producers = 3, count = 10000;
+	MpscRing<uint64_t> ring;
+	ring.configure(64);
+	boost::thread_group threads;
+	for (uint64_t p = 0; p < producers; p++)
+	{
+		threads.create_thread(boost::bind(&produce, &ring, p, count));
+	}
+	std::vector<uint64_t> next(producers, 0);
+	for (uint64_t received = 0; received < producers * count;)
+	{
+		uint64_t* item = ring.peek();
+		if (item == NULL) continue;
+		uint64_t producer = *item >> 32;
+		BOOST_REQUIRE(producer < producers);
+		BOOST_REQUIRE_EQUAL(*item & 0xFFFFFFFF, next[producer]);
+		next[producer]++;
+		ring.pop();
+		received++;
+	}
+	threads.join_all();
+	BOOST_CHECK(ring.peek() == NULL);
+}
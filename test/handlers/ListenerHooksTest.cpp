@@ -0,0 +1,48 @@
+/*
+ * ListenerHooksTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE ListenerHooksTest
+#include <boost/test/unit_test.hpp>
+#include "handlers/ListenerHooks.hpp"
+
+using namespace paxos;
+
+struct MinimalListener
+{
+	void onConsensus(uint32_t, const std::string&) {}
+};
+
+struct FullListener
+{
+	FullListener() : mSnapshotId(0), mLostFrom(0), mLostTo(0) {}
+	void onConsensus(uint32_t, const std::string&) {}
+	void onSnapshot(uint32_t decisionId, const std::string& state) { mSnapshotId = decisionId; mState = state; }
+	void onDecisionsLost(uint32_t from, uint32_t to) { mLostFrom = from; mLostTo = to; }
+
+	uint32_t	mSnapshotId;
+	std::string	mState;
+	uint32_t	mLostFrom;
+	uint32_t	mLostTo;
+};
+
+BOOST_AUTO_TEST_CASE(skips_the_missing_methods)
+{
+	MinimalListener listener;
+	BOOST_CHECK(!ListenerHooks::onSnapshot(listener, 10, "state"));
+	BOOST_CHECK(!ListenerHooks::onDecisionsLost(listener, 1, 10));
+}
+
+BOOST_AUTO_TEST_CASE(calls_the_implemented_methods)
+{
+	FullListener listener;
+	BOOST_CHECK(ListenerHooks::onSnapshot(listener, 10, "state"));
+	BOOST_CHECK_EQUAL(listener.mSnapshotId, 10u);
+	BOOST_CHECK_EQUAL(listener.mState, "state");
+	BOOST_CHECK(ListenerHooks::onDecisionsLost(listener, 1, 10));
+	BOOST_CHECK_EQUAL(listener.mLostFrom, 1u);
+	BOOST_CHECK_EQUAL(listener.mLostTo, 10u);
+}
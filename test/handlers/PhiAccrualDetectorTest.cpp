@@ -0,0 +1,119 @@
+/*
+ * PhiAccrualDetectorTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE PhiAccrualDetectorTest
+#include <boost/test/unit_test.hpp>
+#include "handlers/PhiAccrualDetector.hpp"
+
+using namespace paxos;
+
+BOOST_AUTO_TEST_CASE(waits_max_silence_until_two_arrivals)
+{
+	PhiAccrualDetector detector;
+	detector.configure(8, 100, 1000, 0, 0, 500000);
+	BOOST_CHECK_EQUAL(detector.getSuspicionUs(), 500000u);
+	detector.heartbeat(1000);
+	BOOST_CHECK_EQUAL(detector.getSuspicionUs(), 500000u);
+	BOOST_CHECK_EQUAL(detector.getRemainingUs(101000), 400000u);
+	BOOST_CHECK_EQUAL(detector.getPhi(101000), 0);
+}
+
+BOOST_AUTO_TEST_CASE(suspects_after_the_usual_intervals)
+{
+	PhiAccrualDetector detector;
+	detector.configure(8, 100, 1000, 0, 0, 500000);
+	uint64_t nowUs = 0;
+	for (int i = 0; i < 50; i++)
+	{
+		nowUs += i % 2 == 0 ? 9000 : 11000;
+		detector.heartbeat(nowUs);
+	}
+	uint64_t suspicionUs = detector.getSuspicionUs();
+	BOOST_CHECK(suspicionUs > 11000 && suspicionUs < 30000);
+	BOOST_CHECK(detector.getPhi(nowUs + 10000) < 1);
+	BOOST_CHECK(detector.getPhi(nowUs + suspicionUs + 1000) > 8);
+	BOOST_CHECK(detector.getPhi(nowUs + 20000) > detector.getPhi(nowUs + 15000));
+	BOOST_CHECK_EQUAL(detector.getRemainingUs(nowUs + suspicionUs), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(tolerates_more_silence_after_irregular_intervals)
+{
+	PhiAccrualDetector regular, irregular;
+	regular.configure(8, 100, 1000, 0, 0, 10000000);
+	irregular.configure(8, 100, 1000, 0, 0, 10000000);
+	uint64_t regularUs = 0, irregularUs = 0;
+	for (int i = 0; i < 50; i++)
+	{
+		regularUs += 10000;
+		regular.heartbeat(regularUs);
+		irregularUs += i % 5 == 0 ? 50000 : 1000;
+		irregular.heartbeat(irregularUs);
+	}
+	BOOST_CHECK(irregular.getSuspicionUs() > 2 * regular.getSuspicionUs());
+}
+
+BOOST_AUTO_TEST_CASE(is_bounded_by_max_silence_and_reset)
+{
+	PhiAccrualDetector detector;
+	detector.configure(8, 100, 1000, 0, 0, 50000);
+	uint64_t nowUs = 0;
+	for (int i = 0; i < 10; i++)
+	{
+		nowUs += i % 2 == 0 ? 10000 : 90000;
+		detector.heartbeat(nowUs);
+	}
+	BOOST_CHECK_EQUAL(detector.getSuspicionUs(), 50000u);
+	detector.reset();
+	detector.heartbeat(nowUs);
+	BOOST_CHECK_EQUAL(detector.getSuspicionUs(), 50000u);
+}
+
+BOOST_AUTO_TEST_CASE(waits_for_the_heartbeat_of_a_leader_going_idle)
+{
+	PhiAccrualDetector detector;
+	detector.configure(8, 100, 10000, 0, 1000000, 3000000);
+	uint64_t nowUs = 0;
+	for (int i = 0; i < 100; i++)
+	{//busy leader
+		nowUs += 1000;
+		detector.heartbeat(nowUs);
+	}
+	BOOST_CHECK(detector.getRemainingUs(nowUs + 1000000 + 5000) > 0);//its first idle heartbeat, a little late
+	BOOST_CHECK(detector.getSuspicionUs() < 1200000);
+}
+
+BOOST_AUTO_TEST_CASE(tolerates_the_lateness_seen_in_the_idle_heartbeats)
+{
+	PhiAccrualDetector punctual, late;
+	punctual.configure(8, 100, 10000, 0, 1000000, 10000000);
+	late.configure(8, 100, 10000, 0, 1000000, 10000000);
+	uint64_t punctualUs = 0, lateUs = 0;
+	for (int i = 0; i < 50; i++)
+	{
+		punctualUs += 1000000;
+		punctual.heartbeat(punctualUs);
+		lateUs += i % 2 == 0 ? 1000000 : 1300000;
+		late.heartbeat(lateUs);
+	}
+	BOOST_CHECK(punctual.getSuspicionUs() < 1200000);
+	BOOST_CHECK(late.getSuspicionUs() > 1500000);
+	BOOST_CHECK(late.getSuspicionUs() < 2500000);
+}
+
+BOOST_AUTO_TEST_CASE(adds_the_acceptable_pause)
+{
+	PhiAccrualDetector detector;
+	detector.configure(8, 100, 10000, 1000000, 1000000, 3000000);
+	uint64_t nowUs = 0;
+	for (int i = 0; i < 10; i++)
+	{
+		nowUs += 1000;
+		detector.heartbeat(nowUs);
+	}
+	BOOST_CHECK(detector.getRemainingUs(nowUs + 2000000) > 0);//a busy leader paused for 2 s
+	BOOST_CHECK(detector.getSuspicionUs() < 2200000);
+}
@@ -0,0 +1,49 @@
+/*
+ * RttEstimatorTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE RttEstimatorTest
+#include <boost/test/unit_test.hpp>
+#include "handlers/RttEstimator.hpp"
+
+using namespace paxos;
+
+BOOST_AUTO_TEST_CASE(keeps_the_configured_timeout_until_a_majority_is_sampled)
+{
+	RttEstimator estimator;
+	estimator.configure(3, 2, 50000, 1000, 1000000);
+	BOOST_CHECK_EQUAL(estimator.getTimeoutUs(), 50000u);
+	estimator.samplePromise(0, 1, 2000);
+	BOOST_CHECK_EQUAL(estimator.getTimeoutUs(), 50000u);
+	estimator.samplePromise(1, 1, 4000);
+	BOOST_CHECK_EQUAL(estimator.getTimeoutUs(), 4000u + 4 * 2000);//the second fastest acceptor
+}
+
+BOOST_AUTO_TEST_CASE(smooths_the_samples)
+{
+	RttEstimator estimator;
+	estimator.configure(1, 1, 50000, 0, 1000000);
+	estimator.sampleAccepted(0, 1, 8000);
+	for (uint32_t i = 2; i < 100; i++)
+	{
+		estimator.sampleAccepted(0, i, 8000);
+	}
+	BOOST_CHECK_EQUAL(estimator.getTimeoutUs(), 8000u + 1000);//no deviation left: the timer granularity
+	estimator.sampleAccepted(0, 50, 100000);//a resent request: not sampled
+	BOOST_CHECK_EQUAL(estimator.getTimeoutUs(), 8000u + 1000);
+}
+
+BOOST_AUTO_TEST_CASE(backs_off_until_the_next_sample)
+{
+	RttEstimator estimator;
+	estimator.configure(1, 1, 10000, 1000, 35000);
+	estimator.backOff();
+	BOOST_CHECK_EQUAL(estimator.getTimeoutUs(), 20000u);
+	estimator.backOff();
+	BOOST_CHECK_EQUAL(estimator.getTimeoutUs(), 35000u);//max
+	estimator.samplePromise(0, 1, 100);
+	BOOST_CHECK_EQUAL(estimator.getTimeoutUs(), 100u + 1000);//back to the rtt
+}
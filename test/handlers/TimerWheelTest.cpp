@@ -0,0 +1,90 @@
+/*
+ * TimerWheelTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE TimerWheelTest
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "handlers/TimerWheel.hpp"
+#include "transport/SimulatedNetwork.hpp"
+
+using namespace paxos;
+
+namespace
+{
+	struct Fixture
+	{
+		boost::shared_ptr<SimulatedNetwork>	mNetwork;
+		TimerWheel							mWheel;
+		std::vector<std::pair<int, uint64_t> >	mExpired;// entry, virtual ms
+
+		Fixture() : mNetwork(new SimulatedNetwork(1))
+		{
+			mWheel.init(mNetwork);
+		}
+
+		void expire(int entry)
+		{
+			mExpired.push_back(std::make_pair(entry, mNetwork->getNowUs() / 1000));
+		}
+
+		void set(TimerWheel::Entry& entry, int id)
+		{
+			entry.setCallback(boost::bind(&Fixture::expire, this, id));
+		}
+	};
+}
+
+BOOST_FIXTURE_TEST_CASE(expires_in_order, Fixture)
+{
+	TimerWheel::Entry a, b, c;
+	set(a, 1);
+	set(b, 2);
+	set(c, 3);
+	mWheel.arm(a, 30);
+	mWheel.arm(b, 10);
+	mWheel.arm(c, 1000);//on the second level
+	BOOST_CHECK_EQUAL(mWheel.getArmedCount(), 3u);
+	mNetwork->run(2000 * 1000);
+	BOOST_REQUIRE_EQUAL(mExpired.size(), 3u);
+	BOOST_CHECK_EQUAL(mExpired[0].first, 2);
+	BOOST_CHECK_EQUAL(mExpired[0].second, 10u);
+	BOOST_CHECK_EQUAL(mExpired[1].first, 1);
+	BOOST_CHECK_EQUAL(mExpired[1].second, 30u);
+	BOOST_CHECK_EQUAL(mExpired[2].first, 3);
+	BOOST_CHECK_EQUAL(mExpired[2].second, 1000u);
+	BOOST_CHECK_EQUAL(mWheel.getArmedCount(), 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(rearms_and_cancels, Fixture)
+{
+	TimerWheel::Entry a, b;
+	set(a, 1);
+	set(b, 2);
+	mWheel.arm(a, 10);
+	mWheel.arm(b, 20);
+	mNetwork->run(5 * 1000);
+	mWheel.arm(a, 50);//pushed back
+	mWheel.cancel(b);
+	BOOST_CHECK(!b.isArmed());
+	mNetwork->run(100 * 1000);
+	BOOST_REQUIRE_EQUAL(mExpired.size(), 1u);
+	BOOST_CHECK_EQUAL(mExpired[0].first, 1);
+	BOOST_CHECK_EQUAL(mExpired[0].second, 55u);
+}
+
+BOOST_FIXTURE_TEST_CASE(cascades_from_the_third_level, Fixture)
+{
+	TimerWheel::Entry a;
+	set(a, 1);
+	uint64_t ms = (1ULL << 16) + 300;
+	mWheel.arm(a, (long) ms);
+	mNetwork->run((ms - 1) * 1000);
+	BOOST_CHECK(mExpired.empty());
+	mNetwork->run((ms + 1) * 1000);
+	BOOST_REQUIRE_EQUAL(mExpired.size(), 1u);
+	BOOST_CHECK_EQUAL(mExpired[0].second, ms);
+}
@@ -0,0 +1,77 @@
+/*
+ * ValueCacheTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE ValueCacheTest
+#include <boost/test/unit_test.hpp>
+#include "handlers/ValueCache.hpp"
+
+using namespace paxos;
+
+BOOST_AUTO_TEST_CASE(resolves_cached_values)
+{
+	ValueCache cache;
+	cache.configure(4, 1024);
+	cache.put(1, "one");
+	cache.put(2, "two");
+	BOOST_REQUIRE(cache.get(1) != NULL);
+	BOOST_CHECK_EQUAL(*cache.get(1), "one");
+	BOOST_CHECK_EQUAL(*cache.get(2), "two");
+	BOOST_CHECK(cache.get(3) == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(evicts_the_oldest_entry)
+{
+	ValueCache cache;
+	cache.configure(2, 1024);
+	cache.put(1, "one");
+	cache.put(2, "two");
+	cache.put(3, "three");
+	BOOST_CHECK(cache.get(1) == NULL);
+	BOOST_CHECK_EQUAL(*cache.get(2), "two");
+	BOOST_CHECK_EQUAL(*cache.get(3), "three");
+}
+
+BOOST_AUTO_TEST_CASE(evicts_to_stay_under_max_bytes)
+{
+	ValueCache cache;
+	cache.configure(8, 10);
+	cache.put(1, "aaaa");
+	cache.put(2, "bbbb");
+	cache.put(3, "cccc");
+	BOOST_CHECK(cache.get(1) == NULL);
+	BOOST_CHECK(cache.get(2) != NULL);
+	BOOST_CHECK(cache.get(3) != NULL);
+	cache.put(4, std::string(11, 'd'));//larger than max_bytes: not kept
+	BOOST_CHECK(cache.get(4) == NULL);
+	BOOST_CHECK(cache.get(3) != NULL);
+}
+
+BOOST_AUTO_TEST_CASE(keeps_the_first_copy_of_a_value)
+{
+	ValueCache cache;
+	cache.configure(2, 1024);
+	cache.put(1, "one");
+	const std::string* value = cache.get(1);
+	cache.put(1, "one");
+	BOOST_CHECK(cache.get(1) == value);
+}
+
+BOOST_AUTO_TEST_CASE(does_not_resolve_colliding_digests)
+{
+	ValueCache cache;
+	cache.configure(2, 1024);
+	cache.put(1, "one");
+	cache.put(1, "other");
+	BOOST_CHECK(cache.get(1) == NULL);
+	cache.put(1, "one");
+	BOOST_CHECK(cache.get(1) == NULL);
+	cache.put(2, "two");
+	cache.put(3, "three");//evicts the collided entry
+	cache.put(1, "other");
+	BOOST_REQUIRE(cache.get(1) != NULL);
+	BOOST_CHECK_EQUAL(*cache.get(1), "other");
+}
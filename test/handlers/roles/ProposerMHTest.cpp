@@ -0,0 +1,337 @@
+/*
+ * ProposerMHTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE ProposerMHTest
+#include <boost/test/unit_test.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/lexical_cast.hpp>
+#include <vector>
+#include "handlers/roles/ProposerMH.hpp"
+#include "handlers/roles/AcceptorMH.hpp"
+
+using namespace paxos;
+
+struct NullListener
+{
+	void onStateChange(const std::string&, const ProposerState) {}
+};
+
+typedef ProposerMH<NullListener> proposer_t;
+typedef AcceptorMH<NullListener> acceptor_t;
+
+static const size_t ACCEPTOR_COUNT = 3;
+
+/**
+ * A multi-paxos proposer and its acceptors exchanging their messages directly.
+ */
+struct Pipeline
+{
+	Pipeline(uint32_t window, uint32_t batchMaxCount, bool valueReferences = false) : mListener(boost::make_shared<NullListener>()), mAcceptors(ACCEPTOR_COUNT)
+	{
+		property_tree::ptree cf;
+		cf.put(XML_MULTI_PAXOS, true);
+		cf.put(XML_PIPELINE_WINDOW, window);
+		cf.put(XML_VALUE_REFERENCES, valueReferences);
+		for (size_t i = 0; i < ACCEPTOR_COUNT; i++)
+		{
+			cf.add_child(XML_QUORUM + ".acceptor", property_tree::ptree()).put("<xmlattr>.id", "acceptor-" + boost::lexical_cast<std::string>(i));
+		}
+		cf.put(XML_PROPOSER_ID, "proposer-1");
+		cf.put(XML_PROPOSER_START_STATE, "PRIMARY");
+		cf.put(XML_PROPOSER_BATCH_MAX_COUNT, batchMaxCount);
+		mProposer.configure(cf);
+		mProposer.init(mListener);
+		mProposer.setValueCache(&mValueCache);
+		BOOST_REQUIRE_EQUAL(mProposer.getQuorum().size(), ACCEPTOR_COUNT);
+		for (size_t i = 0; i < ACCEPTOR_COUNT; i++)
+		{
+			cf.put(XML_ACCEPTOR_ID, "acceptor-" + boost::lexical_cast<std::string>(i));
+			mAcceptors[i].configure(cf);
+			mAcceptors[i].init(mListener);
+		}
+	}
+
+	/**
+	 * Runs phase 1 with all the acceptors, returns the accept request of the first decision.
+	 */
+	PaxosMessage prepare()
+	{
+		PaxosMessage prepare = mProposer.candidate();
+		PaxosMessage request;
+		for (size_t i = 0; i < ACCEPTOR_COUNT; i++)
+		{
+			keep(mProposer.replyPromise(mAcceptors[i].replyPrepare(prepare)), request);
+			for (size_t v = 0; v < mAcceptors[i].getPromisedValueCount(); v++)
+			{
+				keep(mProposer.replyPromisedValue(mAcceptors[i].getPromisedValue(v)), request);
+			}
+		}
+		return request;
+	}
+
+	/**
+	 * The acceptors [0, count) accept request and the proposer receives their replies.
+	 */
+	void accept(const PaxosMessage& request, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			mProposer.replyAccepted(mAcceptors[i].replyAccept(request));
+		}
+	}
+
+	/**
+	 * Values of the decisions learned in order by the proposer.
+	 */
+	std::vector<std::string> learn()
+	{
+		std::vector<std::string> values;
+		while (mProposer.hasLearnQuorum())
+		{
+			mProposer.getConsensusNotification();
+			values.push_back(mProposer.getDecidedValue());
+			mProposer.doEndOfCycle();
+		}
+		return values;
+	}
+
+	/**
+	 * Elects the proposer with a first decided no-op.
+	 */
+	void elect()
+	{
+		accept(prepare(), ACCEPTOR_COUNT);
+		BOOST_REQUIRE_EQUAL(learn().size(), 1u);
+		BOOST_REQUIRE(mProposer.isLeader());
+	}
+
+	void enqueue(const std::string& command)
+	{
+		std::string taken(command);
+		BOOST_REQUIRE(mProposer.enqueue(taken, 0));
+	}
+
+	/**
+	 * Opens decisions while the window and the pending commands allow it.
+	 */
+	std::vector<PaxosMessage> propose()
+	{
+		std::vector<PaxosMessage> requests;
+		while (mProposer.canPropose() && (mProposer.hasPendingCommands() || mProposer.hasAdoptedValue()))
+		{
+			requests.push_back(mProposer.getNextRequest());
+		}
+		return requests;
+	}
+
+	static void keep(const PaxosMessage& reply, PaxosMessage& request)
+	{
+		if (reply.mMsgId == ACCEPT_REQUEST) request = reply;
+	}
+
+	boost::shared_ptr<NullListener>	mListener;
+	ValueCache						mValueCache;
+	proposer_t						mProposer;
+	std::vector<acceptor_t>			mAcceptors;
+};
+
+static std::vector<std::string> commandsOf(const std::string& value)
+{
+	std::vector<std::string> commands;
+	size_t offset = 0;
+	const char* data = NULL;
+	uint32_t size = 0;
+	while (ValueBatch::next(value, offset, data, size))
+	{
+		commands.push_back(std::string(data, size));
+	}
+	return commands;
+}
+
+BOOST_AUTO_TEST_CASE(skips_phase_1_up_to_the_window)
+{
+	Pipeline pipeline(4, 2);
+	pipeline.elect();
+	for (int i = 0; i < 10; i++)
+	{
+		pipeline.enqueue("c" + boost::lexical_cast<std::string>(i));
+	}
+	std::vector<PaxosMessage> requests = pipeline.propose();
+	BOOST_REQUIRE_EQUAL(requests.size(), 4u);
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		BOOST_CHECK_EQUAL(requests[i].mMsgId, ACCEPT_REQUEST);
+		BOOST_CHECK_EQUAL(requests[i].mDecisionId, i + 1);
+		BOOST_CHECK_EQUAL(requests[i].mProposal, requests[0].mProposal);
+		BOOST_CHECK_EQUAL(commandsOf(requests[i].mValue).size(), 2u);
+	}
+	BOOST_CHECK(!pipeline.mProposer.canPropose());
+	BOOST_CHECK(pipeline.mProposer.hasPendingCommands());
+}
+
+BOOST_AUTO_TEST_CASE(delivers_in_order_decisions_learned_out_of_order)
+{
+	Pipeline pipeline(4, 1);
+	pipeline.elect();
+	for (int i = 0; i < 3; i++)
+	{
+		pipeline.enqueue("c" + boost::lexical_cast<std::string>(i));
+	}
+	std::vector<PaxosMessage> requests = pipeline.propose();
+	BOOST_REQUIRE_EQUAL(requests.size(), 3u);
+	pipeline.accept(requests[2], 2);
+	pipeline.accept(requests[1], 2);
+	BOOST_CHECK(pipeline.mProposer.isLearned(3));
+	BOOST_CHECK(pipeline.learn().empty());
+	pipeline.accept(requests[0], 2);
+	std::vector<std::string> values = pipeline.learn();
+	BOOST_REQUIRE_EQUAL(values.size(), 3u);
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		BOOST_REQUIRE_EQUAL(commandsOf(values[i]).size(), 1u);
+		BOOST_CHECK_EQUAL(commandsOf(values[i])[0], "c" + boost::lexical_cast<std::string>(i));
+	}
+	BOOST_CHECK_EQUAL(pipeline.mProposer.getDecisionId(), 4u);
+	BOOST_CHECK(!pipeline.mProposer.hasInFlightDecisions());
+	BOOST_CHECK(!pipeline.mProposer.hasPendingCommands());
+}
+
+BOOST_AUTO_TEST_CASE(proposes_an_adopted_batch_once)
+{
+	Pipeline pipeline(4, 4);
+	pipeline.elect();
+	pipeline.enqueue("c0");
+	pipeline.enqueue("c1");
+	std::vector<PaxosMessage> first = pipeline.propose();
+	pipeline.enqueue("c2");
+	pipeline.enqueue("c3");
+	std::vector<PaxosMessage> second = pipeline.propose();
+	BOOST_REQUIRE_EQUAL(first.size(), 1u);
+	BOOST_REQUIRE_EQUAL(second.size(), 1u);
+	for (size_t i = 0; i < 2; i++)
+	{//decision 2 is chosen, its replies and the request of decision 1 are lost
+		pipeline.mAcceptors[i].replyAccept(second[0]);
+	}
+
+	PaxosMessage gap = pipeline.prepare();//the ballot is lost: phase 1 again
+	BOOST_CHECK_EQUAL(gap.mDecisionId, 1u);
+	BOOST_CHECK(ValueBatch::isNoop(gap.mValue));
+	pipeline.accept(gap, ACCEPTOR_COUNT);
+	BOOST_REQUIRE_EQUAL(pipeline.learn().size(), 1u);
+	std::vector<PaxosMessage> requests = pipeline.propose();
+	BOOST_REQUIRE_EQUAL(requests.size(), 2u);
+	BOOST_CHECK_EQUAL(requests[0].mValue, second[0].mValue);
+	std::vector<std::string> commands = commandsOf(requests[1].mValue);
+	BOOST_REQUIRE_EQUAL(commands.size(), 2u);
+	BOOST_CHECK_EQUAL(commands[0], "c0");
+	BOOST_CHECK_EQUAL(commands[1], "c1");
+}
+
+BOOST_AUTO_TEST_CASE(drops_a_batch_chosen_after_an_aborted_decision)
+{
+	Pipeline pipeline(4, 2);
+	pipeline.elect();
+	for (int i = 0; i < 4; i++)
+	{
+		pipeline.enqueue("c" + boost::lexical_cast<std::string>(i));
+	}
+	std::vector<PaxosMessage> requests = pipeline.propose();
+	BOOST_REQUIRE_EQUAL(requests.size(), 2u);
+	pipeline.accept(requests[1], 2);
+	PaxosMessage other;//decision 1 is chosen with the value of another proposer
+	other.mMsgId = ACCEPTED_VALUE;
+	other.mDecisionId = 1;
+	other.mProposal = requests[0].mProposal;
+	other.mValue = ValueBatch::noop("proposer-2");
+	for (uint16_t i = 0; i < 2; i++)
+	{
+		other.mSenderId = "acceptor-" + boost::lexical_cast<std::string>(i);
+		other.mSenderIndex = i;
+		pipeline.mProposer.replyAccepted(other);
+	}
+	std::vector<std::string> values = pipeline.learn();
+	BOOST_REQUIRE_EQUAL(values.size(), 2u);
+	BOOST_CHECK_EQUAL(values[0], other.mValue);
+	BOOST_CHECK_EQUAL(values[1], requests[1].mValue);
+
+	PaxosMessage request = pipeline.prepare();
+	BOOST_CHECK_EQUAL(request.mDecisionId, 3u);
+	std::vector<std::string> commands = commandsOf(request.mValue);
+	BOOST_REQUIRE_EQUAL(commands.size(), 2u);
+	BOOST_CHECK_EQUAL(commands[0], "c0");
+	BOOST_CHECK_EQUAL(commands[1], "c1");
+	BOOST_CHECK(!pipeline.mProposer.hasPendingCommands());
+}
+
+BOOST_AUTO_TEST_CASE(tallies_a_value_of_the_same_digest_apart)
+{
+	Pipeline pipeline(4, 1);
+	pipeline.elect();
+	pipeline.enqueue("c0");
+	std::vector<PaxosMessage> requests = pipeline.propose();
+	BOOST_REQUIRE_EQUAL(requests.size(), 1u);
+	PaxosMessage colliding = requests[0];//carries the digest of the proposed value
+	colliding.mValue = ValueBatch::noop("proposer-2");
+	PaxosMessage reply = pipeline.mAcceptors[0].replyAccept(requests[0]);
+	reply = pipeline.mAcceptors[0].replyAccept(colliding);//the acceptor compares the values too
+	BOOST_CHECK_EQUAL(reply.mDigest, requests[0].mDigest);
+	BOOST_CHECK_EQUAL(reply.mValue, colliding.mValue);
+	pipeline.mProposer.replyAccepted(reply);
+	pipeline.mProposer.replyAccepted(pipeline.mAcceptors[1].replyAccept(requests[0]));
+	BOOST_CHECK(pipeline.learn().empty());
+	pipeline.mProposer.replyAccepted(pipeline.mAcceptors[2].replyAccept(requests[0]));
+	std::vector<std::string> values = pipeline.learn();
+	BOOST_REQUIRE_EQUAL(values.size(), 1u);
+	BOOST_CHECK_EQUAL(values[0], requests[0].mValue);
+}
+
+BOOST_AUTO_TEST_CASE(tells_a_value_reference_of_another_ballot_apart)
+{
+	Pipeline pipeline(4, 1, true);
+	pipeline.elect();
+	pipeline.enqueue("c0");
+	std::vector<PaxosMessage> requests = pipeline.propose();
+	BOOST_REQUIRE_EQUAL(requests.size(), 1u);
+	PaxosMessage reply = pipeline.mAcceptors[0].replyAccept(requests[0]);
+	BOOST_CHECK(reply.mValue.empty());
+	BOOST_CHECK_EQUAL(reply.mDigest, requests[0].mDigest);
+	reply.mProposal++;//the same digest accepted in the ballot of another proposer
+	pipeline.mProposer.replyAccepted(reply);
+	pipeline.mProposer.replyAccepted(pipeline.mAcceptors[1].replyAccept(requests[0]));
+	BOOST_CHECK(pipeline.learn().empty());
+	pipeline.mProposer.replyAccepted(pipeline.mAcceptors[2].replyAccept(requests[0]));
+	std::vector<std::string> values = pipeline.learn();
+	BOOST_REQUIRE_EQUAL(values.size(), 1u);
+	BOOST_CHECK_EQUAL(values[0], requests[0].mValue);
+}
+
+BOOST_AUTO_TEST_CASE(resolves_a_value_reference_of_another_proposer_in_the_cache)
+{
+	Pipeline pipeline(4, 1, true);
+	pipeline.elect();
+	pipeline.enqueue("c0");
+	std::vector<PaxosMessage> requests = pipeline.propose();
+	BOOST_REQUIRE_EQUAL(requests.size(), 1u);
+	PaxosMessage other;//decision 1 is chosen in a higher ballot with the value of another proposer, known by its digest
+	other.mMsgId = ACCEPTED_VALUE;
+	other.mDecisionId = 1;
+	other.mProposal = requests[0].mProposal + 1;
+	std::string value = ValueBatch::noop("proposer-2");
+	other.mDigest = ValueDigest::of(value);
+	for (uint16_t i = 0; i < 2; i++)
+	{
+		other.mSenderId = "acceptor-" + boost::lexical_cast<std::string>(i);
+		other.mSenderIndex = i;
+		pipeline.mProposer.replyAccepted(other);
+	}
+	BOOST_CHECK(pipeline.learn().empty());
+	pipeline.mValueCache.put(other.mDigest, value);
+	std::vector<std::string> values = pipeline.learn();
+	BOOST_REQUIRE_EQUAL(values.size(), 1u);
+	BOOST_CHECK_EQUAL(values[0], value);
+	BOOST_CHECK(pipeline.mProposer.hasPendingCommands());//c0 is proposed again
+}
@@ -0,0 +1,113 @@
+/*
+ * LoggerTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE LoggerTest
+#include <boost/test/unit_test.hpp>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include "logging/Logger.hpp"
+
+using namespace paxos;
+
+/**
+ * Redirects stdout or stderr to a temporary file while the logger writes the records.
+ */
+class Capture
+{
+public:
+	Capture(FILE* stream) : mStream(stream)
+	{
+		char path[] = "/tmp/LoggerTestXXXXXX";
+		mFd = mkstemp(path);
+		unlink(path);
+		fflush(mStream);
+		mSaved = dup(fileno(mStream));
+		dup2(mFd, fileno(mStream));
+	}
+
+	/**
+	 * Lines written since the capture started, without their time stamp.
+	 */
+	std::string stop()
+	{
+		Logger::instance().flush();
+		fflush(mStream);
+		dup2(mSaved, fileno(mStream));
+		close(mSaved);
+		std::string text;
+		char buffer[256];
+		ssize_t size;
+		lseek(mFd, 0, SEEK_SET);
+		while ((size = read(mFd, buffer, sizeof(buffer))) > 0) text.append(buffer, size);
+		close(mFd);
+		std::string lines;
+		for (size_t start = 0; start < text.size(); )
+		{
+			size_t end = text.find('\n', start);
+			lines += text.substr(start + 16, end + 1 - start - 16);//HH:MM:SS.uuuuuu and a space
+			start = end + 1;
+		}
+		return lines;
+	}
+
+private:
+	FILE*	mStream;
+	int		mFd;
+	int		mSaved;
+};
+
+static int evaluated = 0;
+
+static int evaluate()
+{
+	return ++evaluated;
+}
+
+BOOST_AUTO_TEST_CASE(formats_each_argument_type)
+{
+	Capture capture(stdout);
+	PAXOS_INFO("{} {} {} {} {} {} {}") << -3 << 7u << ((uint64_t) 1 << 40) << 1.5 << 'x' << std::string("text") << "chars";
+	PAXOS_DEBUG("bool {}") << true;
+	BOOST_CHECK_EQUAL(capture.stop(), "INFO  -3 7 1099511627776 1.5 x text chars\nDEBUG bool 1\n");
+}
+
+BOOST_AUTO_TEST_CASE(keeps_the_placeholders_without_argument)
+{
+	Capture capture(stdout);
+	PAXOS_INFO("{} and {} in {x}") << 1;
+	BOOST_CHECK_EQUAL(capture.stop(), "INFO  1 and {} in {x}\n");
+}
+
+BOOST_AUTO_TEST_CASE(truncates_the_strings_past_the_text_size)
+{
+	Capture capture(stdout);
+	std::string first(LogRecord::TEXT_SIZE - 10, 'a');
+	PAXOS_INFO("{}|{}|{}") << first << std::string(20, 'b') << "c";
+	BOOST_CHECK_EQUAL(capture.stop(), "INFO  " + first + "|" + std::string(10, 'b') + "|\n");
+}
+
+BOOST_AUTO_TEST_CASE(writes_the_warnings_to_stderr)
+{
+	Capture out(stdout);
+	Capture err(stderr);
+	PAXOS_WARN("warning {}") << 1;
+	PAXOS_ERROR("error {}") << 2;
+	BOOST_CHECK_EQUAL(err.stop(), "WARN  warning 1\nERROR error 2\n");
+	BOOST_CHECK_EQUAL(out.stop(), "");
+}
+
+BOOST_AUTO_TEST_CASE(skips_the_disabled_levels)
+{
+	Capture capture(stdout);
+	Logger::setLevel(LOG_WARN);
+	PAXOS_INFO("not evaluated {}") << evaluate();
+	Logger::setLevel(LOG_DEBUG);
+	PAXOS_INFO("evaluated {}") << evaluate();
+	BOOST_CHECK_EQUAL(capture.stop(), "INFO  evaluated 1\n");
+	BOOST_CHECK_EQUAL(evaluated, 1);
+}
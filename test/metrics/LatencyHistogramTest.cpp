@@ -0,0 +1,72 @@
+/*
+ * LatencyHistogramTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE LatencyHistogramTest
+#include <boost/test/unit_test.hpp>
+#include "metrics/LatencyHistogram.hpp"
+
+using namespace paxos;
+
+BOOST_AUTO_TEST_CASE(has_exact_buckets_below_128)
+{
+	for (uint64_t value = 0; value < LatencyHistogram::SUB_BUCKET_COUNT; value++)
+	{
+		BOOST_CHECK_EQUAL(LatencyHistogram::indexOf(value), value);
+		BOOST_CHECK_EQUAL(LatencyHistogram::highestValueOf(value), value);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(bounds_the_relative_error)
+{
+	uint64_t values[] = {128, 129, 255, 256, 1000, 123456, 1ULL << 40, 0xFFFFFFFFFFFFFFFFULL};
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+	{
+		size_t index = LatencyHistogram::indexOf(values[i]);
+		BOOST_REQUIRE(index < LatencyHistogram::BUCKET_COUNT);
+		uint64_t highest = LatencyHistogram::highestValueOf(index);
+		BOOST_CHECK_GE(highest, values[i]);
+		BOOST_CHECK_LE(highest - values[i], values[i] / LatencyHistogram::SUB_BUCKET_COUNT);
+		if (index > 0) BOOST_CHECK_LT(LatencyHistogram::highestValueOf(index - 1), values[i]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(never_under_estimates_a_percentile)
+{
+	LatencyHistogram histogram;
+	BOOST_CHECK_EQUAL(histogram.getPercentile(50), 0u);
+	for (uint64_t value = 1; value <= 1000; value++)
+	{
+		histogram.record(value);
+	}
+	BOOST_CHECK_EQUAL(histogram.getCount(), 1000u);
+	BOOST_CHECK_EQUAL(histogram.getSum(), 500500u);
+	BOOST_CHECK_EQUAL(histogram.getMax(), 1000u);
+	BOOST_CHECK_CLOSE(histogram.getMean(), 500.5, 0.001);
+	BOOST_CHECK_GE(histogram.getPercentile(50), 500u);
+	BOOST_CHECK_LE(histogram.getPercentile(50), 500u + 500u / LatencyHistogram::SUB_BUCKET_COUNT);
+	BOOST_CHECK_GE(histogram.getPercentile(99), 990u);
+	BOOST_CHECK_EQUAL(histogram.getPercentile(100), 1000u);//capped by the max
+	BOOST_CHECK_EQUAL(histogram.getPercentile(0), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(merges_and_resets)
+{
+	LatencyHistogram first;
+	LatencyHistogram second;
+	first.record(10);
+	second.record(20);
+	second.record(5000);
+	first.merge(second);
+	BOOST_CHECK_EQUAL(first.getCount(), 3u);
+	BOOST_CHECK_EQUAL(first.getSum(), 5030u);
+	BOOST_CHECK_EQUAL(first.getMax(), 5000u);
+	BOOST_CHECK_EQUAL(first.getPercentile(50), 20u);
+	first.reset();
+	BOOST_CHECK_EQUAL(first.getCount(), 0u);
+	BOOST_CHECK_EQUAL(first.getMax(), 0u);
+	BOOST_CHECK_EQUAL(first.getPercentile(99), 0u);
+}
@@ -0,0 +1,63 @@
+/*
+ * PaxosMetricsTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE PaxosMetricsTest
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include "metrics/PaxosMetrics.hpp"
+
+using namespace paxos;
+
+BOOST_AUTO_TEST_CASE(snapshots_the_counters_and_latencies)
+{
+	PaxosMetrics metrics;
+	metrics.increment(METRIC_REJECTS);
+	metrics.increment(METRIC_DECIDED_COMMANDS, 64);
+	metrics.countReceived(ACCEPT_REQUEST);
+	metrics.countSent(ACCEPTED_VALUE);
+	metrics.countSent(ACCEPTED_VALUE);
+	metrics.record(METRIC_ACCEPT_TO_LEARN, 100);
+	metrics.record(METRIC_ACCEPT_TO_LEARN, 300);
+	MetricsSnapshot snapshot;
+	metrics.snapshot(snapshot);
+	BOOST_CHECK_EQUAL(snapshot.getCounter(METRIC_REJECTS), 1u);
+	BOOST_CHECK_EQUAL(snapshot.getCounter(METRIC_DECIDED_COMMANDS), 64u);
+	BOOST_CHECK_EQUAL(snapshot.getCounter(METRIC_PHASE_TIMEOUTS), 0u);
+	BOOST_CHECK_EQUAL(snapshot.getReceived(ACCEPT_REQUEST), 1u);
+	BOOST_CHECK_EQUAL(snapshot.getSent(ACCEPTED_VALUE), 2u);
+	const LatencyHistogram& latency = snapshot.getLatency(METRIC_ACCEPT_TO_LEARN);
+	BOOST_CHECK_EQUAL(latency.getCount(), 2u);
+	BOOST_CHECK_EQUAL(latency.getSum(), 400u);
+	BOOST_CHECK_EQUAL(latency.getMax(), 300u);
+	BOOST_CHECK_EQUAL(latency.getPercentile(50), 100u);
+	BOOST_CHECK_EQUAL(snapshot.getLatency(METRIC_PREPARE_TO_PROMISE).getCount(), 0u);
+
+	metrics.increment(METRIC_REJECTS);
+	metrics.record(METRIC_ACCEPT_TO_LEARN, 200);
+	metrics.snapshot(snapshot);//a snapshot is replaced, not accumulated
+	BOOST_CHECK_EQUAL(snapshot.getCounter(METRIC_REJECTS), 2u);
+	BOOST_CHECK_EQUAL(snapshot.getLatency(METRIC_ACCEPT_TO_LEARN).getCount(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(writes_the_prometheus_text_format)
+{
+	PaxosMetrics metrics;
+	metrics.increment(METRIC_PHASE_TIMEOUTS, 3);
+	metrics.countReceived(PREPARE_REQUEST);
+	metrics.record(METRIC_PROPOSE_TO_CONSENSUS, 42);
+	MetricsSnapshot snapshot;
+	metrics.snapshot(snapshot);
+	std::ostringstream out;
+	snapshot.write(out, "paxos_");
+	std::string text = out.str();
+	BOOST_CHECK(text.find("paxos_phase_timeouts_total 3\n") != std::string::npos);
+	BOOST_CHECK(text.find("paxos_rejects_total 0\n") != std::string::npos);
+	BOOST_CHECK(text.find(std::string("paxos_messages_received_total{type=\"") + getMsgName(PREPARE_REQUEST) + "\"} 1\n") != std::string::npos);
+	BOOST_CHECK(text.find("paxos_propose_to_consensus_us{quantile=\"0.99\"} 42\n") != std::string::npos);
+	BOOST_CHECK(text.find("paxos_propose_to_consensus_us_count 1\n") != std::string::npos);
+	BOOST_CHECK(text.find("paxos_accept_to_learn_us_count 0\n") != std::string::npos);
+}
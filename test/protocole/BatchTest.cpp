@@ -0,0 +1,60 @@
+/*
+ * BatchTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE BatchTest
+#include <boost/test/unit_test.hpp>
+#include "protocole/batch.hpp"
+
+using namespace paxos;
+
+BOOST_AUTO_TEST_CASE(iterates_over_the_commands)
+{
+	std::deque<std::string> commands;
+	commands.push_back("skipped");
+	commands.push_back("first");
+	commands.push_back(std::string("se\0nd", 5));
+	std::string value;
+	ValueBatch::encode(value, "node1", commands, 1, 2);
+	BOOST_CHECK_EQUAL(ValueBatch::leaderOf(value), "node1");
+	BOOST_CHECK(!ValueBatch::isNoop(value));
+	size_t offset = 0;
+	const char* data = NULL;
+	uint32_t size = 0;
+	BOOST_REQUIRE(ValueBatch::next(value, offset, data, size));
+	BOOST_CHECK_EQUAL(std::string(data, size), "first");
+	BOOST_REQUIRE(ValueBatch::next(value, offset, data, size));
+	BOOST_CHECK_EQUAL(std::string(data, size), std::string("se\0nd", 5));
+	BOOST_CHECK(!ValueBatch::next(value, offset, data, size));
+}
+
+BOOST_AUTO_TEST_CASE(noop_has_no_command)
+{
+	std::deque<std::string> commands;
+	std::string value;
+	ValueBatch::encode(value, "node1", commands, 0, 0);
+	BOOST_CHECK_EQUAL(value, ValueBatch::noop("node1"));
+	BOOST_CHECK(ValueBatch::isNoop(value));
+	BOOST_CHECK_EQUAL(ValueBatch::leaderOf(value), "node1");
+	size_t offset = 0;
+	const char* data = NULL;
+	uint32_t size = 0;
+	BOOST_CHECK(!ValueBatch::next(value, offset, data, size));
+	BOOST_CHECK(ValueBatch::isNoop("node1"));//plain leader id
+	BOOST_CHECK_EQUAL(ValueBatch::leaderOf("node1"), "node1");
+}
+
+BOOST_AUTO_TEST_CASE(stops_at_a_truncated_command)
+{
+	std::deque<std::string> commands(1, "command");
+	std::string value;
+	ValueBatch::encode(value, "node1", commands, 0, 1);
+	value.resize(value.size() - 1);
+	size_t offset = 0;
+	const char* data = NULL;
+	uint32_t size = 0;
+	BOOST_CHECK(!ValueBatch::next(value, offset, data, size));
+}
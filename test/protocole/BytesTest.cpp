@@ -0,0 +1,44 @@
+/*
+ * BytesTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE BytesTest
+#include <boost/test/unit_test.hpp>
+#include "protocole/bytes.hpp"
+
+using namespace paxos;
+
+BOOST_AUTO_TEST_CASE(writes_little_endian_at_any_offset)
+{
+	char buffer[15] = {0};
+	LittleEndian::put16(buffer + 1, 0x0102);
+	LittleEndian::put32(buffer + 3, 0x03040506);
+	LittleEndian::put64(buffer + 7, 0x0708090A0B0C0D0EULL);
+	BOOST_CHECK_EQUAL(buffer[1], 0x02);
+	BOOST_CHECK_EQUAL(buffer[2], 0x01);
+	BOOST_CHECK_EQUAL(buffer[3], 0x06);
+	BOOST_CHECK_EQUAL(buffer[7], 0x0E);
+	BOOST_CHECK_EQUAL(buffer[14], 0x07);
+	BOOST_CHECK_EQUAL(LittleEndian::get16(buffer + 1), 0x0102);
+	BOOST_CHECK_EQUAL(LittleEndian::get32(buffer + 3), 0x03040506u);
+	BOOST_CHECK_EQUAL(LittleEndian::get64(buffer + 7), 0x0708090A0B0C0D0EULL);
+}
+
+BOOST_AUTO_TEST_CASE(reads_high_bytes_unsigned)
+{
+	char buffer[8];
+	LittleEndian::put64(buffer, 0xFFFFFFFFFFFFFFFFULL);
+	BOOST_CHECK_EQUAL(LittleEndian::get16(buffer), 0xFFFF);
+	BOOST_CHECK_EQUAL(LittleEndian::get32(buffer), 0xFFFFFFFFu);
+	BOOST_CHECK_EQUAL(LittleEndian::get64(buffer), 0xFFFFFFFFFFFFFFFFULL);
+}
+
+BOOST_AUTO_TEST_CASE(fnv1a_reference_values)
+{
+	BOOST_CHECK_EQUAL(Fnv1a::of("", 0), 2166136261u);
+	BOOST_CHECK_EQUAL(Fnv1a::of("a", 1), 0xE40C292Cu);
+	BOOST_CHECK_EQUAL(Fnv1a::of("foobar", 6), 0xBF9CF968u);
+}
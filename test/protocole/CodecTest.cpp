@@ -0,0 +1,64 @@
+/*
+ * CodecTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE CodecTest
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "protocole/codec.hpp"
+
+using namespace paxos;
+
+BOOST_AUTO_TEST_CASE(binary_round_trip)
+{
+	MessageCodec codec;
+	codec.setFormat(WIRE_BINARY);
+	std::vector<char> buffer(MessageCodec::getCapacity("node1", "value"));
+	size_t size = codec.encode(&buffer[0], buffer.size(), 42, ACCEPT_REQUEST, "node1", 7, "value", 2, 0x0123456789ABCDEFULL);
+	BOOST_REQUIRE_EQUAL(size, MessageCodec::HEADER_SIZE + 10);
+	PaxosMessage message;
+	BOOST_REQUIRE(MessageCodec::decode(&buffer[0], size, message));
+	BOOST_CHECK_EQUAL(message.mMsgId, ACCEPT_REQUEST);
+	BOOST_CHECK_EQUAL(message.mDecisionId, 42u);
+	BOOST_CHECK_EQUAL(message.mProposal, 7u);
+	BOOST_CHECK_EQUAL(message.mSenderIndex, 2);
+	BOOST_CHECK_EQUAL(message.mDigest, 0x0123456789ABCDEFULL);
+	BOOST_CHECK_EQUAL(message.mSenderId, "node1");
+	BOOST_CHECK_EQUAL(message.mValue, "value");
+}
+
+BOOST_AUTO_TEST_CASE(decodes_text)
+{
+	MessageCodec codec;
+	std::vector<char> buffer(MessageCodec::getCapacity("node1", "value"));
+	size_t size = codec.encode(&buffer[0], buffer.size(), 42, CONSENSUS_NOTIFICATION, "node1", 7, "value");
+	BOOST_REQUIRE(size > 0);
+	PaxosMessage message;
+	BOOST_REQUIRE(MessageCodec::decode(&buffer[0], size, message));
+	BOOST_CHECK_EQUAL(message.mMsgId, CONSENSUS_NOTIFICATION);
+	BOOST_CHECK_EQUAL(message.mDecisionId, 42u);
+	BOOST_CHECK_EQUAL(message.mProposal, 7u);
+	BOOST_CHECK_EQUAL(message.mSenderIndex, NO_NODE_INDEX);
+	BOOST_CHECK_EQUAL(message.mSenderId, "node1");
+	BOOST_CHECK_EQUAL(message.mValue, "value");
+}
+
+BOOST_AUTO_TEST_CASE(rejects_malformed_datagrams)
+{
+	MessageCodec codec;
+	codec.setFormat(WIRE_BINARY);
+	std::vector<char> buffer(MessageCodec::getCapacity("node1", "value"));
+	size_t size = codec.encode(&buffer[0], buffer.size(), 42, ACCEPT_REQUEST, "node1", 7, "value");
+	PaxosMessage message;
+	BOOST_CHECK(!MessageCodec::decode(&buffer[0], size - 1, message));
+	BOOST_CHECK(!MessageCodec::decode(&buffer[0], MessageCodec::HEADER_SIZE - 1, message));
+	buffer[2] = 1;
+	BOOST_CHECK(!MessageCodec::decode(&buffer[0], size, message));
+	buffer[2] = MessageCodec::VERSION;
+	buffer[3] = LAST_MSG_ID + 1;
+	BOOST_CHECK(!MessageCodec::decode(&buffer[0], size, message));
+	BOOST_CHECK_EQUAL(codec.encode(&buffer[0], MessageCodec::HEADER_SIZE, 42, ACCEPT_REQUEST, "node1", 7, "value"), 0u);
+}
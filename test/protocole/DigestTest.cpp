@@ -0,0 +1,46 @@
+/*
+ * DigestTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE DigestTest
+#include <boost/test/unit_test.hpp>
+#include <set>
+#include "protocole/digest.hpp"
+
+using namespace paxos;
+
+BOOST_AUTO_TEST_CASE(depends_on_every_byte)
+{
+	std::string value("0123456789abc");//a word and a tail
+	uint64_t digest = ValueDigest::of(value);
+	BOOST_CHECK_EQUAL(ValueDigest::of(std::string(value)), digest);
+	std::set<uint64_t> digests;
+	digests.insert(digest);
+	for (size_t i = 0; i < value.size(); i++)
+	{
+		std::string changed(value);
+		changed[i] ^= 0x80;
+		digests.insert(ValueDigest::of(changed));
+	}
+	BOOST_CHECK_EQUAL(digests.size(), value.size() + 1);
+	BOOST_CHECK_NE(ValueDigest::of(value.data(), 8), ValueDigest::of(std::string(value.data(), 8) + '\0'));//the size is hashed too
+}
+
+BOOST_AUTO_TEST_CASE(is_never_0)
+{
+	BOOST_CHECK_NE(ValueDigest::of(""), 0u);
+	BOOST_CHECK_NE(ValueDigest::of(std::string(1, '\0')), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(uses_the_carried_digest)
+{
+	PaxosMessage message;
+	message.init();
+	message.mValue = "value";
+	BOOST_CHECK_EQUAL(ValueDigest::get(message), ValueDigest::of("value"));
+	message.mDigest = 42;//carried, it is not checked against the value
+	BOOST_CHECK_EQUAL(ValueDigest::get(message), 42u);
+}
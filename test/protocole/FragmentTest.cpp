@@ -0,0 +1,119 @@
+/*
+ * FragmentTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE FragmentTest
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "protocole/fragment.hpp"
+#include "handlers/FragmentReassembler.hpp"
+
+using namespace paxos;
+
+namespace
+{
+	const size_t DATAGRAM_SIZE = 64;
+
+	std::vector<std::string> split(const std::string& message, uint32_t sequence)
+	{
+		uint32_t count = MessageFragment::getCount(message.size(), DATAGRAM_SIZE, "node1");
+		std::vector<std::string> datagrams;
+		char buffer[DATAGRAM_SIZE];
+		for (uint32_t i = 0; i < count; i++)
+		{
+			size_t size = MessageFragment::encode(buffer, ACCEPT_REQUEST, "node1", sequence, message.data(), message.size(), i, count);
+			BOOST_REQUIRE(size <= DATAGRAM_SIZE);
+			datagrams.push_back(std::string(buffer, size));
+		}
+		return datagrams;
+	}
+
+	std::string getMessage(size_t size)
+	{
+		std::string message;
+		for (size_t i = 0; i < size; i++) message += (char) ('a' + i % 26);
+		return message;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(splits_in_datagrams)
+{
+	BOOST_CHECK_EQUAL(MessageFragment::getCount(35, DATAGRAM_SIZE, "node1"), 1u);
+	BOOST_CHECK_EQUAL(MessageFragment::getCount(36, DATAGRAM_SIZE, "node1"), 2u);
+	BOOST_CHECK_EQUAL(MessageFragment::getCount(10, MessageFragment::HEADER_SIZE + 5, "node1"), 0u);
+	std::vector<std::string> datagrams = split(getMessage(100), 9);
+	BOOST_REQUIRE_EQUAL(datagrams.size(), 3u);
+	MessageFragment fragment;
+	BOOST_REQUIRE(MessageFragment::isFragment(datagrams[2].data(), datagrams[2].size()));
+	BOOST_REQUIRE(fragment.decode(datagrams[2].data(), datagrams[2].size()));
+	BOOST_CHECK_EQUAL(fragment.mSequence, 9u);
+	BOOST_CHECK_EQUAL(fragment.mIndex, 2u);
+	BOOST_CHECK_EQUAL(fragment.mCount, 3u);
+	BOOST_CHECK_EQUAL(fragment.getOffset(), 68u);
+	BOOST_CHECK_EQUAL(std::string(fragment.mSender, fragment.mSenderSize), "node1");
+	BOOST_CHECK_EQUAL(std::string(fragment.mData, fragment.mSize), getMessage(100).substr(68));
+	BOOST_CHECK(!fragment.decode(datagrams[2].data(), datagrams[2].size() - 1));
+}
+
+BOOST_AUTO_TEST_CASE(reassembles_out_of_order_with_duplicates)
+{
+	FragmentReassembler reassembler;
+	std::string message = getMessage(100);
+	std::vector<std::string> datagrams = split(message, 1);
+	MessageFragment fragment;
+	const char* data;
+	size_t size;
+	BOOST_REQUIRE(fragment.decode(datagrams[2].data(), datagrams[2].size()));
+	BOOST_CHECK(!reassembler.add(fragment, 0, data, size));
+	BOOST_REQUIRE(fragment.decode(datagrams[0].data(), datagrams[0].size()));
+	BOOST_CHECK(!reassembler.add(fragment, 0, data, size));
+	BOOST_CHECK(!reassembler.add(fragment, 0, data, size));
+	BOOST_REQUIRE(fragment.decode(datagrams[1].data(), datagrams[1].size()));
+	BOOST_REQUIRE(reassembler.add(fragment, 0, data, size));
+	BOOST_CHECK_EQUAL(std::string(data, size), message);
+}
+
+BOOST_AUTO_TEST_CASE(drops_incomplete_messages_after_timeout)
+{
+	FragmentReassembler reassembler;
+	reassembler.configure(1 << 20, 1 << 20, 100);
+	std::vector<std::string> datagrams = split(getMessage(100), 1);
+	MessageFragment fragment;
+	const char* data;
+	size_t size;
+	BOOST_REQUIRE(fragment.decode(datagrams[0].data(), datagrams[0].size()));
+	BOOST_CHECK(!reassembler.add(fragment, 0, data, size));
+	BOOST_REQUIRE(fragment.decode(datagrams[1].data(), datagrams[1].size()));
+	BOOST_CHECK(!reassembler.add(fragment, 0, data, size));
+	BOOST_REQUIRE(fragment.decode(datagrams[2].data(), datagrams[2].size()));
+	BOOST_CHECK(!reassembler.add(fragment, 200, data, size));//the first fragments were dropped
+}
+
+BOOST_AUTO_TEST_CASE(bounds_the_reassembly_memory)
+{
+	FragmentReassembler reassembler;
+	reassembler.configure(150, 100, 1000);
+	std::vector<std::string> first = split(getMessage(100), 1);
+	std::vector<std::string> second = split(getMessage(100), 2);
+	std::vector<std::string> large = split(getMessage(101), 3);
+	MessageFragment fragment;
+	const char* data;
+	size_t size;
+	BOOST_REQUIRE(fragment.decode(large[0].data(), large[0].size()));
+	BOOST_CHECK(!reassembler.add(fragment, 0, data, size));
+	BOOST_REQUIRE(fragment.decode(first[0].data(), first[0].size()));
+	BOOST_CHECK(!reassembler.add(fragment, 0, data, size));
+	for (size_t i = 0; i < second.size(); i++)
+	{//evicts the first message
+		BOOST_REQUIRE(fragment.decode(second[i].data(), second[i].size()));
+		BOOST_CHECK_EQUAL(reassembler.add(fragment, 0, data, size), i + 1 == second.size());
+	}
+	for (size_t i = 1; i < first.size(); i++)
+	{
+		BOOST_REQUIRE(fragment.decode(first[i].data(), first[i].size()));
+		BOOST_CHECK(!reassembler.add(fragment, 0, data, size));
+	}
+}
@@ -0,0 +1,79 @@
+/*
+ * QuorumTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE QuorumTest
+#include <boost/test/unit_test.hpp>
+#include <boost/lexical_cast.hpp>
+#include "protocole/quorum.hpp"
+
+using namespace paxos;
+
+static std::set<std::string> idsOf(size_t count)
+{
+	std::set<std::string> ids;
+	for (size_t i = 0; i < count; i++)
+	{
+		ids.insert("acceptor-" + boost::lexical_cast<std::string>(i + 10));
+	}
+	return ids;
+}
+
+BOOST_AUTO_TEST_CASE(interns_the_sorted_ids)
+{
+	std::set<std::string> ids;
+	ids.insert("c");
+	ids.insert("a");
+	ids.insert("b");
+	Quorum quorum;
+	quorum.assign(ids);
+	BOOST_CHECK_EQUAL(quorum.size(), 3u);
+	BOOST_CHECK_EQUAL(quorum.getMajority(), 2u);
+	BOOST_CHECK_EQUAL(quorum.indexOf("a"), 0);
+	BOOST_CHECK_EQUAL(quorum.indexOf("b"), 1);
+	BOOST_CHECK_EQUAL(quorum.indexOf("c"), 2);
+	BOOST_CHECK_EQUAL(quorum.indexOf("d"), NO_NODE_INDEX);
+	BOOST_CHECK_EQUAL(quorum.getIds()[1], "b");
+}
+
+BOOST_AUTO_TEST_CASE(resolves_the_sender_of_a_message)
+{
+	Quorum quorum;
+	quorum.assign(idsOf(3));
+	PaxosMessage message;
+	message.mSenderId = "acceptor-11";
+	message.mSenderIndex = NO_NODE_INDEX;
+	BOOST_CHECK_EQUAL(quorum.indexOf(message), 1);//text message: by name
+	message.mSenderIndex = 2;
+	BOOST_CHECK_EQUAL(quorum.indexOf(message), 2);//binary message: the index on the wire
+	message.mSenderIndex = 3;
+	BOOST_CHECK_EQUAL(quorum.indexOf(message), 1);//out of the quorum: by name
+	message.mSenderId = "proposer-1";
+	BOOST_CHECK_EQUAL(quorum.indexOf(message), NO_NODE_INDEX);
+}
+
+BOOST_AUTO_TEST_CASE(counts_a_majority_of_distinct_acceptors)
+{
+	Quorum quorum;
+	quorum.assign(idsOf(5));
+	BOOST_CHECK_EQUAL(quorum.getMajority(), 3u);
+	QuorumMask acceptors;
+	acceptors.set(quorum.indexOf("acceptor-10"));
+	acceptors.set(quorum.indexOf("acceptor-14"));
+	acceptors.set(quorum.indexOf("acceptor-14"));//a duplicated reply
+	BOOST_CHECK_LT(acceptors.count(), quorum.getMajority());
+	acceptors.set(quorum.indexOf("acceptor-12"));
+	BOOST_CHECK_EQUAL(acceptors.count(), quorum.getMajority());
+}
+
+BOOST_AUTO_TEST_CASE(holds_up_to_64_acceptors)
+{
+	Quorum quorum;
+	quorum.assign(idsOf(MAX_QUORUM_SIZE));
+	BOOST_CHECK_EQUAL(quorum.getMajority(), 33u);
+	BOOST_CHECK_EQUAL(quorum.indexOf("acceptor-73"), MAX_QUORUM_SIZE - 1);
+	BOOST_CHECK_THROW(quorum.assign(idsOf(MAX_QUORUM_SIZE + 1)), std::runtime_error);
+}
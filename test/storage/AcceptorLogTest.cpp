@@ -0,0 +1,137 @@
+/*
+ * AcceptorLogTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE AcceptorLogTest
+#include <boost/test/unit_test.hpp>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "storage/AcceptorLog.hpp"
+
+using namespace paxos;
+
+namespace
+{
+	struct LogFile
+	{
+		std::string mPath;
+
+		LogFile()
+		{
+			char path[] = "/tmp/acceptorlogXXXXXX";
+			int fd = mkstemp(path);
+			::close(fd);
+			mPath = path;
+		}
+
+		~LogFile() { unlink(mPath.c_str()); }
+
+		off_t size() const
+		{
+			struct stat status;
+			return ::stat(mPath.c_str(), &status) == 0 ? status.st_size : -1;
+		}
+	};
+}
+
+BOOST_AUTO_TEST_CASE(replays_committed_records_in_order)
+{
+	LogFile file;
+	{
+		AcceptorLog log;
+		std::vector<AcceptorLogRecord> records;
+		log.open(file.mPath, records);
+		BOOST_CHECK(records.empty());
+		log.appendPromise(1, 7, "proposer");
+		log.appendAccept(1, 7, "value");
+		BOOST_CHECK(log.commit());
+	}
+	AcceptorLog log;
+	std::vector<AcceptorLogRecord> records;
+	log.open(file.mPath, records);
+	BOOST_REQUIRE_EQUAL(records.size(), 2u);
+	BOOST_CHECK_EQUAL(records[0].mType, LOG_PROMISE);
+	BOOST_CHECK_EQUAL(records[0].mDecisionId, 1u);
+	BOOST_CHECK_EQUAL(records[0].mProposal, 7u);
+	BOOST_CHECK_EQUAL(records[0].mData, "proposer");
+	BOOST_CHECK_EQUAL(records[1].mType, LOG_ACCEPT);
+	BOOST_CHECK_EQUAL(records[1].mData, "value");
+}
+
+BOOST_AUTO_TEST_CASE(truncates_a_torn_tail)
+{
+	LogFile file;
+	{
+		AcceptorLog log;
+		std::vector<AcceptorLogRecord> records;
+		log.open(file.mPath, records);
+		log.appendAccept(1, 3, "first");
+		BOOST_CHECK(log.commit());
+		log.appendAccept(2, 3, "second");
+		BOOST_CHECK(log.commit());
+	}
+	off_t committed = file.size();
+	BOOST_REQUIRE_EQUAL(truncate(file.mPath.c_str(), committed - 3), 0);//torn write of the second record
+	AcceptorLog log;
+	std::vector<AcceptorLogRecord> records;
+	log.open(file.mPath, records);
+	BOOST_REQUIRE_EQUAL(records.size(), 1u);
+	BOOST_CHECK_EQUAL(records[0].mData, "first");
+	BOOST_CHECK_EQUAL(file.size(), (off_t) (AcceptorLog::RECORD_HEADER_SIZE + AcceptorLog::PAYLOAD_HEADER_SIZE + 5));
+	log.appendAccept(2, 4, "again");
+	BOOST_CHECK(log.commit());
+	log.close();
+	records.clear();
+	log.open(file.mPath, records);
+	BOOST_REQUIRE_EQUAL(records.size(), 2u);
+	BOOST_CHECK_EQUAL(records[1].mData, "again");
+}
+
+BOOST_AUTO_TEST_CASE(drops_a_corrupted_record_and_what_follows)
+{
+	LogFile file;
+	{
+		AcceptorLog log;
+		std::vector<AcceptorLogRecord> records;
+		log.open(file.mPath, records);
+		log.appendAccept(1, 3, "first");
+		log.appendAccept(2, 3, "second");
+		BOOST_CHECK(log.commit());
+	}
+	int fd = ::open(file.mPath.c_str(), O_WRONLY);
+	BOOST_REQUIRE(fd >= 0);
+	BOOST_CHECK_EQUAL(pwrite(fd, "X", 1, file.size() - 1), 1);
+	::close(fd);
+	AcceptorLog log;
+	std::vector<AcceptorLogRecord> records;
+	log.open(file.mPath, records);
+	BOOST_REQUIRE_EQUAL(records.size(), 1u);
+	BOOST_CHECK_EQUAL(records[0].mData, "first");
+}
+
+BOOST_AUTO_TEST_CASE(compaction_replaces_the_file)
+{
+	LogFile file;
+	AcceptorLog log;
+	std::vector<AcceptorLogRecord> records;
+	log.open(file.mPath, records);
+	for (uint32_t i = 0; i < 10; i++)
+	{
+		log.appendAccept(i, 1, "value");
+		BOOST_CHECK(log.commit());
+	}
+	log.requestCompaction();
+	BOOST_CHECK(log.isCompactionDue());
+	log.startCompaction();
+	log.appendAccept(9, 1, "value");
+	BOOST_CHECK(log.commit());
+	log.close();
+	records.clear();
+	log.open(file.mPath, records);
+	BOOST_REQUIRE_EQUAL(records.size(), 1u);
+	BOOST_CHECK_EQUAL(records[0].mDecisionId, 9u);
+}
@@ -0,0 +1,141 @@
+/*
+ * DecidedLogTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE DecidedLogTest
+#include <boost/test/unit_test.hpp>
+#include <stdlib.h>
+#include <unistd.h>
+#include "storage/DecidedLog.hpp"
+
+using namespace paxos;
+
+namespace
+{
+	struct LogDirectory
+	{
+		std::string mPath;
+
+		LogDirectory()
+		{
+			char path[] = "/tmp/decidedlogXXXXXX";
+			mPath = mkdtemp(path);
+		}
+
+		~LogDirectory()
+		{
+			DIR* directory = opendir(mPath.c_str());
+			struct dirent* entry;
+			while ((entry = readdir(directory)) != NULL)
+			{
+				if (entry->d_name[0] != '.') unlink((mPath + "/" + entry->d_name).c_str());
+			}
+			closedir(directory);
+			rmdir(mPath.c_str());
+		}
+	};
+
+	std::string get(const DecidedLog& log, uint32_t decisionId)
+	{
+		const char* data;
+		uint32_t size;
+		return log.get(decisionId, data, size) ? std::string(data, size) : "<none>";
+	}
+}
+
+BOOST_AUTO_TEST_CASE(stores_and_reopens_values)
+{
+	LogDirectory dir;
+	{
+		DecidedLog log;
+		log.open(dir.mPath, "decided", 4, 64);
+		BOOST_CHECK(log.append(0, "zero", 4));
+		BOOST_CHECK(log.append(1, "one", 3));
+		BOOST_CHECK(log.append(5, "five", 4));//grows to a second segment
+		BOOST_CHECK(!log.append(1, "again", 5));
+		BOOST_CHECK(log.sync(true));
+	}
+	DecidedLog log;
+	log.open(dir.mPath, "decided", 4, 64);
+	BOOST_CHECK_EQUAL(log.getFirstDecisionId(), 0u);
+	BOOST_CHECK_EQUAL(log.getNextDecisionId(), 6u);
+	BOOST_CHECK_EQUAL(get(log, 0), "zero");
+	BOOST_CHECK_EQUAL(get(log, 1), "one");
+	BOOST_CHECK_EQUAL(get(log, 2), "<none>");
+	BOOST_CHECK_EQUAL(get(log, 5), "five");
+	std::vector<DecidedValue> values;
+	BOOST_CHECK_EQUAL(log.read(0, 10, values), 3u);
+	BOOST_CHECK_EQUAL(values[2].mDecisionId, 5u);
+}
+
+BOOST_AUTO_TEST_CASE(durable_sync_covers_the_scheduled_values)
+{
+	LogDirectory dir;
+	{
+		DecidedLog log;
+		log.open(dir.mPath, "decided", 4, 64);
+		BOOST_CHECK(log.append(0, "zero", 4));
+		BOOST_CHECK(log.sync(false));
+		BOOST_CHECK(log.append(1, "one", 3));
+		BOOST_CHECK(log.sync(false));
+		BOOST_CHECK(log.sync(true));
+		BOOST_CHECK(log.sync(true));//nothing left
+	}
+	DecidedLog log;
+	log.open(dir.mPath, "decided", 4, 64);
+	BOOST_CHECK_EQUAL(get(log, 0), "zero");
+	BOOST_CHECK_EQUAL(get(log, 1), "one");
+}
+
+BOOST_AUTO_TEST_CASE(grows_the_data_file)
+{
+	LogDirectory dir;
+	DecidedLog log;
+	log.open(dir.mPath, "decided", 16, 8);
+	std::string large(100, 'x');
+	BOOST_CHECK(log.append(0, large.data(), large.size()));
+	BOOST_CHECK(log.append(1, "small", 5));
+	BOOST_CHECK_EQUAL(get(log, 0), large);
+	BOOST_CHECK_EQUAL(get(log, 1), "small");
+}
+
+BOOST_AUTO_TEST_CASE(drops_entries_whose_checksum_does_not_match)
+{
+	LogDirectory dir;
+	{
+		DecidedLog log;
+		log.open(dir.mPath, "decided", 4, 64);
+		BOOST_CHECK(log.append(0, "zero", 4));
+		BOOST_CHECK(log.append(1, "one", 3));
+		BOOST_CHECK(log.sync(true));
+	}
+	int fd = ::open((dir.mPath + "/decided.0000000000.dat").c_str(), O_WRONLY);
+	BOOST_REQUIRE(fd >= 0);
+	BOOST_CHECK_EQUAL(pwrite(fd, "X", 1, 5), 1);//the value of decision 1 was not written before its index entry
+	::close(fd);
+	DecidedLog log;
+	log.open(dir.mPath, "decided", 4, 64);
+	BOOST_CHECK_EQUAL(get(log, 0), "zero");
+	BOOST_CHECK(!log.contains(1));
+	BOOST_CHECK_EQUAL(log.getNextDecisionId(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(truncates_whole_segments)
+{
+	LogDirectory dir;
+	DecidedLog log;
+	log.open(dir.mPath, "decided", 4, 64);
+	for (uint32_t i = 0; i < 10; i++)
+	{
+		BOOST_CHECK(log.append(i, "value", 5));
+	}
+	log.truncate(6);
+	BOOST_CHECK_EQUAL(log.getFirstDecisionId(), 4u);
+	BOOST_CHECK(!log.contains(3));
+	BOOST_CHECK(!log.append(3, "value", 5));
+	BOOST_CHECK_EQUAL(get(log, 4), "value");
+	BOOST_CHECK_EQUAL(access((dir.mPath + "/decided.0000000000.idx").c_str(), F_OK), -1);
+}
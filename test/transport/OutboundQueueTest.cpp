@@ -0,0 +1,135 @@
+/*
+ * OutboundQueueTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE OutboundQueueTest
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+#include "transport/OutboundQueue.hpp"
+
+using namespace paxos;
+using boost::asio::ip::udp;
+
+typedef boost::shared_ptr<udp::socket> socket_ptr_t;
+
+/**
+ * A sending queue and receiving sockets on the loopback interface.
+ */
+struct Loopback
+{
+	Loopback(size_t capacity, size_t receivers) : mSender(new udp::socket(mIoService, udp::endpoint(udp::v4(), 0)))
+	{
+		mQueue.init(mSender, capacity, 64);
+		for (size_t i = 0; i < receivers; i++)
+		{
+			mReceivers.push_back(socket_ptr_t(new udp::socket(mIoService, udp::endpoint(boost::asio::ip::address_v4::loopback(), 0))));
+			mReceivers.back()->non_blocking(true);
+		}
+	}
+
+	udp::endpoint getEndpoint(size_t receiver)
+	{
+		return mReceivers[receiver]->local_endpoint();
+	}
+
+	bool queue(const std::string& datagram, const std::vector<udp::endpoint>& destinations)
+	{
+		char* buffer = mQueue.reserve(destinations.size());
+		if (buffer == NULL) return false;
+		datagram.copy(buffer, datagram.size());
+		mQueue.commit(datagram.size(), destinations);
+		return true;
+	}
+
+	/**
+	 * Datagrams queued in the receive buffer of a receiver.
+	 */
+	std::vector<std::string> receive(size_t receiver)
+	{
+		std::vector<std::string> datagrams;
+		char buffer[64];
+		boost::system::error_code ec;
+		for (;;)
+		{
+			size_t size = mReceivers[receiver]->receive(boost::asio::buffer(buffer), 0, ec);
+			if (ec) break;
+			datagrams.push_back(std::string(buffer, size));
+		}
+		return datagrams;
+	}
+
+	boost::asio::io_service		mIoService;
+	socket_ptr_t				mSender;
+	OutboundQueue				mQueue;
+	std::vector<socket_ptr_t>	mReceivers;
+};
+
+BOOST_AUTO_TEST_CASE(sends_one_slot_to_each_destination)
+{
+	Loopback loopback(4, 2);
+	std::vector<udp::endpoint> destinations;
+	destinations.push_back(loopback.getEndpoint(0));
+	destinations.push_back(loopback.getEndpoint(1));
+	BOOST_REQUIRE(loopback.queue("first", destinations));
+	destinations.pop_back();
+	BOOST_REQUIRE(loopback.queue("second", destinations));
+	BOOST_CHECK_EQUAL(loopback.mQueue.size(), 3u);
+	loopback.mQueue.flush();
+	BOOST_CHECK_EQUAL(loopback.mQueue.size(), 0u);
+	std::vector<std::string> first = loopback.receive(0);
+	BOOST_REQUIRE_EQUAL(first.size(), 2u);
+	BOOST_CHECK_EQUAL(first[0], "first");
+	BOOST_CHECK_EQUAL(first[1], "second");
+	std::vector<std::string> second = loopback.receive(1);
+	BOOST_REQUIRE_EQUAL(second.size(), 1u);
+	BOOST_CHECK_EQUAL(second[0], "first");
+}
+
+BOOST_AUTO_TEST_CASE(flushes_a_full_queue_before_reserving)
+{
+	Loopback loopback(2, 1);
+	std::vector<udp::endpoint> destinations(1, loopback.getEndpoint(0));
+	for (int i = 0; i < 5; i++)
+	{
+		BOOST_REQUIRE(loopback.queue(std::string(1, '0' + i), destinations));
+	}
+	BOOST_CHECK_EQUAL(loopback.mQueue.size(), 1u);
+	loopback.mQueue.flush();
+	std::vector<std::string> datagrams = loopback.receive(0);
+	BOOST_REQUIRE_EQUAL(datagrams.size(), 5u);
+	for (int i = 0; i < 5; i++)
+	{
+		BOOST_CHECK_EQUAL(datagrams[i], std::string(1, '0' + i));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(drops_a_datagram_with_more_destinations_than_the_queue)
+{
+	Loopback loopback(2, 1);
+	std::vector<udp::endpoint> destinations(3, loopback.getEndpoint(0));
+	BOOST_CHECK(!loopback.queue("dropped", destinations));
+	destinations.pop_back();
+	BOOST_CHECK(loopback.queue("sent", destinations));
+	loopback.mQueue.flush();
+	BOOST_CHECK_EQUAL(loopback.receive(0).size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(skips_only_the_datagram_failing_in_a_batch)
+{
+	Loopback loopback(4, 1);
+	std::vector<udp::endpoint> destinations(1, loopback.getEndpoint(0));
+	std::vector<udp::endpoint> broadcast(1, udp::endpoint(boost::asio::ip::address_v4::broadcast(), loopback.getEndpoint(0).port()));
+	BOOST_REQUIRE(loopback.queue("before", destinations));
+	BOOST_REQUIRE(loopback.queue("refused", broadcast));//no SO_BROADCAST: EACCES once the first one is sent
+	BOOST_REQUIRE(loopback.queue("after", destinations));
+	loopback.mQueue.flush();
+	BOOST_CHECK_EQUAL(loopback.mQueue.size(), 0u);
+	std::vector<std::string> datagrams = loopback.receive(0);
+	BOOST_REQUIRE_EQUAL(datagrams.size(), 2u);
+	BOOST_CHECK_EQUAL(datagrams[0], "before");
+	BOOST_CHECK_EQUAL(datagrams[1], "after");
+}
@@ -0,0 +1,129 @@
+/*
+ * UdpTransportTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE UdpTransportTest
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include <string>
+#include <vector>
+#include "transport/UnicastTransport.hpp"
+
+using namespace paxos;
+using boost::asio::ip::udp;
+
+/**
+ * A transport receiving on the loopback interface the datagrams of a peer socket, to which it replies.
+ */
+struct Receiver
+{
+	Receiver(size_t receiveBatch) : mIoService(new boost::asio::io_service()), mPeer(*mIoService, udp::endpoint(boost::asio::ip::address_v4::loopback(), 0)),
+		mReplied(false), mRepliesAtBatchEnd(0)
+	{
+		udp::socket probe(*mIoService, udp::endpoint(boost::asio::ip::address_v4::loopback(), 0));//a free port
+		unsigned short port = probe.local_endpoint().port();
+		probe.close();
+		boost::property_tree::ptree cf;
+		cf.put(XML_INTERFACE, "127.0.0.1");
+		cf.put(XML_PORT, port);
+		cf.put(XML_RECEIVE_BATCH, receiveBatch);
+		boost::property_tree::ptree peer;
+		peer.put("<xmlattr>.id", "peer");
+		peer.put("<xmlattr>.address", "127.0.0.1");
+		peer.put("<xmlattr>.port", mPeer.local_endpoint().port());
+		peer.put("<xmlattr>.roles", "proposer");
+		cf.add_child(XML_PEERS + ".peer", peer);
+		mTransport.configure(cf);
+		mTransport.open(mIoService);
+		mEndpoint = udp::endpoint(boost::asio::ip::address_v4::loopback(), port);
+		mPeer.non_blocking(true);
+	}
+
+	void send(const std::string& datagram)
+	{
+		mPeer.send_to(boost::asio::buffer(datagram), mEndpoint);
+	}
+
+	/**
+	 * Runs the transport until count datagrams are received.
+	 */
+	void receive(size_t count)
+	{
+		mTransport.start(boost::bind(&Receiver::onDatagram, this, _1, _2), boost::bind(&Receiver::onBatchEnd, this));
+		for (int i = 0; i < 1000 && mDatagrams.size() < count; i++)
+		{
+			mIoService->poll();
+			boost::this_thread::sleep(boost::posix_time::millisec(1));
+		}
+		mIoService->poll();
+	}
+
+	void onDatagram(const char* data, size_t size)
+	{
+		mDatagrams.push_back(std::string(data, size));
+		if (!mReplied)
+		{
+			mReplied = mTransport.send(PROMISE_REPLY, "reply", 5);
+		}
+	}
+
+	void onBatchEnd()
+	{
+		mBatches.push_back(mDatagrams.size());
+		mRepliesAtBatchEnd += mPeer.available();
+	}
+
+	io_service_ptr_t			mIoService;
+	udp::socket					mPeer;
+	udp::endpoint				mEndpoint;
+	UnicastTransport			mTransport;
+	std::vector<std::string>	mDatagrams;
+	std::vector<size_t>			mBatches;//datagrams received at the end of each batch
+	bool						mReplied;
+	size_t						mRepliesAtBatchEnd;
+};
+
+BOOST_AUTO_TEST_CASE(receives_the_queued_datagrams_in_batches)
+{
+	Receiver receiver(4);
+	for (int i = 0; i < 10; i++)
+	{
+		receiver.send(std::string(1, '0' + i));
+	}
+	receiver.receive(10);
+	BOOST_REQUIRE_EQUAL(receiver.mDatagrams.size(), 10u);
+	for (int i = 0; i < 10; i++)
+	{
+		BOOST_CHECK_EQUAL(receiver.mDatagrams[i], std::string(1, '0' + i));
+	}
+	BOOST_REQUIRE_EQUAL(receiver.mBatches.size(), 3u);
+	BOOST_CHECK_EQUAL(receiver.mBatches[0], 4u);
+	BOOST_CHECK_EQUAL(receiver.mBatches[1], 8u);
+	BOOST_CHECK_EQUAL(receiver.mBatches[2], 10u);
+}
+
+BOOST_AUTO_TEST_CASE(flushes_the_replies_after_the_batch)
+{
+	Receiver receiver(4);
+	receiver.send("request");
+	receiver.receive(1);
+	BOOST_REQUIRE(receiver.mReplied);
+	BOOST_CHECK_EQUAL(receiver.mRepliesAtBatchEnd, 0u);
+	char buffer[16];
+	size_t size = receiver.mPeer.receive(boost::asio::buffer(buffer));
+	BOOST_CHECK_EQUAL(std::string(buffer, size), "reply");
+}
+
+BOOST_AUTO_TEST_CASE(gives_a_truncated_datagram_a_size_of_0)
+{
+	Receiver receiver(4);
+	receiver.send(std::string(BUFFER_SIZE + 1, 'x'));
+	receiver.send(std::string(BUFFER_SIZE, 'y'));
+	receiver.receive(2);
+	BOOST_REQUIRE_EQUAL(receiver.mDatagrams.size(), 2u);
+	BOOST_CHECK(receiver.mDatagrams[0].empty());
+	BOOST_CHECK_EQUAL(receiver.mDatagrams[1], std::string(BUFFER_SIZE, 'y'));
+}
@@ -0,0 +1,132 @@
+/*
+ * UnicastTransportTest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: agent
+ */
+
+#define BOOST_TEST_MODULE UnicastTransportTest
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+#include "transport/UnicastTransport.hpp"
+
+using namespace paxos;
+using boost::asio::ip::udp;
+
+typedef boost::shared_ptr<udp::socket> socket_ptr_t;
+
+/**
+ * A transport sending on the loopback interface to peer sockets hosting the given roles.
+ */
+struct Peers
+{
+	Peers(const std::vector<std::string>& roles, bool valueReferences = false, size_t sendQueue = SEND_QUEUE_SIZE) : mIoService(new boost::asio::io_service())
+	{
+		mConfiguration.put(XML_INTERFACE, "127.0.0.1");
+		mConfiguration.put(XML_PORT, 0);
+		mConfiguration.put(XML_SEND_QUEUE, sendQueue);
+		mConfiguration.put(XML_VALUE_REFERENCES, valueReferences);
+		for (size_t i = 0; i < roles.size(); i++)
+		{
+			mPeers.push_back(socket_ptr_t(new udp::socket(*mIoService, udp::endpoint(boost::asio::ip::address_v4::loopback(), 0))));
+			mPeers.back()->non_blocking(true);
+			boost::property_tree::ptree peer;
+			peer.put("<xmlattr>.id", "node-" + roles[i]);
+			peer.put("<xmlattr>.address", "127.0.0.1");
+			peer.put("<xmlattr>.port", mPeers.back()->local_endpoint().port());
+			peer.put("<xmlattr>.roles", roles[i]);
+			mConfiguration.add_child(XML_PEERS + ".peer", peer);
+		}
+		mTransport.configure(mConfiguration);
+		mTransport.open(mIoService);
+	}
+
+	bool send(MsgId msgId)
+	{
+		return mTransport.send(msgId, getMsgName(msgId), strlen(getMsgName(msgId)));
+	}
+
+	/**
+	 * Datagrams received by a peer since the last call.
+	 */
+	std::vector<std::string> receive(size_t peer)
+	{
+		std::vector<std::string> datagrams;
+		char buffer[BUFFER_SIZE];
+		boost::system::error_code ec;
+		for (;;)
+		{
+			size_t size = mPeers[peer]->receive(boost::asio::buffer(buffer), 0, ec);
+			if (ec) break;
+			datagrams.push_back(std::string(buffer, size));
+		}
+		return datagrams;
+	}
+
+	io_service_ptr_t					mIoService;
+	boost::property_tree::ptree			mConfiguration;
+	std::vector<socket_ptr_t>			mPeers;
+	UnicastTransport					mTransport;
+};
+
+static std::vector<std::string> rolesOf(const char* first, const char* second, const char* third = NULL)
+{
+	std::vector<std::string> roles;
+	roles.push_back(first);
+	roles.push_back(second);
+	if (third != NULL) roles.push_back(third);
+	return roles;
+}
+
+BOOST_AUTO_TEST_CASE(parses_the_roles_of_a_peer)
+{
+	BOOST_CHECK_EQUAL(UnicastTransport::parseRoles("proposer, acceptor"), ROLE_PROPOSER | ROLE_ACCEPTOR);
+	BOOST_CHECK_EQUAL(UnicastTransport::parseRoles("learner"), ROLE_LEARNER);
+	BOOST_CHECK_EQUAL(UnicastTransport::parseRoles("proposer,acceptor,learner"), ROLE_ALL);
+	BOOST_CHECK_THROW(UnicastTransport::parseRoles("leader"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(sends_each_message_to_the_roles_handling_it)
+{
+	Peers peers(rolesOf("acceptor", "proposer", "learner"));
+	BOOST_REQUIRE(peers.send(PREPARE_REQUEST));
+	BOOST_REQUIRE(peers.send(PROMISE_REPLY));
+	BOOST_REQUIRE(peers.send(ACCEPT_REQUEST));
+	BOOST_REQUIRE(peers.send(CONSENSUS_NOTIFICATION));
+	std::vector<std::string> acceptor = peers.receive(0);
+	BOOST_REQUIRE_EQUAL(acceptor.size(), 3u);
+	BOOST_CHECK_EQUAL(acceptor[0], getMsgName(PREPARE_REQUEST));
+	BOOST_CHECK_EQUAL(acceptor[1], getMsgName(ACCEPT_REQUEST));
+	BOOST_CHECK_EQUAL(acceptor[2], getMsgName(CONSENSUS_NOTIFICATION));
+	BOOST_CHECK_EQUAL(peers.receive(1).size(), 4u);
+	std::vector<std::string> learner = peers.receive(2);
+	BOOST_REQUIRE_EQUAL(learner.size(), 1u);
+	BOOST_CHECK_EQUAL(learner[0], getMsgName(CONSENSUS_NOTIFICATION));
+}
+
+BOOST_AUTO_TEST_CASE(sends_the_accept_requests_to_the_learners_with_value_references)
+{
+	Peers peers(rolesOf("acceptor", "learner"), true);
+	BOOST_REQUIRE(peers.send(ACCEPT_REQUEST));
+	BOOST_CHECK_EQUAL(peers.receive(0).size(), 1u);
+	BOOST_CHECK_EQUAL(peers.receive(1).size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(drops_a_message_for_more_peers_than_the_send_queue)
+{
+	Peers peers(rolesOf("acceptor", "acceptor", "acceptor"), false, 2);
+	BOOST_CHECK(!peers.send(ACCEPT_REQUEST));
+	BOOST_CHECK(peers.send(PROMISE_REPLY));//no proposer: nothing to send
+	BOOST_CHECK_EQUAL(peers.receive(0).size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(requires_a_peer)
+{
+	boost::property_tree::ptree cf;
+	cf.put(XML_INTERFACE, "127.0.0.1");
+	cf.put(XML_PORT, 0);
+	cf.put_child(XML_PEERS, boost::property_tree::ptree());
+	UnicastTransport transport;
+	BOOST_CHECK_THROW(transport.configure(cf), std::runtime_error);
+}